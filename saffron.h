@@ -25,12 +25,37 @@ extern "C" {
 #include <unistd.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(__SSE2__)
+#define SF_SIMD_SPLIT3(sh, a, b, c, x, y, z)                                                            \
+  ((x) = sh(sh(a, b, _MM_SHUFFLE(2,1,3,0)), sh(b, c, _MM_SHUFFLE(2,1,3,2)), _MM_SHUFFLE(2,0,1,0)),       \
+   (y) = sh(sh(a, b, _MM_SHUFFLE(1,0,2,1)), sh(b, c, _MM_SHUFFLE(2,1,3,2)), _MM_SHUFFLE(3,1,2,0)),       \
+   (z) = sh(sh(a, b, _MM_SHUFFLE(1,0,2,1)), c, _MM_SHUFFLE(3,0,3,1)))
+#define SF_SIMD_JOIN3(sh, x, y, z, a, b, c)                                                             \
+  ((a) = sh(sh(x, y, _MM_SHUFFLE(1,0,1,0)), sh(z, x, _MM_SHUFFLE(2,1,1,0)), _MM_SHUFFLE(2,0,2,0)),       \
+   (b) = sh(sh(y, z, _MM_SHUFFLE(1,1,1,1)), sh(x, y, _MM_SHUFFLE(2,2,2,2)), _MM_SHUFFLE(2,0,2,0)),       \
+   (c) = sh(sh(z, x, _MM_SHUFFLE(3,3,2,2)), sh(y, z, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(2,0,2,0)))
+#endif
 
 /* SF_DEFINES */
 #define SF_ARENA_SIZE                 67108864
+#define SF_ARENA_COMMIT               1048576
 #define SF_MAX_OBJS                   128
-#define SF_MAX_ENTITIES               1024
-#define SF_MAX_LIGHTS                 32
+#define SF_POOL_CHUNK                 64
+#define SF_HEAP_CLASSES               96
+#define SF_HEAP_LIVE                  0x5AF0A11Cu
+#define SF_HEAP_FREE                  0x5AF0F4EEu
+#define SF_MAX_SHADE_LIGHTS           32
 #define SF_MAX_TEXTURES               256
 #define SF_MAX_CAMS                   8
 #define SF_MAX_CB_PER_EVT             4
@@ -38,9 +63,6 @@ extern "C" {
 #define SF_MAX_TEXT_INPUT_LEN         128
 #define SF_MAX_DROPDOWN_ITEMS         64
 #define SF_DROPDOWN_MAX_VISIBLE       8
-#define SF_MAX_FRAMES                 512
-#define SF_MAX_SPRITES                20
-#define SF_MAX_EMITRS                 10
 #define SF_MAX_SKYBOXES               4
 #define SF_SKYBOX_SPAN                128
 #define SF_MAX_SPRITE_FRAMES          16
@@ -49,6 +71,21 @@ extern "C" {
 #define SF_MAX_UI_LAY_COLS            8
 #define SF_MAX_UI_LAY_STACK           16
 #define SF_PERF_HIST_SIZE             64
+#define SF_DEPTH_LUT_SIZE             1024
+#define SF_DEPTH_SPAN                 16
+#define SF_PAL_INV_SIZE               32768
+#define SF_PX_CHUNK                   256
+#define SF_MAX_JOB_WRKRS              32
+#define SF_JOB_QUEUE_SIZE             1024
+#define SF_JOB_SCRATCH_SIZE           1048576
+#define SF_JOB_TMP_SIZE               67108864
+#define SF_JOB_SPIN                   64
+#define SF_JOB_ROWS                   16
+#define SF_DYN_RES_WINDOW             8
+#define SF_DYN_RES_STEP               0.05f
+#define SF_TAA_BLEND                  128
+#define SF_TAA_MOTION                 64
+#define SF_TAA_JITTER                 8
 #define SF_LOG_INDENT                 "            "
 #define SF_PI                         3.14159265359f
 #define SF_NANOS_PER_SEC              1000000000ULL
@@ -58,6 +95,10 @@ extern "C" {
 #  define SF_ASSET_PATH               "/usr/local/share/saffron/sf_assets"
 #endif
 
+#ifndef SF_JOB_WORKERS
+#  define SF_JOB_WORKERS              -1
+#endif
+
 #define SF_LOG(ctx, level, fmt, ...)  sf_log_(ctx, level, __func__, fmt, ##__VA_ARGS__)
 #define SF_ALIGN_SIZE(size)           (((size) + 7) & ~7)
 #define SF_DEG2RAD(d)                 ((d) * (SF_PI / 180.0f))
@@ -76,6 +117,9 @@ extern "C" {
 #define SF_CLR_BLACK                  ((sf_pkd_clr_t)0xFF000000)
 #define SF_CLR_WHITE                  ((sf_pkd_clr_t)0xFFFFFFFF)
 
+#define SF_LAYER_DEFAULT              0x00000001u
+#define SF_LAYER_ALL                  0xFFFFFFFFu
+
 /* SF_TYPES */
 typedef struct sf_ctx_t_ sf_ctx_t;
 
@@ -103,6 +147,7 @@ typedef struct { int      x, y, z;    } sf_svec3_t;
 typedef struct { float    x, y, z;    } sf_fvec3_t;
 typedef struct { int      x, y, z;    } sf_ivec3_t;
 typedef struct { float m[4][4];       } sf_fmat4_t;
+typedef struct { float m[4][3];       } sf_fmat43_t;
 typedef struct { sf_fvec3_t o, d;     } sf_ray_t;
 
 typedef enum {
@@ -118,8 +163,8 @@ struct sf_frame_t_ {
   sf_fvec3_t                        rot;
   sf_fvec3_t                        scale;
 
-  sf_fmat4_t                        local_M;
-  sf_fmat4_t                        global_M;
+  sf_fmat43_t                       local_M;
+  sf_fmat43_t                       global_M;
   bool                              is_dirty;
   bool                              is_root;
 
@@ -131,16 +176,92 @@ struct sf_frame_t_ {
 };
 
 typedef struct {
+  sf_frame_t                      **order;
+  int32_t                          *parent;
+  uint8_t                          *dirty;
+  int32_t                           count;
+  int32_t                           cap;
+  bool                              stale;
+} sf_frame_flat_t;
+
+typedef enum {
+  SF_DEPTH_F32                      = 0,
+  SF_DEPTH_F32_REV,
+  SF_DEPTH_U16
+} sf_depth_fmt_t;
+
+typedef enum {
+  SF_PIXFMT_ARGB8888                = 0,
+  SF_PIXFMT_RGB565,
+  SF_PIXFMT_IDX8
+} sf_pixfmt_t;
+
+typedef enum {
+  SF_CAM_SKYBOX                     = 1 << 0,
+  SF_CAM_FOG                        = 1 << 1,
+  SF_CAM_PARTICLES                  = 1 << 2,
+  SF_CAM_BILLBOARDS                 = 1 << 3,
+  SF_CAM_ALL                        = 0xF
+} sf_cam_feat_t;
+
+typedef struct sf_snap_t_ sf_snap_t;
+
+typedef struct {
+  sf_pkd_clr_t                     *hist[2];
+  int                               cur;
+  bool                              valid;
+  uint32_t                          frame;
+  float                             jx, jy;
+  sf_fmat43_t                       V;
+  sf_fmat4_t                        P;
+} sf_taa_t;
+
+typedef struct sf_cam_t_ sf_cam_t;
+struct sf_cam_t_ {
   int32_t                           id;
   const char                       *name;
   int                               w, h, buffer_size;
+  int                               stride;
+  bool                              ext_px;
+  void                             *_own_px;
   sf_pkd_clr_t                     *buffer;
+  uint16_t                         *buffer16;
+  uint8_t                          *buffer8;
+  sf_pixfmt_t                       pix_fmt;
+  sf_pkd_clr_t                     *palette;
+  uint8_t                          *_pal_inv;
   float                            *z_buffer;
+  uint16_t                         *z_buffer16;
+  sf_depth_fmt_t                    depth_fmt;
   float                             fov, near_plane, far_plane;
+  int                               view_group;
+  uint32_t                          cull_mask;
+  uint32_t                          features;
+  int                               update_every;
+  int                               update_phase;
+  float                             update_hz;
+  float                             _next_t;
+  bool                              _has_frame;
+  bool                              _due;
+  bool                              _keep;
+  uint64_t                          _sig, _sig_next;
+  int                               _settle;
+  void                             *_od_px;
+  size_t                            _od_size;
+  float                             res_scale;
+  bool                              temporal;
+  sf_cam_t                         *_lo;
+  sf_taa_t                         *_taa;
+  int                               roi_x, roi_y, roi_w, roi_h;
+  sf_cam_t                         *_roi;
   bool                              is_proj_dirty;
-  sf_fmat4_t                        V, P;
+  sf_fmat43_t                       V;
+  sf_fmat4_t                        P;
   sf_frame_t                       *frame;
-} sf_cam_t;
+  void                             *_back_px;
+  size_t                            _back_size;
+  const sf_snap_t                  *_rs;
+};
 
 typedef struct {
   sf_pkd_clr_t                     *px;
@@ -162,6 +283,21 @@ typedef struct {
   sf_vtx_idx_t                      idx[3];
 } sf_face_t;
 
+typedef struct {
+  sf_fvec3_t                       *v;
+  sf_fvec2_t                       *vt;
+  uint16_t                         *idx16;
+  uint32_t                         *idx32;
+  int16_t                          *qv;
+  uint16_t                         *qt;
+  sf_fvec3_t                        q_c, q_s;
+  sf_fvec2_t                        qt_o, qt_s;
+  int32_t                           v_cnt;
+  int32_t                           f_cnt;
+  bool                              valid;
+  bool                              quant;
+} sf_weld_t;
+
 typedef struct {
   sf_fvec3_t                       *v;
   sf_fvec2_t                       *vt;
@@ -179,6 +315,8 @@ typedef struct {
   int32_t                           v_cap;
   int32_t                           vt_cap;
   int32_t                           f_cap;
+  sf_weld_t                        *weld;
+  sf_ctx_t                         *_ctx;
 } sf_obj_t;
 
 typedef struct {
@@ -188,6 +326,7 @@ typedef struct {
   sf_fvec2_t                        tex_scale;
   const char                       *name;
   sf_frame_t                       *frame;
+  uint32_t                          layers;
 } sf_enti_t;
 
 typedef enum {
@@ -223,6 +362,7 @@ typedef struct {
   float                             angle;
   sf_fvec3_t                        normal;
   sf_frame_t                       *frame;
+  uint32_t                          layers;
 } sf_sprite_3_t;
 
 typedef struct {
@@ -252,6 +392,7 @@ typedef struct {
   sf_emitr_type_t                   type;
   sf_sprite_2_t                    *sprite;
   sf_frame_t                       *frame;
+  uint32_t                          layers;
 
   sf_particle_t                    *particles;
   int                               max_particles;
@@ -268,9 +409,122 @@ typedef struct {
 typedef struct {
   size_t                            size;
   size_t                            offset;
+  size_t                            committed;
   uint8_t                          *buffer;
 } sf_arena_t;
 
+typedef struct {
+  size_t                            arena_size;
+  int32_t                           max_objs;
+  int32_t                           max_textures;
+  int32_t                           max_skyboxes;
+  int32_t                           max_sprite_3ds;
+  int32_t                           workers;
+  size_t                            tmp_size;
+} sf_init_cfg_t;
+
+typedef struct {
+  uint32_t                          cls;
+  uint32_t                          magic;
+  uint64_t                          size;
+} sf_heap_blk_t;
+
+typedef struct {
+  sf_heap_blk_t                    *free_list[SF_HEAP_CLASSES];
+  size_t                            used;
+  size_t                            peak;
+  size_t                            reserved;
+  size_t                            idle;
+  int32_t                           live;
+  int32_t                           idle_blocks;
+} sf_heap_t;
+
+typedef struct {
+  uint32_t                          idx;
+  uint32_t                          gen;
+} sf_handle_t;
+
+typedef struct {
+  uint32_t                          slot;
+  uint32_t                          gen;
+  int32_t                           dense;
+  int32_t                           next;
+} sf_pool_hdr_t;
+
+typedef struct {
+  size_t                            stride;
+  uint8_t                         **chunks;
+  int32_t                           chunk_count;
+  int32_t                           chunk_cap;
+  void                            **items;
+  int32_t                           count;
+  int32_t                           item_cap;
+  int32_t                           free_head;
+} sf_pool_t;
+
+typedef enum {
+  SF_NAME_OBJ = 0,
+  SF_NAME_ENTI,
+  SF_NAME_TEX,
+  SF_NAME_CAM,
+  SF_NAME_LIGHT,
+  SF_NAME_SPRITE,
+  SF_NAME_EMITR,
+  SF_NAME_SKYBOX,
+  SF_NAME_FRAME,
+  SF_NAME_MAX
+} sf_name_kind_t;
+
+typedef struct {
+  uint32_t                          hash;
+  const char                       *key;
+  void                             *item;
+} sf_name_ent_t;
+
+typedef struct {
+  sf_name_ent_t                    *ents;
+  int32_t                           cap;
+  int32_t                           count;
+  int32_t                           used;
+} sf_names_t;
+
+typedef void  (*sf_job_fn    )(struct sf_ctx_t_ *ctx, void *user, int i0, int i1, int worker);
+
+typedef struct {
+  atomic_int                        n;
+} sf_job_ctr_t;
+
+typedef struct {
+  sf_job_fn                         fn;
+  void                             *user;
+  int                               i0, i1;
+  sf_job_ctr_t                     *dep;
+  sf_job_ctr_t                     *done;
+} sf_job_t;
+
+typedef struct {
+  atomic_long                       top;
+  atomic_long                       bot;
+  sf_job_t                         *ring;
+  sf_arena_t                        scratch;
+  sf_arena_t                        tmp[2];
+  pthread_t                         thread;
+  struct sf_ctx_t_                 *ctx;
+  int                               id;
+} sf_job_wrkr_t;
+
+typedef struct {
+  sf_job_wrkr_t                    *wrkrs;
+  int                               count;
+  atomic_int                        queued;
+  atomic_int                        tmp_side;
+  size_t                            tmp_size;
+  atomic_bool                       quit;
+  atomic_bool                       started;
+  pthread_mutex_t                   lock;
+  pthread_cond_t                    wake;
+} sf_jobs_t;
+
 typedef float (*sf_height_fn )(float x, float z, void *ud);
 
 typedef enum {
@@ -512,42 +766,156 @@ typedef enum {
   SF_RENDER_MODE_COUNT
 } sf_render_mode_t;
 
+typedef struct {
+  bool                              fog;
+  bool                              depth;
+  float                             A, B, C;
+  float                             near_plane;
+  float                             fog_start;
+  float                             fog_inv_rng;
+  uint32_t                          fog_rgb;
+  float                             depth_inv_rng;
+  bool                              u16;
+  float                             q_scale, q_off;
+  const sf_pkd_clr_t               *depth_lut;
+  sf_cam_t                         *cam;
+} sf_post_t;
+
+typedef struct {
+  sf_tex_t                         *tex;
+  sf_fvec3_t                        r, u, f;
+  sf_fvec3_t                        step;
+  sf_fvec3_t                        d;
+  float                             inv_px, inv_py, inv_w, inv_h;
+  float                             fw, fh;
+  float                             u0, v0, du, dv;
+} sf_sky_t;
+
+typedef struct {
+  sf_obj_t                         *obj;
+  char                            **lines;
+  int                               n_v, n_vt, n_vn;
+} sf_obj_ld_t;
+
+typedef struct {
+  sf_obj_t                         *obj;
+  sf_height_fn                      fn;
+  void                             *ud;
+  float                             size_x, size_z;
+  int                               res;
+} sf_hmap_ld_t;
+
+typedef struct {
+  const sf_cam_t                   *src;
+  sf_cam_t                         *dst;
+  bool                              bilinear;
+  sf_taa_t                         *taa;
+  sf_fmat4_t                        R;
+  float                             A, B, C, far;
+} sf_upscale_t;
+
+typedef struct {
+  sf_sprite_2_t                    *sprite;
+  sf_fvec3_t                        pos;
+  float                             anim_time;
+  float                             scale;
+  uint32_t                          layers;
+} sf_snap_pcl_t;
+
+typedef struct {
+  sf_tex_t                         *sky;
+  bool                              sky_last;
+  bool                              fog_enabled;
+  sf_fvec3_t                        fog_color;
+  float                             fog_start;
+  float                             fog_end;
+  sf_render_mode_t                  render_mode;
+} sf_look_t;
+
+struct sf_snap_t_ {
+  sf_fmat43_t                      *M;
+  int32_t                           frames_count;
+  int32_t                           frames_cap;
+  sf_enti_t                        *entities;
+  int32_t                           enti_count;
+  int32_t                           enti_cap;
+  sf_light_t                       *lights;
+  int32_t                           light_count;
+  int32_t                           light_cap;
+  sf_sprite_3_t                    *sprite_3ds;
+  int32_t                           sprite_3d_count;
+  sf_snap_pcl_t                    *pcls;
+  int32_t                           pcl_count;
+  sf_cam_t                         *cams;
+  int32_t                           cam_count;
+  sf_look_t                         look;
+  sf_job_ctr_t                      done;
+  bool                              in_flight;
+  int32_t                           tmp_flips;
+};
+
 struct sf_ctx_t_ {
   sf_run_state_t                    state;
 
   sf_arena_t                        arena;
   int                               arena_size;
+  sf_heap_t                         heap;
+  sf_jobs_t                         jobs;
 
   sf_frame_t                       *roots[SF_CONV_MAX];
-  sf_frame_t                       *frames;
+  sf_pool_t                         frame_pool;
+  sf_frame_flat_t                   frame_flat;
+  sf_frame_t                      **frames;
   int32_t                           frames_count;
-  sf_frame_t                       *free_frames;
   sf_obj_t                         *objs;
   int32_t                           obj_count;
-  sf_enti_t                        *entities;
+  sf_fvec3_t                       *_pick_v;
+  int32_t                           _pick_cap;
+  int32_t                           obj_cap;
+  sf_pool_t                         enti_pool;
+  sf_enti_t                       **entities;
   int32_t                           enti_count;
   sf_tex_t                         *textures;
   int32_t                           tex_count;
+  int32_t                           tex_cap;
   sf_cam_t                         *cameras;
   int32_t                           cam_count;
-  sf_sprite_2_t                    *sprites;
+  sf_pool_t                         sprite_pool;
+  sf_sprite_2_t                   **sprites;
   int32_t                           sprite_count;
   sf_sprite_3_t                    *sprite_3ds;
   int32_t                           sprite_3d_count;
-  sf_emitr_t                       *emitrs;
+  int32_t                           sprite_3d_cap;
+  sf_pool_t                         emitr_pool;
+  sf_emitr_t                      **emitrs;
   int32_t                           emitr_count;
   sf_skybox_t                      *skyboxes;
   int32_t                           skybox_count;
+  int32_t                           skybox_cap;
   sf_skybox_t                      *active_skybox;
   bool                              skybox_enabled;
+  bool                              sky_last;
+  sf_names_t                        names[SF_NAME_MAX];
 
   bool                              fog_enabled;
   sf_fvec3_t                        fog_color;
   float                             fog_start;
   float                             fog_end;
   sf_render_mode_t                  render_mode;
-
-  sf_light_t                       *lights;
+  sf_pkd_clr_t                     *_depth_lut;
+  bool                              pipelined;
+  sf_snap_t                         _snap;
+  uint32_t                          _render_frame;
+  bool                              on_demand;
+  bool                              _idle;
+  uint32_t                          _scene_gen;
+  float                             dyn_res_budget;
+  float                             dyn_res_min;
+  float                             dyn_res_max;
+  bool                              dyn_res_bilinear;
+
+  sf_pool_t                         light_pool;
+  sf_light_t                      **lights;
   int32_t                           light_count;
 
   sf_ui_t                          *ui;
@@ -566,7 +934,7 @@ struct sf_ctx_t_ {
 
   float                             _perf_dt_hist[SF_PERF_HIST_SIZE];
   int                               _perf_dt_idx;
-  int                               _perf_tri_count;
+  atomic_int                        _perf_tri_count;
 
   sf_log_fn                         log_cb;
   void*                             log_user;
@@ -575,16 +943,51 @@ struct sf_ctx_t_ {
 
 /* SF_CORE_FUNCTIONS */
 void           sf_init              (sf_ctx_t *ctx, int w, int h);
+void           sf_init_ex           (sf_ctx_t *ctx, int w, int h, const sf_init_cfg_t *cfg);
 void           sf_destroy           (sf_ctx_t *ctx);
 bool           sf_running           (sf_ctx_t *ctx);
 void           sf_stop              (sf_ctx_t *ctx);
 void           sf_render_enti       (sf_ctx_t *ctx, sf_cam_t *cam, sf_enti_t *enti);
+void           sf_render_enti_views (sf_ctx_t *ctx, sf_cam_t **cams, int n, sf_enti_t *enti);
 void           sf_render_ctx        (sf_ctx_t *ctx);
 void           sf_render_cam        (sf_ctx_t *ctx, sf_cam_t *cam);
+void           sf_render_cams       (sf_ctx_t *ctx, sf_cam_t **cams, int n);
+void           _sf_render_pass      (sf_ctx_t *ctx, sf_cam_t **cams, int n);
+void           _sf_render_cam_job   (sf_ctx_t *ctx, void *user, int i0, int i1, int worker);
+sf_cam_t*      _sf_render_cam_at    (sf_ctx_t *ctx, sf_snap_t *rs, int k);
+bool           _sf_render_due       (sf_ctx_t *ctx, sf_cam_t *cam);
+bool           _sf_render_changed   (sf_ctx_t *ctx, sf_cam_t *cam, uint64_t scene);
+uint64_t       _sf_scene_sig        (sf_ctx_t *ctx);
+void           _sf_od_keep          (sf_cam_t *cam, bool save);
+bool           sf_render_idle       (sf_ctx_t *ctx);
+void           sf_render_sync       (sf_ctx_t *ctx);
+bool           _sf_snap_take        (sf_ctx_t *ctx);
+sf_fmat43_t    _sf_render_M         (sf_ctx_t *ctx, sf_cam_t *cam, sf_frame_t *f);
+sf_look_t      _sf_render_look      (sf_ctx_t *ctx, const sf_cam_t *cam);
+void           sf_dyn_res_update    (sf_ctx_t *ctx);
+bool           _sf_dyn_res_alloc    (sf_ctx_t *ctx, sf_cam_t *cam);
+sf_cam_t*      _sf_dyn_res_view     (sf_ctx_t *ctx, sf_cam_t *cam);
+void           _sf_dyn_res_blit     (sf_ctx_t *ctx, const sf_cam_t *lo, sf_cam_t *cam);
+void           _sf_dyn_res_rows     (sf_ctx_t *ctx, void *user, int y0, int y1, int worker);
+void           _sf_taa_rows         (sf_ctx_t *ctx, void *user, int y0, int y1, int worker);
+void           _sf_dyn_res_free     (sf_cam_t *cam);
+sf_cam_t*      _sf_roi_view         (sf_ctx_t *ctx, sf_cam_t *cam);
+void           _sf_roi_done         (const sf_cam_t *roi, sf_cam_t *cam);
+void           _sf_roi_free         (sf_cam_t *cam);
 void           sf_render_emitrs     (sf_ctx_t *ctx, sf_cam_t *cam);
 void           sf_render_skybox     (sf_ctx_t *ctx, sf_cam_t *cam);
+void           _sf_skybox_rows      (sf_ctx_t *ctx, void *user, int y0, int y1, int worker);
+void           sf_render_sky_fill   (sf_ctx_t *ctx, sf_cam_t *cam);
+void           _sf_sky_fill_rows    (sf_ctx_t *ctx, void *user, int y0, int y1, int worker);
+sf_sky_t       _sf_sky_setup        (const sf_cam_t *cam, sf_tex_t *tex);
+void           _sf_sky_row          (sf_sky_t *s, const sf_cam_t *cam, int py);
+void           _sf_sky_span         (sf_sky_t *s, int len, bool uv);
 void           sf_render_fog        (sf_ctx_t *ctx, sf_cam_t *cam);
 void           sf_render_depth      (sf_ctx_t *ctx, sf_cam_t *cam);
+void           sf_render_post       (sf_ctx_t *ctx, sf_cam_t *cam);
+sf_post_t      _sf_post_setup       (sf_ctx_t *ctx, sf_cam_t *cam, bool fog, bool depth);
+void           _sf_post_rows        (sf_cam_t *cam, const sf_post_t *pp, int y0, int y1);
+void           _sf_post_job         (sf_ctx_t *ctx, void *user, int y0, int y1, int worker);
 void           sf_update_emitrs     (sf_ctx_t *ctx);
 void           sf_time_update       (sf_ctx_t *ctx);
 
@@ -593,8 +996,41 @@ sf_arena_t     sf_arena_init        (sf_ctx_t *ctx, size_t size);
 void*          sf_arena_alloc       (sf_ctx_t *ctx, sf_arena_t *arena, size_t size);
 size_t         sf_arena_save        (sf_ctx_t *ctx, sf_arena_t *arena);
 void           sf_arena_restore     (sf_ctx_t *ctx, sf_arena_t *arena, size_t mark);
+void           sf_arena_free        (sf_arena_t *arena);
+void*          sf_heap_alloc        (sf_ctx_t *ctx, size_t size);
+void           sf_heap_free         (sf_ctx_t *ctx, const void *ptr);
+float          sf_heap_frag         (const sf_ctx_t *ctx);
+int32_t        _sf_heap_class       (size_t size);
+size_t         _sf_heap_csize       (int32_t cls);
+void*          sf_tmp_alloc         (sf_ctx_t *ctx, size_t size);
+sf_arena_t*    sf_tmp_arena         (sf_ctx_t *ctx);
+void           _sf_tmp_flip         (sf_ctx_t *ctx);
 size_t         _sf_obj_memusg       (sf_obj_t *obj);
 char*          _sf_arena_strdup     (sf_ctx_t *ctx, const char *s);
+void*          _sf_grow             (void *p, int32_t *cap, int32_t n, size_t size);
+void           sf_pool_init         (sf_pool_t *pool, size_t item_size);
+void*          sf_pool_add          (sf_ctx_t *ctx, sf_pool_t *pool);
+bool           sf_pool_remove       (sf_pool_t *pool, void *item);
+void*          sf_pool_get          (sf_pool_t *pool, sf_handle_t h);
+sf_handle_t    sf_pool_handle       (sf_pool_t *pool, const void *item);
+void           sf_pool_free         (sf_pool_t *pool);
+sf_pool_hdr_t* _sf_pool_hdr         (sf_pool_t *pool, int32_t slot);
+sf_pool_hdr_t* _sf_pool_find        (sf_pool_t *pool, const void *item);
+
+/* SF_JOB_FUNCTIONS */
+void           sf_jobs_init         (sf_ctx_t *ctx, int workers);
+void           sf_jobs_shutdown     (sf_ctx_t *ctx);
+void           sf_jobs_submit       (sf_ctx_t *ctx, sf_job_fn fn, void *user, int i0, int i1, sf_job_ctr_t *dep, sf_job_ctr_t *done);
+void           sf_jobs_wait         (sf_ctx_t *ctx, sf_job_ctr_t *ctr);
+void           sf_jobs_parallel_for (sf_ctx_t *ctx, int n, int grain, sf_job_fn fn, void *user);
+int            sf_jobs_worker       (sf_ctx_t *ctx);
+sf_arena_t*    sf_jobs_scratch      (sf_ctx_t *ctx);
+bool           _sf_jobs_push        (sf_jobs_t *jb, int w, sf_job_t job);
+bool           _sf_jobs_pop         (sf_jobs_t *jb, int w, sf_job_t *out);
+bool           _sf_jobs_steal       (sf_jobs_t *jb, int victim, sf_job_t *out);
+bool           _sf_jobs_run_one     (sf_ctx_t *ctx, int w);
+void           _sf_jobs_exec        (sf_ctx_t *ctx, int w, sf_job_t job);
+void*          _sf_jobs_main        (void *arg);
 
 /* SF_EVENT_FUNCTIONS */
 void           sf_event_reg         (sf_ctx_t *ctx, sf_event_type_t type, sf_event_cb cb, void *userdata);
@@ -612,6 +1048,7 @@ bool           sf_key_pressed       (sf_ctx_t *ctx, sf_key_t key);
 sf_tex_t*      sf_load_texture_bmp  (sf_ctx_t *ctx, const char *filename, const char *texname);
 sf_sprite_2_t* sf_load_sprite       (sf_ctx_t *ctx, const char *spritename, float duration, float scale, int frame_count, ...);
 sf_obj_t*      sf_load_obj          (sf_ctx_t *ctx, const char *filename, const char *objname);
+void           _sf_load_obj_lines   (sf_ctx_t *ctx, void *user, int i0, int i1, int worker);
 sf_skybox_t*   sf_load_skybox       (sf_ctx_t *ctx, const char *filename, const char *skyboxname);
 sf_emitr_t*    sf_add_emitr         (sf_ctx_t *ctx, const char *emitrname, sf_emitr_type_t type, sf_sprite_2_t *sprite, int max_p);
 sf_enti_t*     sf_add_enti          (sf_ctx_t *ctx, sf_obj_t *obj, const char *entiname);
@@ -625,11 +1062,18 @@ sf_enti_t*     sf_get_enti_         (sf_ctx_t *ctx, const char *entiname, bool s
 sf_cam_t*      sf_get_cam_          (sf_ctx_t *ctx, const char *camname, bool should_log_failure);
 sf_light_t*    sf_get_light_        (sf_ctx_t *ctx, const char *lightname, bool should_log_failure);
 sf_skybox_t*   sf_get_skybox_       (sf_ctx_t *ctx, const char *skyboxname, bool should_log_failure);
+bool           sf_rename            (sf_ctx_t *ctx, sf_name_kind_t kind, void *item, const char *name);
+uint32_t       _sf_names_hash       (const char *s);
+void*          _sf_names_find       (const sf_names_t *n, const char *name);
+bool           _sf_names_put        (sf_ctx_t *ctx, sf_names_t *n, const char *name, void *item);
+void           _sf_names_del        (sf_names_t *n, const char *name, const void *item);
+void           _sf_names_free       (sf_names_t *n);
 void           sf_remove_enti       (sf_ctx_t *ctx, sf_enti_t *enti);
 void           sf_remove_light      (sf_ctx_t *ctx, sf_light_t *light);
 void           sf_remove_cam        (sf_ctx_t *ctx, sf_cam_t *cam);
 void           sf_remove_emitr      (sf_ctx_t *ctx, sf_emitr_t *emitr);
 void           sf_remove_obj        (sf_ctx_t *ctx, sf_obj_t *obj);
+void           _sf_obj_release      (sf_ctx_t *ctx, const sf_obj_t *mesh);
 void           sf_remove_tex        (sf_ctx_t *ctx, sf_tex_t *tex);
 void           sf_remove_sprite     (sf_ctx_t *ctx, sf_sprite_2_t *sprite);
 void           sf_remove_skybox     (sf_ctx_t *ctx, sf_skybox_t *skybox);
@@ -641,18 +1085,29 @@ void           sf_enti_set_rot      (sf_ctx_t *ctx, sf_enti_t *enti, float rx, f
 void           sf_enti_rotate       (sf_ctx_t *ctx, sf_enti_t *enti, float drx, float dry, float drz);
 void           sf_enti_set_scale    (sf_ctx_t *ctx, sf_enti_t *enti, float sx, float sy, float sz);
 void           sf_enti_set_tex      (sf_ctx_t *ctx, const char *entiname, const char *texname);
+void           sf_enti_set_obj      (sf_ctx_t *ctx, sf_enti_t *enti, const sf_obj_t *obj);
 void           sf_obj_recenter      (sf_obj_t *obj);
 void           sf_camera_set_psp    (sf_ctx_t *ctx, sf_cam_t *cam, float fov, float near_plane, float far_plane);
 void           sf_camera_set_pos    (sf_ctx_t *ctx, sf_cam_t *cam, float x, float y, float z);
 void           sf_camera_move_loc   (sf_ctx_t *ctx, sf_cam_t *cam, float fwd, float right, float up);
 void           sf_camera_look_at    (sf_ctx_t *ctx, sf_cam_t *cam, sf_fvec3_t target);
 void           sf_camera_add_yp     (sf_ctx_t *ctx, sf_cam_t *cam, float yaw_offset, float pitch_offset);
+bool           sf_camera_set_depth  (sf_ctx_t *ctx, sf_cam_t *cam, sf_depth_fmt_t fmt);
+bool           sf_camera_set_pixfmt (sf_ctx_t *ctx, sf_cam_t *cam, sf_pixfmt_t fmt);
+bool           sf_camera_set_pal    (sf_ctx_t *ctx, sf_cam_t *cam, const sf_pkd_clr_t *pal);
+bool           sf_camera_set_target (sf_ctx_t *ctx, sf_cam_t *cam, void *pixels, int pitch);
+void           sf_camera_set_rate   (sf_ctx_t *ctx, sf_cam_t *cam, int every, float hz);
+void           sf_camera_refresh    (sf_ctx_t *ctx, sf_cam_t *cam);
+bool           sf_camera_set_roi    (sf_ctx_t *ctx, sf_cam_t *cam, int x, int y, int w, int h);
+void           sf_mark_dirty        (sf_ctx_t *ctx);
 void           sf_load_sff          (sf_ctx_t *ctx, const char *filename, const char *worldname);
 bool           sf_save_sff          (sf_ctx_t *ctx, const char *filepath);
 bool           _sf_sff_read_kv      (FILE *f, char *key, size_t ksz, char *val, size_t vsz);
 void           _sf_sff_trim         (char *s);
 sf_fvec3_t     _sf_sff_prse_vec3    (const char *s);
 int            _sf_sff_prse_list    (const char *s, char out[][64], int max);
+uint32_t       _sf_sff_prse_feats   (const char *s);
+void           _sf_sff_write_cam    (FILE *f, const sf_cam_t *cam);
 sf_frame_t*    _sf_sff_get_frame_   (sf_ctx_t *ctx, const char *name);
 void           _sf_sff_prse_frame   (sf_ctx_t *ctx, FILE *f, const char *name, int *frame_count);
 void           _sf_sff_prse_cam     (sf_ctx_t *ctx, FILE *f, const char *name, int *cam_count);
@@ -677,7 +1132,8 @@ void           sf_frame_set_parent  (sf_frame_t *child, sf_frame_t *new_parent);
 void           sf_remove_frame      (sf_ctx_t *ctx, sf_frame_t *f);
 void           sf_frame_walk        (sf_ctx_t *ctx, sf_frame_t *root, sf_frame_walk_fn cb, void *userdata);
 void           _sf_set_up_frames    (sf_ctx_t *ctx);
-void           _sf_calc_frame_tree  (sf_frame_t *f, sf_fmat4_t parent_global_M, bool force_dirty);
+bool           _sf_frame_sort       (sf_ctx_t *ctx);
+void           _sf_frame_local      (sf_frame_t *f);
 void           _sf_write_frame_ref  (FILE *f, sf_frame_t *fr, sf_ctx_t *ctx);
 bool           _sf_frame_walk_r     (sf_frame_t *f, int depth, sf_frame_walk_fn cb, void *ud);
 
@@ -764,16 +1220,25 @@ void           _sf_ui_lay_next_cell (sf_ctx_t *ctx, sf_ivec2_t *out_v0, sf_ivec2
 
 /* SF_MESH_AUTHORING_FUNCTIONS */
 sf_obj_t*      sf_obj_create_empty  (sf_ctx_t *ctx, const char *objname, int max_v, int max_vt, int max_f);
+void           _sf_obj_touch        (sf_obj_t *obj);
 int            sf_obj_add_vert      (sf_obj_t *obj, sf_fvec3_t p);
 int            sf_obj_add_uv        (sf_obj_t *obj, sf_fvec2_t uv);
 int            sf_obj_add_face      (sf_obj_t *obj, int i0, int i1, int i2);
 int            sf_obj_add_face_uv   (sf_obj_t *obj, int v0, int v1, int v2, int t0, int t1, int t2);
 void           sf_obj_recompute_bs  (sf_obj_t *obj);
+bool           sf_obj_weld          (sf_ctx_t *ctx, sf_obj_t *obj);
+bool           sf_obj_quantize      (sf_ctx_t *ctx, sf_obj_t *obj);
+sf_fmat43_t    _sf_weld_dequant     (const sf_weld_t *w);
+bool           sf_obj_strip         (sf_ctx_t *ctx, sf_obj_t *obj);
+sf_fvec3_t     _sf_weld_pos         (const sf_weld_t *w, int i);
+sf_fvec2_t     _sf_weld_uv          (const sf_weld_t *w, int i);
+int            _sf_obj_corner       (const sf_obj_t *obj, int k);
 sf_obj_t*      sf_obj_make_plane    (sf_ctx_t *ctx, const char *objname, float sx, float sz, int res);
 sf_obj_t*      sf_obj_make_box      (sf_ctx_t *ctx, const char *objname, float sx, float sy, float sz);
 sf_obj_t*      sf_obj_make_sphere   (sf_ctx_t *ctx, const char *objname, float radius, int segs);
 sf_obj_t*      sf_obj_make_cyl      (sf_ctx_t *ctx, const char *objname, float radius, float height, int segs);
 sf_obj_t*      sf_obj_make_heightmap(sf_ctx_t *ctx, const char *objname, float size_x, float size_z, int res, sf_height_fn fn, void *ud);
+void           _sf_heightmap_rows   (sf_ctx_t *ctx, void *user, int z0, int z1, int worker);
 bool           sf_obj_save_obj      (sf_ctx_t *ctx, sf_obj_t *obj, const char *filepath);
 float          sf_noise_fbm         (float x, float z, int oct, float lac, float gain, uint32_t seed);
 float          sf_noise_3d          (float x, float y, float z, uint32_t seed);
@@ -783,6 +1248,7 @@ float          sf_noise_fbm_3d      (float x, float y, float z, int oct, float p
 sf_ray_t       sf_ray_from_screen   (sf_ctx_t *ctx, sf_cam_t *cam, int sx, int sy);
 sf_enti_t*     sf_raycast_entities  (sf_ctx_t *ctx, sf_ray_t ray, float *out_t);
 int            sf_raycast_all       (sf_ctx_t *ctx, sf_ray_t ray, sf_hit_t *out_hits, int max_hits);
+sf_fvec3_t*    _sf_pick_verts       (sf_ctx_t *ctx, sf_enti_t *e);
 bool           sf_ray_triangle      (sf_ray_t r, sf_fvec3_t a, sf_fvec3_t b, sf_fvec3_t c, float *out_t);
 bool           sf_ray_plane_y       (sf_ray_t r, float y, sf_fvec3_t *out);
 bool           sf_ray_aabb          (sf_ray_t r, sf_fvec3_t bmin, sf_fvec3_t bmax, float *out_t);
@@ -815,6 +1281,12 @@ const char*    _sf_log_lvl_to_str   (sf_log_level_t level);
 /* SF_MATH_FUNCTIONS */
 sf_fmat4_t     sf_fmat4_mul_fmat4   (sf_fmat4_t m0, sf_fmat4_t m1);
 sf_fvec3_t     sf_fmat4_mul_vec3    (sf_fmat4_t m, sf_fvec3_t v);
+sf_fmat43_t    sf_fmat43_mul_fmat43 (sf_fmat43_t m0, sf_fmat43_t m1);
+sf_fvec3_t     sf_fmat43_mul_vec3   (sf_fmat43_t m, sf_fvec3_t v);
+void           sf_fmat43_mul_vec3_n (sf_fmat43_t m, const sf_fvec3_t *in, sf_fvec3_t *out, int n);
+void           _sf_fmat43_mul_q16_n (sf_fmat43_t m, const int16_t *q, sf_fvec3_t *out, int n);
+sf_fmat43_t    sf_fmat4_to_fmat43   (sf_fmat4_t m);
+sf_fmat4_t     sf_fmat43_to_fmat4   (sf_fmat43_t m);
 sf_fvec3_t     sf_fvec3_sub         (sf_fvec3_t v0, sf_fvec3_t v1);
 sf_fvec3_t     sf_fvec3_add         (sf_fvec3_t v0, sf_fvec3_t v1);
 sf_fvec3_t     sf_fvec3_norm        (sf_fvec3_t v);
@@ -824,6 +1296,7 @@ sf_fmat4_t     sf_make_tsl_fmat4    (float x, float y, float z);
 sf_fmat4_t     sf_make_rot_fmat4    (sf_fvec3_t angles);
 sf_fmat4_t     sf_make_psp_fmat4    (float fov_deg, float aspect, float near, float far);
 sf_fmat4_t     sf_make_idn_fmat4    (void);
+sf_fmat43_t    sf_make_idn_fmat43   (void);
 sf_fmat4_t     sf_make_view_fmat4   (sf_fvec3_t eye, sf_fvec3_t target, sf_fvec3_t up);
 sf_fmat4_t     sf_make_scale_fmat4  (sf_fvec3_t scale);
 uint32_t       _sf_vec_to_index     (sf_ctx_t *ctx, sf_cam_t *cam, sf_ivec2_t v);
@@ -831,13 +1304,21 @@ void           _sf_swap_svec2       (sf_ivec2_t *v0, sf_ivec2_t *v1);
 void           _sf_swap_fvec3       (sf_fvec3_t *v0, sf_fvec3_t *v1);
 float          _sf_lerp_f           (float a, float b, float t);
 sf_fvec3_t     _sf_lerp_fvec3       (sf_fvec3_t a, sf_fvec3_t b, float t);
+sf_pkd_clr_t   _sf_lerp_px          (sf_pkd_clr_t a, sf_pkd_clr_t b, uint32_t w);
+sf_fmat43_t    _sf_rigid_inv        (sf_fmat43_t m);
 sf_fvec3_t     _sf_intersect_near   (sf_fvec3_t v0, sf_fvec3_t v1, float near);
 sf_fvec3_t     _sf_project_vertex   (sf_ctx_t *ctx, sf_cam_t *cam, sf_fvec3_t v, sf_fmat4_t P);
+void           _sf_project_verts    (sf_ctx_t *ctx, sf_cam_t *cam, const sf_fvec3_t *v, sf_fvec3_t *out, int n, sf_fmat4_t P);
+uint16_t       _sf_depth_to_q16     (float z, float zk);
+float          _sf_depth_q16f       (float z, float zk);
+float          _sf_depth_q16_k      (sf_cam_t *cam);
+bool           _sf_depth_is_clear   (sf_cam_t *cam, int idx);
 float          _sf_hash_2d          (int x, int z, uint32_t seed);
 float          _sf_smooth_noise     (float x, float z, uint32_t seed);
 float          _sf_hash_3d          (int x, int y, int z, uint32_t seed);
 float          _sf_smooth_noise_3d  (float x, float y, float z, uint32_t seed);
 float          _sf_seg_dist2        (sf_ivec2_t a, sf_ivec2_t b, int px, int py, float *out_t);
+uint64_t       _sf_fnv1a            (uint64_t h, const void *p, size_t n);
 
 /* SF_IMPLEMENTATION_HELPERS */
 bool           _sf_resolve_asset    (const char* filename, char* out_path, size_t max_len);
@@ -845,8 +1326,13 @@ const char*    _sf_basename         (const char *path);
 uint64_t       _sf_get_ticks        (void);
 sf_pkd_clr_t   _sf_pack_color       (sf_unpkd_clr_t);
 sf_unpkd_clr_t _sf_unpack_color     (sf_pkd_clr_t);
+void           _sf_put_px           (sf_cam_t *cam, int idx, sf_pkd_clr_t c);
+sf_pkd_clr_t   _sf_get_px           (sf_cam_t *cam, int idx);
+sf_pkd_clr_t*  _sf_px_span          (sf_cam_t *cam, sf_pkd_clr_t *tmp, int idx, int n);
+void           _sf_px_flush         (sf_cam_t *cam, const sf_pkd_clr_t *tmp, int idx, int n);
 void           _sf_write_qstr       (FILE *f, const char *s);
 bool           _sf_parse_qstr       (const char *line, const char *key, char *out, size_t outsz);
+void           _sf_build_depth_lut  (sf_pkd_clr_t *lut);
 
 /* SF_GAMMA_LUT */
 static const uint8_t                _sf_gamma_lut[256];
@@ -863,41 +1349,69 @@ static const uint8_t                _sf_font_8x8[];
 /* SF_IMPLEMENTATION */
 #ifdef SAFFRON_IMPLEMENTATION
 
+/* Job pool identity of the calling thread, set by sf_jobs_init and each worker on entry (see sf_jobs_worker). */
+static _Thread_local sf_ctx_t      *_sf_jobs_ctx;
+static _Thread_local int            _sf_jobs_id;
+
 /* SF_CORE_FUNCTIONS */
 void sf_init(sf_ctx_t *ctx, int w, int h) {
-  /* Initialize the engine context: allocate arena, all scene arrays, main camera pixel/z buffers, and default UI. */
+  /* Initialize the engine context with the default configuration: arena, scene arrays, main camera buffers and UI. */
+  sf_init_ex(ctx, w, h, NULL);
+}
+
+void sf_init_ex(sf_ctx_t *ctx, int w, int h, const sf_init_cfg_t *cfg) {
+  /* sf_init with a configuration: arena reserve, fixed-array capacities, worker count and per-worker frame arena
+   * reserve. NULL or zero fields take the SF_ARENA_SIZE / SF_MAX_* / SF_JOB_WORKERS / SF_JOB_TMP_SIZE defaults.
+   * Arenas are only reserved here and committed as used. The default starts one worker per online core; set
+   * workers = 1 (or define SF_JOB_WORKERS 1) to stay single-threaded. */
+  sf_init_cfg_t c = cfg ? *cfg : (sf_init_cfg_t){0};
+  if (c.arena_size     == 0) c.arena_size     = SF_ARENA_SIZE;
+  if (c.max_objs       <= 0) c.max_objs       = SF_MAX_OBJS;
+  if (c.max_textures   <= 0) c.max_textures   = SF_MAX_TEXTURES;
+  if (c.max_skyboxes   <= 0) c.max_skyboxes   = SF_MAX_SKYBOXES;
+  if (c.max_sprite_3ds <= 0) c.max_sprite_3ds = SF_MAX_SPRITE_3DS;
+  if (c.workers        == 0) c.workers        = SF_JOB_WORKERS;
+  if (c.tmp_size       == 0) c.tmp_size       = SF_JOB_TMP_SIZE;
   memset(ctx, 0, sizeof(sf_ctx_t));
   ctx->state                        = SF_RUN_STATE_RUNNING;
   ctx->main_camera.w                = w;
   ctx->main_camera.h                = h;
   ctx->main_camera.buffer_size      = w * h;
+  ctx->main_camera.stride           = w;
   ctx->main_camera.buffer           = (sf_pkd_clr_t*) malloc(w*h*sizeof(sf_pkd_clr_t));
   ctx->main_camera.z_buffer         = (float*)        malloc(w*h*sizeof(float));
   ctx->main_camera.fov              = 60.0f;
   ctx->main_camera.near_plane       = 0.1f;
   ctx->main_camera.far_plane        = 100.0f;
   ctx->main_camera.is_proj_dirty    = true;
-  ctx->arena                        = sf_arena_init(ctx, SF_ARENA_SIZE);
+  ctx->main_camera.cull_mask        = SF_LAYER_ALL;
+  ctx->main_camera.features         = SF_CAM_ALL;
+  ctx->main_camera.res_scale        = 1.0f;
+  ctx->arena                        = sf_arena_init(ctx, c.arena_size);
   ctx->log_cb                       = sf_logger_console;
   ctx->log_user                     = NULL;
   ctx->log_min                      = SF_LOG_INFO;
-  ctx->objs                         = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_OBJS     * sizeof(sf_obj_t));
-  ctx->entities                     = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_ENTITIES * sizeof(sf_enti_t));
-  ctx->lights                       = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_LIGHTS   * sizeof(sf_light_t));
-  ctx->textures                     = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_TEXTURES * sizeof(sf_tex_t));
-  ctx->cameras                      = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_CAMS     * sizeof(sf_cam_t));
-  ctx->frames                       = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_FRAMES   * sizeof(sf_frame_t));
-  ctx->sprites                      = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_SPRITES  * sizeof(sf_sprite_2_t));
-  ctx->emitrs                       = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_EMITRS   * sizeof(sf_emitr_t));
-  ctx->sprite_3ds                   = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_SPRITE_3DS * sizeof(sf_sprite_3_t));
-  ctx->skyboxes                     = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_SKYBOXES * sizeof(sf_skybox_t));
+  ctx->obj_cap                      = c.max_objs;
+  ctx->tex_cap                      = c.max_textures;
+  ctx->skybox_cap                   = c.max_skyboxes;
+  ctx->sprite_3d_cap                = c.max_sprite_3ds;
+  ctx->objs                         = sf_arena_alloc(ctx, &ctx->arena, ctx->obj_cap * sizeof(sf_obj_t));
+  ctx->textures                     = sf_arena_alloc(ctx, &ctx->arena, ctx->tex_cap * sizeof(sf_tex_t));
+  ctx->cameras                      = sf_arena_alloc(ctx, &ctx->arena, SF_MAX_CAMS  * sizeof(sf_cam_t));
+  ctx->sprite_3ds                   = sf_arena_alloc(ctx, &ctx->arena, ctx->sprite_3d_cap * sizeof(sf_sprite_3_t));
+  ctx->skyboxes                     = sf_arena_alloc(ctx, &ctx->arena, ctx->skybox_cap * sizeof(sf_skybox_t));
+  ctx->_depth_lut                   = sf_arena_alloc(ctx, &ctx->arena, SF_DEPTH_LUT_SIZE * sizeof(sf_pkd_clr_t));
+  sf_pool_init(&ctx->frame_pool,  sizeof(sf_frame_t));
+  sf_pool_init(&ctx->enti_pool,   sizeof(sf_enti_t));
+  sf_pool_init(&ctx->light_pool,  sizeof(sf_light_t));
+  sf_pool_init(&ctx->sprite_pool, sizeof(sf_sprite_2_t));
+  sf_pool_init(&ctx->emitr_pool,  sizeof(sf_emitr_t));
   ctx->obj_count                    = 0;
   ctx->enti_count                   = 0;
   ctx->light_count                  = 0;
   ctx->tex_count                    = 0;
   ctx->cam_count                    = 0;
   ctx->frames_count                 = 0;
-  ctx->free_frames                  = NULL;
   ctx->sprite_count                 = 0;
   ctx->sprite_3d_count              = 0;
   ctx->emitr_count                  = 0;
@@ -905,10 +1419,16 @@ void sf_init(sf_ctx_t *ctx, int w, int h) {
   ctx->active_skybox                = NULL;
   ctx->fog_enabled                  = false;
   ctx->skybox_enabled               = false;
+  ctx->sky_last                     = true;
   ctx->fog_color                    = (sf_fvec3_t){ 0.0, 0.0, 0.0 };
   ctx->fog_start                    = 12.0f;
   ctx->fog_end                      = 18.0f;
   ctx->render_mode                  = SF_RENDER_NORMAL;
+  ctx->dyn_res_budget               = 0.0f;
+  ctx->dyn_res_min                  = 0.5f;
+  ctx->dyn_res_max                  = 1.0f;
+  ctx->dyn_res_bilinear             = true;
+  _sf_build_depth_lut(ctx->_depth_lut);
   ctx->_start_ticks                 = _sf_get_ticks();
   ctx->_last_ticks                  = ctx->_start_ticks;
   ctx->delta_time                   = 0.0f;
@@ -918,13 +1438,14 @@ void sf_init(sf_ctx_t *ctx, int w, int h) {
   ctx->ui                           = sf_ui_create(ctx);
   _sf_set_up_frames(ctx);
   ctx->main_camera.frame            = sf_add_frame(ctx, NULL);
+  ctx->jobs.tmp_size                = c.tmp_size;
+  sf_jobs_init(ctx, c.workers);
 
   SF_LOG(ctx, SF_LOG_INFO,
               SF_LOG_INDENT "buffer : %dx%d\n"
-              SF_LOG_INDENT "memory : %d\n"
-              SF_LOG_INDENT "mxobjs : %d\n"
-              SF_LOG_INDENT "mxents : %d\n",
-              ctx->main_camera.w, ctx->main_camera.h, SF_ARENA_SIZE, SF_MAX_OBJS, SF_MAX_ENTITIES);
+              SF_LOG_INDENT "memory : %zu reserved, %zu committed\n"
+              SF_LOG_INDENT "mxobjs : %d\n",
+              ctx->main_camera.w, ctx->main_camera.h, ctx->arena.size, ctx->arena.committed, ctx->obj_cap);
 }
 
 void sf_destroy(sf_ctx_t *ctx) {
@@ -937,25 +1458,66 @@ void sf_destroy(sf_ctx_t *ctx) {
               SF_LOG_INDENT "time   : %.2fs\n"
               SF_LOG_INDENT "frames : %u (avg %.1f fps)\n"
               SF_LOG_INDENT "memory : %zu / %zu bytes (%.1f%%)\n"
+              SF_LOG_INDENT "heap   : %zu live, %zu peak, %zu reserved (%.1f%% idle)\n"
               SF_LOG_INDENT "assets : %d objs, %d texs\n"
               SF_LOG_INDENT "active : %d entis, %d ui_elems\n"
               SF_LOG_INDENT "thank you .....\n",
               ctx->elapsed_time,
               ctx->frame_count, avg_fps,
               ctx->arena.offset, ctx->arena.size, mem_pct,
+              ctx->heap.used, ctx->heap.peak, ctx->heap.reserved, sf_heap_frag(ctx) * 100.0f,
               ctx->obj_count, ctx->tex_count,
               ctx->enti_count, ui_count);
 
+  sf_render_sync(ctx);
+  sf_jobs_shutdown(ctx);
+  free(ctx->_snap.M);
+  free(ctx->_snap.entities);
+  free(ctx->_snap.lights);
   for (int i = 0; i < ctx->cam_count; ++i) {
+    if (ctx->cameras[i].ext_px) sf_camera_set_target(ctx, &ctx->cameras[i], NULL, 0);
+    free(ctx->cameras[i]._back_px);
+    free(ctx->cameras[i]._od_px);
+    _sf_dyn_res_free(&ctx->cameras[i]);
+    _sf_roi_free(&ctx->cameras[i]);
     free(ctx->cameras[i].buffer);
     free(ctx->cameras[i].z_buffer);
-  }
+    free(ctx->cameras[i].z_buffer16);
+    free(ctx->cameras[i].buffer16);
+    free(ctx->cameras[i].buffer8);
+    free(ctx->cameras[i].palette);
+    free(ctx->cameras[i]._pal_inv);
+  }
+  if (ctx->main_camera.ext_px) sf_camera_set_target(ctx, &ctx->main_camera, NULL, 0);
+  free(ctx->main_camera._back_px);
+  free(ctx->main_camera._od_px);
+  _sf_dyn_res_free(&ctx->main_camera);
+  _sf_roi_free(&ctx->main_camera);
   free(ctx->main_camera.buffer);
   free(ctx->main_camera.z_buffer);
-  free(ctx->arena.buffer);
+  free(ctx->main_camera.z_buffer16);
+  free(ctx->main_camera.buffer16);
+  free(ctx->main_camera.buffer8);
+  free(ctx->main_camera.palette);
+  free(ctx->main_camera._pal_inv);
+  sf_arena_free(&ctx->arena);
+  sf_pool_free(&ctx->frame_pool);
+  free(ctx->frame_flat.order);
+  free(ctx->frame_flat.parent);
+  free(ctx->frame_flat.dirty);
+  memset(&ctx->frame_flat, 0, sizeof(sf_frame_flat_t));
+  free(ctx->_pick_v);
+  ctx->_pick_v   = NULL;
+  ctx->_pick_cap = 0;
+  sf_pool_free(&ctx->enti_pool);
+  sf_pool_free(&ctx->light_pool);
+  sf_pool_free(&ctx->sprite_pool);
+  sf_pool_free(&ctx->emitr_pool);
+  for (int i = 0; i < SF_NAME_MAX; i++) _sf_names_free(&ctx->names[i]);
 
   ctx->state                        = SF_RUN_STATE_STOPPED;
   ctx->arena.offset                 = 0;
+  memset(&ctx->heap, 0, sizeof(sf_heap_t));
   ctx->main_camera.buffer_size      = 0;
   ctx->main_camera.w                = 0;
   ctx->main_camera.h                = 0;
@@ -966,6 +1528,12 @@ void sf_destroy(sf_ctx_t *ctx) {
   ctx->cam_count                    = 0;
   ctx->sprite_count                 = 0;
   ctx->emitr_count                  = 0;
+  ctx->frames_count                 = 0;
+  ctx->entities                     = NULL;
+  ctx->lights                       = NULL;
+  ctx->sprites                      = NULL;
+  ctx->emitrs                       = NULL;
+  ctx->frames                       = NULL;
 }
 
 bool sf_running(sf_ctx_t *ctx) {
@@ -980,251 +1548,1065 @@ void sf_stop(sf_ctx_t *ctx) {
 
 void sf_render_enti(sf_ctx_t *ctx, sf_cam_t *cam, sf_enti_t *enti) {
   /* Rasterize one entity into cam: frustum-cull, light, near-clip, then draw textured or flat triangles. */
-  if (!enti || !enti->frame) return;
+  sf_render_enti_views(ctx, &cam, 1, enti);
+}
+
+void sf_render_enti_views(sf_ctx_t *ctx, sf_cam_t **cams, int n, sf_enti_t *enti) {
+  /* Rasterize one entity into n cameras: cull by layer and frustum, light each face once (in the first visible
+   * camera's view space) and reuse it for the rest, then clip at each camera's near plane and draw. Cameras with
+   * the same pose share one vertex transform. Cull results and vertex scratch come from the worker's frame arena,
+   * or from one malloc'd block when called off the pool. */
+  if (!enti || !enti->frame || n <= 0) return;
+  if (n > SF_MAX_CAMS + 1) {
+    SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "'%s' drawn into the first %d of %d cameras\n",
+                enti->name ? enti->name : "(null)", SF_MAX_CAMS + 1, n);
+    n = SF_MAX_CAMS + 1;
+  }
 
-  sf_fmat4_t M = enti->frame->global_M;
-  sf_fmat4_t V = cam->V;
-  sf_fmat4_t P = cam->P;
-  sf_fmat4_t MV = sf_fmat4_mul_fmat4(M, V);
+  sf_fmat43_t M = _sf_render_M(ctx, cams[0], enti->frame);
 
   float sx = sqrtf(M.m[0][0]*M.m[0][0] + M.m[0][1]*M.m[0][1] + M.m[0][2]*M.m[0][2]);
   float sy = sqrtf(M.m[1][0]*M.m[1][0] + M.m[1][1]*M.m[1][1] + M.m[1][2]*M.m[1][2]);
   float sz = sqrtf(M.m[2][0]*M.m[2][0] + M.m[2][1]*M.m[2][1] + M.m[2][2]*M.m[2][2]);
   float max_s = sx > sy ? (sx > sz ? sx : sz) : (sy > sz ? sy : sz);
   float r = enti->obj.bs_radius * max_s;
-  sf_fvec3_t c = sf_fmat4_mul_vec3(MV, enti->obj.bs_center);
-  float fov_r = cam->fov * 0.01745329f * 0.5f;
-  float aspect = (float)cam->w / (float)cam->h;
-  float cos_v = cosf(fov_r);
-  float sin_v = sinf(fov_r);
-  float cos_h = cosf(atanf(tanf(fov_r) * aspect));
-  float sin_h = sinf(atanf(tanf(fov_r) * aspect));
-  if (c.z - r > -cam->near_plane) { return; }
-  if (c.z + r < -cam->far_plane)  { return; }
-  if ( c.x * cos_h + c.z * sin_h > r) { return; }
-  if (-c.x * cos_h + c.z * sin_h > r) { return; }
-  if ( c.y * cos_v + c.z * sin_v > r) { return; }
-  if (-c.y * cos_v + c.z * sin_v > r) { return; }
 
-  ctx->_perf_tri_count += enti->obj.f_cnt;
+  const sf_weld_t  *wd    = enti->obj.weld;
+  bool              weld  = wd && wd->valid && wd->f_cnt == enti->obj.f_cnt;
+  const sf_fvec3_t *pos   = weld ? wd->v     : enti->obj.v;
+  int               n_pos = weld ? wd->v_cnt : enti->obj.v_cnt;
+  int         n_vec = 2 * n_pos + (n > 1 ? n_pos + enti->obj.f_cnt : 0);
+  size_t      b_sz  = (size_t)n * (sizeof(sf_fmat43_t) + sizeof(sf_cam_t*)) + (size_t)n_vec * sizeof(sf_fvec3_t);
+  sf_arena_t *tmp   = sf_tmp_arena(ctx);
+  size_t      mark  = tmp ? sf_arena_save(ctx, tmp) : 0;
+  uint8_t    *blk   = tmp ? (uint8_t*)sf_arena_alloc(ctx, tmp, b_sz) : (uint8_t*)malloc(b_sz);
+  if (!blk) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to render '%s', no transient memory for %d verts\n",
+                enti->name ? enti->name : "(null)", n_vec);
+    return;
+  }
+  sf_fmat43_t *vis_MV = (sf_fmat43_t*)blk;
+  sf_cam_t   **vis    = (sf_cam_t**)(vis_MV + n);
+  sf_fvec3_t  *vv0    = (sf_fvec3_t*)(vis + n);
+  int          n_vis  = 0;
+  for (int k = 0; k < n; k++) {
+    sf_cam_t   *cam = cams[k];
+    if (!(enti->layers & cam->cull_mask)) { continue; }
+    sf_fmat43_t MV  = sf_fmat43_mul_fmat43(M, cam->V);
+    sf_fvec3_t c = sf_fmat43_mul_vec3(MV, enti->obj.bs_center);
+    if (c.z - r > -cam->near_plane) { continue; }
+    if (c.z + r < -cam->far_plane)  { continue; }
+    bool out = false;
+    for (int p = 0; p < 4 && !out; p++) {
+      int   j  = p >> 1;
+      float sg = (p & 1) ? -1.0f : 1.0f;
+      float a  = cam->P.m[0][3] + sg * cam->P.m[0][j];
+      float b  = cam->P.m[1][3] + sg * cam->P.m[1][j];
+      float cc = cam->P.m[2][3] + sg * cam->P.m[2][j];
+      float d  = cam->P.m[3][3] + sg * cam->P.m[3][j];
+      out = a * c.x + b * c.y + cc * c.z + d < -r * sqrtf(a * a + b * b + cc * cc);
+    }
+    if (out) { continue; }
+    vis[n_vis]      = cam;
+    vis_MV[n_vis++] = MV;
+  }
+  if (n_vis == 0) {
+    if (tmp) sf_arena_restore(ctx, tmp, mark);
+    else     free(blk);
+    return;
+  }
 
-  size_t mark = sf_arena_save(ctx, &ctx->arena);
-  float near = 0.1f;
-  sf_fvec3_t* vv = sf_arena_alloc(ctx, &ctx->arena, enti->obj.v_cnt * sizeof(sf_fvec3_t));
-  if (!vv) return;
+  ctx->_perf_tri_count += enti->obj.f_cnt * n_vis;
 
-  for (int i = 0; i < enti->obj.v_cnt; i++) {
-    vv[i] = sf_fmat4_mul_vec3(MV, enti->obj.v[i]);
-  }
+  sf_fvec3_t* sv  = vv0 + n_pos;
+  sf_fvec3_t* vvk = sv + n_pos;
+  sf_fvec3_t* lit = (n_vis > 1) ? vvk + n_pos : NULL;
+  for (int i = 0; lit && i < enti->obj.f_cnt; i++) lit[i].x = -1.0f;
+
+  sf_fmat43_t MV = vis_MV[0];
+  sf_fmat43_t V  = vis[0]->V;
+  if (weld && wd->qv) _sf_fmat43_mul_q16_n(sf_fmat43_mul_fmat43(_sf_weld_dequant(wd), MV), wd->qv, vv0, n_pos);
+  else                sf_fmat43_mul_vec3_n(MV, pos, vv0, n_pos);
 
-  struct { sf_fvec3_t pos_v, dir_v, color; float intensity; sf_light_type_t type; } lv[SF_MAX_LIGHTS];
+  struct { sf_fvec3_t pos_v, dir_v, color; float intensity; sf_light_type_t type; } lv[SF_MAX_SHADE_LIGHTS];
   int lv_cnt = 0;
-  for (int l = 0; l < ctx->light_count && l < SF_MAX_LIGHTS; l++) {
-    sf_light_t *light = &ctx->lights[l];
+  const sf_snap_t *rs = vis[0]->_rs;
+  bool        wire    = _sf_render_look(ctx, vis[0]).render_mode == SF_RENDER_WIREFRAME;
+  int         l_count = rs ? rs->light_count : ctx->light_count;
+  for (int l = 0; l < l_count && lv_cnt < SF_MAX_SHADE_LIGHTS; l++) {
+    sf_light_t *light = rs ? &rs->lights[l] : ctx->lights[l];
     if (!light->frame) continue;
-    sf_fmat4_t lM = light->frame->global_M;
+    sf_fmat43_t lM = _sf_render_M(ctx, vis[0], light->frame);
     sf_fvec3_t lp_w = {lM.m[3][0], lM.m[3][1], lM.m[3][2]};
-    lv[lv_cnt].pos_v = sf_fmat4_mul_vec3(V, lp_w);
+    lv[lv_cnt].pos_v = sf_fmat43_mul_vec3(V, lp_w);
     lv[lv_cnt].type = light->type;
     lv[lv_cnt].intensity = light->intensity;
     lv[lv_cnt].color = light->color;
     if (light->type == SF_LIGHT_DIR) {
       sf_fvec3_t dir_w = {-lM.m[2][0], -lM.m[2][1], -lM.m[2][2]};
-      sf_fvec3_t end_v = sf_fmat4_mul_vec3(V, sf_fvec3_add(lp_w, dir_w));
+      sf_fvec3_t end_v = sf_fmat43_mul_vec3(V, sf_fvec3_add(lp_w, dir_w));
       lv[lv_cnt].dir_v = sf_fvec3_norm(sf_fvec3_sub(end_v, lv[lv_cnt].pos_v));
     }
     lv_cnt++;
   }
 
-  for (int i = 0; i < enti->obj.f_cnt; i++) {
-    sf_face_t face = enti->obj.f[i];
-    sf_fvec3_t v_view[3] = { vv[face.idx[0].v], vv[face.idx[1].v], vv[face.idx[2].v] };
-    sf_fvec3_t a_v = sf_fvec3_sub(v_view[1], v_view[0]);
-    sf_fvec3_t b_v = sf_fvec3_sub(v_view[2], v_view[0]);
-    sf_fvec3_t n_v = sf_fvec3_cross(a_v, b_v);
-
-    if (sf_fvec3_dot(n_v, v_view[0]) >= 0) continue;
-
-    sf_fvec3_t n = sf_fvec3_norm(n_v);
-    sf_fvec3_t centroid_v = {
-      (v_view[0].x + v_view[1].x + v_view[2].x) * 0.333333f,
-      (v_view[0].y + v_view[1].y + v_view[2].y) * 0.333333f,
-      (v_view[0].z + v_view[1].z + v_view[2].z) * 0.333333f
-    };
-
-    sf_fvec3_t l_int = {0.1f, 0.1f, 0.1f};
+  const sf_fmat43_t *vvk_MV = NULL;
+  for (int k = 0; k < n_vis; k++) {
+    sf_cam_t   *cam  = vis[k];
+    sf_fmat4_t  P    = cam->P;
+    float       near = cam->near_plane;
+    sf_fvec3_t *vv   = vv0;
+    if (k > 0 && memcmp(&vis_MV[k], &vis_MV[0], sizeof(sf_fmat43_t)) != 0) {
+      vv = vvk;
+      if (!vvk_MV || memcmp(&vis_MV[k], vvk_MV, sizeof(sf_fmat43_t)) != 0) {
+        if (weld && wd->qv) _sf_fmat43_mul_q16_n(sf_fmat43_mul_fmat43(_sf_weld_dequant(wd), vis_MV[k]), wd->qv, vv, n_pos);
+        else                sf_fmat43_mul_vec3_n(vis_MV[k], pos, vv, n_pos);
+        vvk_MV = &vis_MV[k];
+      }
+    }
+    _sf_project_verts(ctx, cam, vv, sv, n_pos, P);
+    for (int i = 0; i < enti->obj.f_cnt; i++) {
+      const sf_face_t *face = weld ? NULL : &enti->obj.f[i];
+      int c[3];
+      for (int j = 0; j < 3; j++) {
+        c[j] = !weld ? face->idx[j].v : wd->idx16 ? (int)wd->idx16[i * 3 + j] : (int)wd->idx32[i * 3 + j];
+      }
+      sf_fvec3_t v_view[3] = { vv[c[0]], vv[c[1]], vv[c[2]] };
+      sf_fvec3_t v_scr[3]  = { sv[c[0]], sv[c[1]], sv[c[2]] };
+      sf_fvec3_t a_v = sf_fvec3_sub(v_view[1], v_view[0]);
+      sf_fvec3_t b_v = sf_fvec3_sub(v_view[2], v_view[0]);
+      sf_fvec3_t n_v = sf_fvec3_cross(a_v, b_v);
 
-    for (int l = 0; l < lv_cnt; l++) {
-      sf_fvec3_t light_dir;
-      float atten = 1.0f;
+      if (sf_fvec3_dot(n_v, v_view[0]) >= 0) continue;
 
-      if (lv[l].type == SF_LIGHT_DIR) {
-        light_dir = lv[l].dir_v;
+      sf_fvec3_t l_int = {0.1f, 0.1f, 0.1f};
+      if (lit && lit[i].x >= 0.0f) {
+        l_int = lit[i];
       } else {
-        sf_fvec3_t diff = sf_fvec3_sub(lv[l].pos_v, centroid_v);
-        float dist_sq = diff.x*diff.x + diff.y*diff.y + diff.z*diff.z;
-        float dist = sqrtf(dist_sq);
-        float inv_dist = (dist > 0.0f) ? 1.0f / dist : 0.0f;
-        light_dir = (sf_fvec3_t){ diff.x * inv_dist, diff.y * inv_dist, diff.z * inv_dist };
-        atten = 1.0f / (1.0f + 0.09f * dist + 0.032f * dist_sq);
-      }
+        sf_fvec3_t w[3] = { vv0[c[0]], vv0[c[1]], vv0[c[2]] };
+        sf_fvec3_t n = sf_fvec3_norm(k == 0 ? n_v : sf_fvec3_cross(sf_fvec3_sub(w[1], w[0]), sf_fvec3_sub(w[2], w[0])));
+        sf_fvec3_t centroid_v = {
+          (w[0].x + w[1].x + w[2].x) * 0.333333f,
+          (w[0].y + w[1].y + w[2].y) * 0.333333f,
+          (w[0].z + w[1].z + w[2].z) * 0.333333f
+        };
+
+        for (int l = 0; l < lv_cnt; l++) {
+          sf_fvec3_t light_dir;
+          float atten = 1.0f;
+
+          if (lv[l].type == SF_LIGHT_DIR) {
+            light_dir = lv[l].dir_v;
+          } else {
+            sf_fvec3_t diff = sf_fvec3_sub(lv[l].pos_v, centroid_v);
+            float dist_sq = diff.x*diff.x + diff.y*diff.y + diff.z*diff.z;
+            float dist = sqrtf(dist_sq);
+            float inv_dist = (dist > 0.0f) ? 1.0f / dist : 0.0f;
+            light_dir = (sf_fvec3_t){ diff.x * inv_dist, diff.y * inv_dist, diff.z * inv_dist };
+            atten = 1.0f / (1.0f + 0.09f * dist + 0.032f * dist_sq);
+          }
 
-      float diff_factor = sf_fvec3_dot(n, light_dir);
-      if (diff_factor > 0.0f) {
-        l_int.x += lv[l].color.x * lv[l].intensity * diff_factor * atten;
-        l_int.y += lv[l].color.y * lv[l].intensity * diff_factor * atten;
-        l_int.z += lv[l].color.z * lv[l].intensity * diff_factor * atten;
-      }
-    }
+          float diff_factor = sf_fvec3_dot(n, light_dir);
+          if (diff_factor > 0.0f) {
+            l_int.x += lv[l].color.x * lv[l].intensity * diff_factor * atten;
+            l_int.y += lv[l].color.y * lv[l].intensity * diff_factor * atten;
+            l_int.z += lv[l].color.z * lv[l].intensity * diff_factor * atten;
+          }
+        }
 
-    l_int.x = l_int.x > 1.0f ? 1.0f : l_int.x;
-    l_int.y = l_int.y > 1.0f ? 1.0f : l_int.y;
-    l_int.z = l_int.z > 1.0f ? 1.0f : l_int.z;
-    sf_fvec2_t uvs[3] = {0};
-    bool has_uvs = (enti->obj.vt_cnt > 0 && face.idx[0].vt != -1);
-    if (has_uvs) {
-      uvs[0] = enti->obj.vt[face.idx[0].vt];
-      uvs[1] = enti->obj.vt[face.idx[1].vt];
-      uvs[2] = enti->obj.vt[face.idx[2].vt];
-      for (int j = 0; j < 3; j++) {
-        uvs[j].x *= enti->tex_scale.x;
-        uvs[j].y *= enti->tex_scale.y;
+        l_int.x = l_int.x > 1.0f ? 1.0f : l_int.x;
+        l_int.y = l_int.y > 1.0f ? 1.0f : l_int.y;
+        l_int.z = l_int.z > 1.0f ? 1.0f : l_int.z;
+        if (lit) lit[i] = l_int;
       }
-    }
-    sf_fvec3_t uvz[3];
-    for (int j = 0; j < 3; j++) {
-      float z = -v_view[j].z;
-      if (z < near) z = near;
-      float iz = 1.0f / z;
-      uvz[j] = (sf_fvec3_t){ uvs[j].x * iz, uvs[j].y * iz, iz };
-    }
-    sf_fvec3_t in[3], out[3], in_uvz[3], out_uvz[3];
-    int inc = 0, outc = 0;
-    for (int j = 0; j < 3; j++) {
-      if (v_view[j].z <= -near) {
-        in_uvz[inc] = uvz[j];
-        in[inc++] = v_view[j];
-      } else {
-        out_uvz[outc] = uvz[j];
-        out[outc++] = v_view[j];
+      sf_fvec2_t uvs[3] = {0};
+      bool has_uvs = weld ? (wd->vt || wd->qt) : (enti->obj.vt_cnt > 0 && face->idx[0].vt != -1);
+      if (has_uvs) {
+        for (int j = 0; j < 3; j++) {
+          if (!weld)       uvs[j] = enti->obj.vt[face->idx[j].vt];
+          else if (wd->vt) uvs[j] = wd->vt[c[j]];
+          else             uvs[j] = (sf_fvec2_t){ wd->qt_o.x + (float)wd->qt[c[j] * 2] * wd->qt_s.x, wd->qt_o.y + (float)wd->qt[c[j] * 2 + 1] * wd->qt_s.y };
+          uvs[j].x *= enti->tex_scale.x;
+          uvs[j].y *= enti->tex_scale.y;
+        }
       }
-    }
-    if (ctx->render_mode == SF_RENDER_WIREFRAME) {
-      if (inc > 0) {
-        sf_pkd_clr_t wclr = 0xFF44FF44u;
-        bool vis0 = (v_view[0].z <= -near), vis1 = (v_view[1].z <= -near), vis2 = (v_view[2].z <= -near);
-        sf_fvec3_t sv0 = _sf_project_vertex(ctx, cam, v_view[0], P);
-        sf_fvec3_t sv1 = _sf_project_vertex(ctx, cam, v_view[1], P);
-        sf_fvec3_t sv2 = _sf_project_vertex(ctx, cam, v_view[2], P);
-        if (vis0 && vis1) sf_line(ctx, cam, wclr, (sf_ivec2_t){(int)sv0.x,(int)sv0.y}, (sf_ivec2_t){(int)sv1.x,(int)sv1.y});
-        if (vis1 && vis2) sf_line(ctx, cam, wclr, (sf_ivec2_t){(int)sv1.x,(int)sv1.y}, (sf_ivec2_t){(int)sv2.x,(int)sv2.y});
-        if (vis2 && vis0) sf_line(ctx, cam, wclr, (sf_ivec2_t){(int)sv2.x,(int)sv2.y}, (sf_ivec2_t){(int)sv0.x,(int)sv0.y});
+      sf_fvec3_t uvz[3];
+      for (int j = 0; j < 3; j++) {
+        float z = -v_view[j].z;
+        if (z < near) z = near;
+        float iz = 1.0f / z;
+        uvz[j] = (sf_fvec3_t){ uvs[j].x * iz, uvs[j].y * iz, iz };
       }
-    } else if (enti->tex && has_uvs) {
-      if (inc == 3) {
-        sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, in[2], P), in_uvz[0], in_uvz[1], in_uvz[2], l_int, 1.0f);
-      } else if (inc == 1) {
-        float t1 = ((-near) - in[0].z) / (out[0].z - in[0].z);
-        float t2 = ((-near) - in[0].z) / (out[1].z - in[0].z);
-        sf_fvec3_t v1 = { in[0].x + (out[0].x - in[0].x) * t1, in[0].y + (out[0].y - in[0].y) * t1, -near };
-        sf_fvec3_t v2 = { in[0].x + (out[1].x - in[0].x) * t2, in[0].y + (out[1].y - in[0].y) * t2, -near };
-        sf_fvec3_t uvz1 = { in_uvz[0].x + (out_uvz[0].x - in_uvz[0].x) * t1, in_uvz[0].y + (out_uvz[0].y - in_uvz[0].y) * t1, in_uvz[0].z + (out_uvz[0].z - in_uvz[0].z) * t1 };
-        sf_fvec3_t uvz2 = { in_uvz[0].x + (out_uvz[1].x - in_uvz[0].x) * t2, in_uvz[0].y + (out_uvz[1].y - in_uvz[0].y) * t2, in_uvz[0].z + (out_uvz[1].z - in_uvz[0].z) * t2 };
-        sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, v1, P), _sf_project_vertex(ctx, cam, v2, P), in_uvz[0], uvz1, uvz2, l_int, 1.0f);
-      } else if (inc == 2) {
-        float t1 = ((-near) - in[0].z) / (out[0].z - in[0].z);
-        float t2 = ((-near) - in[1].z) / (out[0].z - in[1].z);
-        sf_fvec3_t v1 = { in[0].x + (out[0].x - in[0].x) * t1, in[0].y + (out[0].y - in[0].y) * t1, -near };
-        sf_fvec3_t v2 = { in[1].x + (out[0].x - in[1].x) * t2, in[1].y + (out[0].y - in[1].y) * t2, -near };
-        sf_fvec3_t uvz1 = { in_uvz[0].x + (out_uvz[0].x - in_uvz[0].x) * t1, in_uvz[0].y + (out_uvz[0].y - in_uvz[0].y) * t1, in_uvz[0].z + (out_uvz[0].z - in_uvz[0].z) * t1 };
-        sf_fvec3_t uvz2 = { in_uvz[1].x + (out_uvz[0].x - in_uvz[1].x) * t2, in_uvz[1].y + (out_uvz[0].y - in_uvz[1].y) * t2, in_uvz[1].z + (out_uvz[0].z - in_uvz[1].z) * t2 };
-        sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P), in_uvz[0], in_uvz[1], uvz1, l_int, 1.0f);
-        sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P), _sf_project_vertex(ctx, cam, v2, P), in_uvz[1], uvz1, uvz2, l_int, 1.0f);
+      sf_fvec3_t in[3], out[3], in_uvz[3], out_uvz[3];
+      int inc = 0, outc = 0;
+      for (int j = 0; j < 3; j++) {
+        if (v_view[j].z <= -near) {
+          in_uvz[inc] = uvz[j];
+          in[inc++] = v_view[j];
+        } else {
+          out_uvz[outc] = uvz[j];
+          out[outc++] = v_view[j];
+        }
       }
-    } else {
-      sf_pkd_clr_t shaded_color = _sf_pack_color((sf_unpkd_clr_t){(uint8_t)(l_int.x * 255), (uint8_t)(l_int.y * 255), (uint8_t)(l_int.z * 255), 255});
-      if (inc == 3) {
-        sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, v_view[0], P), _sf_project_vertex(ctx, cam, v_view[1], P), _sf_project_vertex(ctx, cam, v_view[2], P), true);
-      } else if (inc == 1) {
-        sf_fvec3_t v1 = _sf_intersect_near(in[0], out[0], -near);
-        sf_fvec3_t v2 = _sf_intersect_near(in[0], out[1], -near);
-        sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, v1, P), _sf_project_vertex(ctx, cam, v2, P), true);
-      } else if (inc == 2) {
-        sf_fvec3_t v1 = _sf_intersect_near(in[0], out[0], -near);
-        sf_fvec3_t v2 = _sf_intersect_near(in[1], out[0], -near);
-        sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P), true);
-        sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P),    _sf_project_vertex(ctx, cam, v2, P), true);
+      if (wire) {
+        if (inc > 0) {
+          sf_pkd_clr_t wclr = 0xFF44FF44u;
+          bool vis0 = (v_view[0].z <= -near), vis1 = (v_view[1].z <= -near), vis2 = (v_view[2].z <= -near);
+          sf_fvec3_t sv0 = v_scr[0], sv1 = v_scr[1], sv2 = v_scr[2];
+          if (vis0 && vis1) sf_line(ctx, cam, wclr, (sf_ivec2_t){(int)sv0.x,(int)sv0.y}, (sf_ivec2_t){(int)sv1.x,(int)sv1.y});
+          if (vis1 && vis2) sf_line(ctx, cam, wclr, (sf_ivec2_t){(int)sv1.x,(int)sv1.y}, (sf_ivec2_t){(int)sv2.x,(int)sv2.y});
+          if (vis2 && vis0) sf_line(ctx, cam, wclr, (sf_ivec2_t){(int)sv2.x,(int)sv2.y}, (sf_ivec2_t){(int)sv0.x,(int)sv0.y});
+        }
+      } else if (enti->tex && has_uvs) {
+        if (inc == 3) {
+          sf_tri_tex(ctx, cam, enti->tex, v_scr[0], v_scr[1], v_scr[2], in_uvz[0], in_uvz[1], in_uvz[2], l_int, 1.0f);
+        } else if (inc == 1) {
+          float t1 = ((-near) - in[0].z) / (out[0].z - in[0].z);
+          float t2 = ((-near) - in[0].z) / (out[1].z - in[0].z);
+          sf_fvec3_t v1 = { in[0].x + (out[0].x - in[0].x) * t1, in[0].y + (out[0].y - in[0].y) * t1, -near };
+          sf_fvec3_t v2 = { in[0].x + (out[1].x - in[0].x) * t2, in[0].y + (out[1].y - in[0].y) * t2, -near };
+          sf_fvec3_t uvz1 = { in_uvz[0].x + (out_uvz[0].x - in_uvz[0].x) * t1, in_uvz[0].y + (out_uvz[0].y - in_uvz[0].y) * t1, in_uvz[0].z + (out_uvz[0].z - in_uvz[0].z) * t1 };
+          sf_fvec3_t uvz2 = { in_uvz[0].x + (out_uvz[1].x - in_uvz[0].x) * t2, in_uvz[0].y + (out_uvz[1].y - in_uvz[0].y) * t2, in_uvz[0].z + (out_uvz[1].z - in_uvz[0].z) * t2 };
+          sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, v1, P), _sf_project_vertex(ctx, cam, v2, P), in_uvz[0], uvz1, uvz2, l_int, 1.0f);
+        } else if (inc == 2) {
+          float t1 = ((-near) - in[0].z) / (out[0].z - in[0].z);
+          float t2 = ((-near) - in[1].z) / (out[0].z - in[1].z);
+          sf_fvec3_t v1 = { in[0].x + (out[0].x - in[0].x) * t1, in[0].y + (out[0].y - in[0].y) * t1, -near };
+          sf_fvec3_t v2 = { in[1].x + (out[0].x - in[1].x) * t2, in[1].y + (out[0].y - in[1].y) * t2, -near };
+          sf_fvec3_t uvz1 = { in_uvz[0].x + (out_uvz[0].x - in_uvz[0].x) * t1, in_uvz[0].y + (out_uvz[0].y - in_uvz[0].y) * t1, in_uvz[0].z + (out_uvz[0].z - in_uvz[0].z) * t1 };
+          sf_fvec3_t uvz2 = { in_uvz[1].x + (out_uvz[0].x - in_uvz[1].x) * t2, in_uvz[1].y + (out_uvz[0].y - in_uvz[1].y) * t2, in_uvz[1].z + (out_uvz[0].z - in_uvz[1].z) * t2 };
+          sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P), in_uvz[0], in_uvz[1], uvz1, l_int, 1.0f);
+          sf_tri_tex(ctx, cam, enti->tex, _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P), _sf_project_vertex(ctx, cam, v2, P), in_uvz[1], uvz1, uvz2, l_int, 1.0f);
+        }
+      } else {
+        sf_pkd_clr_t shaded_color = _sf_pack_color((sf_unpkd_clr_t){(uint8_t)(l_int.x * 255), (uint8_t)(l_int.y * 255), (uint8_t)(l_int.z * 255), 255});
+        if (inc == 3) {
+          sf_tri(ctx, cam, shaded_color, v_scr[0], v_scr[1], v_scr[2], true);
+        } else if (inc == 1) {
+          sf_fvec3_t v1 = _sf_intersect_near(in[0], out[0], -near);
+          sf_fvec3_t v2 = _sf_intersect_near(in[0], out[1], -near);
+          sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, v1, P), _sf_project_vertex(ctx, cam, v2, P), true);
+        } else if (inc == 2) {
+          sf_fvec3_t v1 = _sf_intersect_near(in[0], out[0], -near);
+          sf_fvec3_t v2 = _sf_intersect_near(in[1], out[0], -near);
+          sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, in[0], P), _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P), true);
+          sf_tri(ctx, cam, shaded_color, _sf_project_vertex(ctx, cam, in[1], P), _sf_project_vertex(ctx, cam, v1, P),    _sf_project_vertex(ctx, cam, v2, P), true);
+        }
       }
     }
   }
-  sf_arena_restore(ctx, &ctx->arena, mark);
+  if (tmp) sf_arena_restore(ctx, tmp, mark);
+  else     free(blk);
 }
 
 void sf_render_ctx(sf_ctx_t *ctx) {
-  /* Update frames and emitters, then render all cameras including the main camera. */
+  /* Update frames and emitters, then render every camera (or view_group of cameras) that is due as its own job;
+   * cameras skipped by their update rate (or, with ctx->on_demand, unchanged) keep their last image. */
   sf_update_frames(ctx);
   sf_update_emitrs(ctx);
+  sf_render_sync(ctx);
+  sf_dyn_res_update(ctx);
+  uint64_t scene = ctx->on_demand ? _sf_scene_sig(ctx) : 0;
+  for (int i = 0; i <= ctx->cam_count; i++) {
+    sf_cam_t *cam = _sf_render_cam_at(ctx, NULL, i);
+    cam->_due = !ctx->on_demand || _sf_render_changed(ctx, cam, scene);
+  }
+  ctx->_idle = true;
+  for (int i = 0; i <= ctx->cam_count; i++) {
+    sf_cam_t *cam  = _sf_render_cam_at(ctx, NULL, i);
+    sf_cam_t *lead = cam;
+    for (int j = 0; j < i && cam->view_group; j++) {
+      sf_cam_t *c = _sf_render_cam_at(ctx, NULL, j);
+      if (c->view_group == cam->view_group) { lead = c; break; }
+    }
+    bool changed = cam->_due;
+    cam->_keep   = ctx->on_demand || lead->update_every > 1 || lead->update_hz > 0.0f;
+    for (int j = i; lead == cam && j <= ctx->cam_count && (j == i || cam->view_group); j++) {
+      sf_cam_t *c = _sf_render_cam_at(ctx, NULL, j);
+      if (c->view_group != cam->view_group) continue;
+      if (c->_due) changed = true;
+      if (cam->_keep && c->ext_px && !c->_od_px) {
+        changed         = true;
+        cam->_has_frame = false;
+      }
+    }
+    cam->_due = (lead == cam) ? (changed && _sf_render_due(ctx, cam)) : lead->_due;
+    if (cam->_due) {
+      cam->_sig = cam->_sig_next;
+      if (cam->_settle > 0) cam->_settle--;
+      ctx->_idle = false;
+    } else if (cam->_keep) {
+      _sf_od_keep(cam, false);
+    }
+  }
+  ctx->_render_frame++;
+  bool pipe = ctx->pipelined && _sf_snap_take(ctx);
   ctx->_perf_tri_count = 0;
-  sf_render_cam(ctx, &ctx->main_camera);
-  for (int i = 0; i < ctx->cam_count; ++i) {
-    sf_render_cam(ctx, &ctx->cameras[i]);
+
+  sf_event_t ev;
+  ev.type = SF_EVT_RENDER_START;
+  sf_event_trigger(ctx, &ev);
+
+  sf_job_ctr_t  local;
+  sf_job_ctr_t *done = pipe ? &ctx->_snap.done : &local;
+  atomic_init(&done->n, 0);
+  for (int i = ctx->cam_count; i >= 0; --i) {
+    sf_cam_t *cam = _sf_render_cam_at(ctx, NULL, i);
+    bool      led = cam->_due;
+    for (int j = 0; j < i && cam->view_group; j++) {
+      if (_sf_render_cam_at(ctx, NULL, j)->view_group == cam->view_group) led = false;
+    }
+    if (led) sf_jobs_submit(ctx, _sf_render_cam_job, pipe ? &ctx->_snap : NULL, i, i + 1, NULL, done);
+  }
+  if (pipe) {
+    ctx->_snap.in_flight = true;
+    ctx->_snap.tmp_flips = 0;
+    return;
+  }
+  sf_jobs_wait(ctx, done);
+  for (int i = 0; i <= ctx->cam_count; i++) {
+    sf_cam_t *cam = _sf_render_cam_at(ctx, NULL, i);
+    if (cam->_due && cam->_keep) _sf_od_keep(cam, true);
   }
+
+  ev.type = SF_EVT_RENDER_END;
+  sf_event_trigger(ctx, &ev);
 }
 
 void sf_render_cam(sf_ctx_t *ctx, sf_cam_t *cam) {
   /* Clear and render a single camera: fire RENDER_START/END events, rebuild projection if dirty, draw all entities. */
+  sf_render_cams(ctx, &cam, 1);
+}
+
+void sf_render_cams(sf_ctx_t *ctx, sf_cam_t **cams, int n) {
+  /* Render n cameras together (e.g. a stereo pair), sharing per-entity lighting between them; fires RENDER_START/END once. */
   sf_event_t ev_start;
   ev_start.type = SF_EVT_RENDER_START;
   sf_event_trigger(ctx, &ev_start);
 
-  if (cam->is_proj_dirty) {
-    float aspect = (float)cam->w / (float)cam->h;
-    cam->P = sf_make_psp_fmat4(cam->fov, aspect, cam->near_plane, cam->far_plane);
-    cam->is_proj_dirty = false;
+  _sf_render_pass(ctx, cams, n);
+
+  sf_event_t ev_end;
+  ev_end.type = SF_EVT_RENDER_END;
+  sf_event_trigger(ctx, &ev_end);
+}
+
+void _sf_render_pass(sf_ctx_t *ctx, sf_cam_t **cams, int n) {
+  /* Draw n cameras without firing events; touches only their own buffers, so separate passes can run side by side.
+   * Entities, billboards and emitters outside a camera's cull_mask are skipped before any transform work.
+   * Cameras with an ROI draw only that rectangle; otherwise res_scale below 1 draws a low-resolution proxy to upscale. */
+  sf_look_t look     = _sf_render_look(ctx, cams[0]);
+  bool      no_bg    = (look.render_mode == SF_RENDER_DEPTH);
+  bool      sky_last = look.sky_last && look.render_mode == SF_RENDER_NORMAL;
+  uint32_t  mask     = 0;
+  sf_cam_t *full[SF_MAX_CAMS + 1];
+  sf_cam_t *view[SF_MAX_CAMS + 1];
+  if (n > SF_MAX_CAMS + 1) {
+    SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "rendering the first %d of %d cameras\n", SF_MAX_CAMS + 1, n);
+    n = SF_MAX_CAMS + 1;
+  }
+  for (int k = 0; k < n; k++) {
+    full[k] = cams[k];
+    view[k] = _sf_roi_view(ctx, cams[k]);
+    if (view[k] == cams[k]) view[k] = _sf_dyn_res_view(ctx, cams[k]);
+  }
+  cams = view;
+  for (int k = 0; k < n; k++) {
+    sf_cam_t *cam = cams[k];
+    mask |= cam->cull_mask;
+    if (cam->is_proj_dirty) {
+      float aspect = (float)cam->w / (float)cam->h;
+      cam->P = sf_make_psp_fmat4(cam->fov, aspect, cam->near_plane, cam->far_plane);
+      cam->is_proj_dirty = false;
+    }
+
+    if (cam->frame) {
+      sf_fmat43_t gM = _sf_render_M(ctx, cam, cam->frame);
+
+      sf_fvec3_t eye    = { gM.m[3][0],  gM.m[3][1],  gM.m[3][2] };
+      sf_fvec3_t fwd    = {-gM.m[2][0], -gM.m[2][1], -gM.m[2][2] };
+      sf_fvec3_t up     = { gM.m[1][0],  gM.m[1][1],  gM.m[1][2] };
+
+      sf_fvec3_t target = sf_fvec3_add(eye, fwd);
+      cam->V = sf_fmat4_to_fmat43(sf_make_view_fmat4(eye, target, up));
+    }
+
+    sf_clear_depth(ctx, cam);
+    if (!no_bg && !sky_last) {
+      if (look.sky && (cam->features & SF_CAM_SKYBOX)) {
+        sf_render_skybox(ctx, cam);
+      } else {
+        sf_fill(ctx, cam, SF_CLR_BLACK);
+      }
+    }
   }
 
-  if (cam->frame) {
-    sf_fmat4_t gM = cam->frame->global_M;
+  const sf_snap_t *rs = cams[0]->_rs;
+  int n_ent = rs ? rs->enti_count : ctx->enti_count;
+  for (int i = 0; i < n_ent; i++) {
+    sf_enti_t *e = rs ? &rs->entities[i] : ctx->entities[i];
+    if (e->layers & mask) sf_render_enti_views(ctx, cams, n, e);
+  }
 
-    sf_fvec3_t eye    = { gM.m[3][0],  gM.m[3][1],  gM.m[3][2] };
-    sf_fvec3_t fwd    = {-gM.m[2][0], -gM.m[2][1], -gM.m[2][2] };
-    sf_fvec3_t up     = { gM.m[1][0],  gM.m[1][1],  gM.m[1][2] };
+  sf_sprite_3_t *bills  = rs ? rs->sprite_3ds : ctx->sprite_3ds;
+  int            n_bill = rs ? rs->sprite_3d_count : ctx->sprite_3d_count;
+  for (int k = 0; k < n; k++) {
+    sf_cam_t *cam = cams[k];
+    if (sky_last) sf_render_sky_fill(ctx, cam);
+    for (int i = 0; i < n_bill && (cam->features & SF_CAM_BILLBOARDS); i++) {
+      if (bills[i].layers & cam->cull_mask) sf_draw_sprite_3d(ctx, cam, &bills[i], 0.0f);
+    }
+    if (cam->features & SF_CAM_PARTICLES) sf_render_emitrs(ctx, cam);
+    sf_render_post(ctx, cam);
+    if (cam == full[k]->_roi)  _sf_roi_done(cam, full[k]);
+    else if (cam != full[k])  _sf_dyn_res_blit(ctx, cam, full[k]);
+  }
+}
 
-    sf_fvec3_t target = sf_fvec3_add(eye, fwd);
-    cam->V = sf_make_view_fmat4(eye, target, up);
+void _sf_render_cam_job(sf_ctx_t *ctx, void *user, int i0, int i1, int worker) {
+  /* sf_render_ctx job body: camera i0 plus every later camera sharing its non-zero view_group.
+   * A non-NULL user is the pipelined snapshot, whose private camera copies are drawn instead. */
+  (void)i1; (void)worker;
+  sf_snap_t *rs    = (sf_snap_t*)user;
+  int        n_cam = rs ? rs->cam_count : ctx->cam_count + 1;
+  sf_cam_t  *group[SF_MAX_CAMS + 1];
+  int        n     = 0;
+  group[n++] = _sf_render_cam_at(ctx, rs, i0);
+  for (int k = i0 + 1; k < n_cam && group[0]->view_group; k++) {
+    sf_cam_t *cam = _sf_render_cam_at(ctx, rs, k);
+    if (cam->view_group == group[0]->view_group) group[n++] = cam;
   }
+  _sf_render_pass(ctx, group, n);
+}
 
-  sf_clear_depth(ctx, cam);
-  if (ctx->active_skybox && ctx->skybox_enabled) {
-    sf_render_skybox(ctx, cam);
-  } else {
-    sf_fill(ctx, cam, SF_CLR_BLACK);
+sf_cam_t* _sf_render_cam_at(sf_ctx_t *ctx, sf_snap_t *rs, int k) {
+  /* Camera k of a frame: 0 is the main camera, k is ctx->cameras[k - 1], or their snapshot copies when rs is set. */
+  if (rs) return &rs->cams[k];
+  return (k == 0) ? &ctx->main_camera : &ctx->cameras[k - 1];
+}
+
+bool _sf_render_due(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Whether cam renders in this sf_render_ctx call under update_every/update_phase and update_hz; advances its
+   * update_hz deadline when it does. A camera that has never rendered is always due. */
+  float now = ctx->elapsed_time;
+  if (cam->_has_frame) {
+    if (cam->update_every > 1 && (ctx->_render_frame + (uint32_t)cam->update_phase) % (uint32_t)cam->update_every != 0) return false;
+    if (cam->update_hz > 0.0f && now < cam->_next_t) return false;
+  }
+  if (cam->update_hz > 0.0f) {
+    cam->_next_t = (cam->_has_frame ? cam->_next_t : now) + 1.0f / cam->update_hz;
+    if (cam->_next_t < now) cam->_next_t = now;
   }
+  cam->_has_frame = true;
+  return true;
+}
 
+bool _sf_render_changed(sf_ctx_t *ctx, sf_cam_t *cam, uint64_t scene) {
+  /* on_demand test: whether anything cam can see differs from its last drawn frame. The new signature waits in
+   * _sig_next until the camera is actually drawn; temporal cameras keep drawing SF_TAA_JITTER frames to converge. */
+  (void)ctx;
+  uint64_t h    = scene;
+  float    f[5] = { cam->fov, cam->near_plane, cam->far_plane, cam->res_scale, (float)cam->view_group };
+  int      k[9] = { cam->w, cam->h, (int)cam->pix_fmt, (int)cam->depth_fmt, (int)cam->temporal,
+                    cam->roi_x, cam->roi_y, cam->roi_w, cam->roi_h };
+  uint32_t m[2] = { cam->cull_mask, cam->features };
+  if (cam->frame) h = _sf_fnv1a(h, &cam->frame->global_M, sizeof(sf_fmat43_t));
+  h = _sf_fnv1a(h, f, sizeof(f));
+  h = _sf_fnv1a(h, k, sizeof(k));
+  h = _sf_fnv1a(h, m, sizeof(m));
+  if (h != cam->_sig && cam->temporal) cam->_settle = SF_TAA_JITTER;
+  cam->_sig_next = h;
+  return !cam->_has_frame || h != cam->_sig || cam->_settle > 0;
+}
+
+uint64_t _sf_scene_sig(sf_ctx_t *ctx) {
+  /* Hash of everything shared by all cameras: entity transforms, meshes and textures, lights, billboards, sky and
+   * fog, plus _scene_gen, which mesh/texture edits, adds, removes and sf_mark_dirty bump so in-place edits and
+   * reused heap pointers are seen. Live emitters and animated billboards make every frame unique. */
+  uint64_t h = _sf_fnv1a(14695981039346656037ull, &ctx->_scene_gen, sizeof(ctx->_scene_gen));
+  int      k[8] = { ctx->enti_count, ctx->light_count, ctx->tex_count, ctx->sprite_3d_count, (int)ctx->render_mode,
+                    (int)ctx->skybox_enabled, (int)ctx->sky_last, (int)ctx->fog_enabled };
+  float    fog[5] = { ctx->fog_color.x, ctx->fog_color.y, ctx->fog_color.z, ctx->fog_start, ctx->fog_end };
+  h = _sf_fnv1a(h, k, sizeof(k));
+  h = _sf_fnv1a(h, fog, sizeof(fog));
+  h = _sf_fnv1a(h, &ctx->active_skybox, sizeof(ctx->active_skybox));
   for (int i = 0; i < ctx->enti_count; i++) {
-    sf_render_enti(ctx, cam, &ctx->entities[i]);
+    sf_enti_t *e = ctx->entities[i];
+    const void *ptr[5] = { e->tex, e->obj.v, e->obj.vt, e->obj.vn, e->obj.f };
+    int         cnt[4] = { e->obj.v_cnt, e->obj.vt_cnt, e->obj.f_cnt, (int)e->layers };
+    h = _sf_fnv1a(h, ptr, sizeof(ptr));
+    h = _sf_fnv1a(h, cnt, sizeof(cnt));
+    h = _sf_fnv1a(h, &e->tex_scale, sizeof(e->tex_scale));
+    if (e->frame) h = _sf_fnv1a(h, &e->frame->global_M, sizeof(sf_fmat43_t));
   }
-
+  for (int i = 0; i < ctx->light_count; i++) {
+    sf_light_t *l = ctx->lights[i];
+    float       v[5] = { (float)l->type, l->color.x, l->color.y, l->color.z, l->intensity };
+    h = _sf_fnv1a(h, v, sizeof(v));
+    if (l->frame) h = _sf_fnv1a(h, &l->frame->global_M, sizeof(sf_fmat43_t));
+  }
+  bool live = false;
   for (int i = 0; i < ctx->sprite_3d_count; i++) {
-    sf_draw_sprite_3d(ctx, cam, &ctx->sprite_3ds[i], 0.0f);
+    sf_sprite_3_t *b = &ctx->sprite_3ds[i];
+    float          v[9] = { b->pos.x, b->pos.y, b->pos.z, b->scale, b->opacity, b->angle,
+                            b->normal.x, b->normal.y, b->normal.z };
+    h = _sf_fnv1a(h, v, sizeof(v));
+    h = _sf_fnv1a(h, &b->sprite, sizeof(b->sprite));
+    h = _sf_fnv1a(h, &b->layers, sizeof(b->layers));
+    if (b->frame)  h = _sf_fnv1a(h, &b->frame->global_M, sizeof(sf_fmat43_t));
+    if (b->sprite && b->sprite->frame_count > 1) live = true;
+  }
+  for (int i = 0; i < ctx->emitr_count && !live; i++) {
+    sf_emitr_t *em = ctx->emitrs[i];
+    if (em->spawn_rate > 0.0f) live = true;
+    for (int j = 0; j < em->max_particles && !live; j++) live = em->particles[j].active;
+  }
+  if (live) h = _sf_fnv1a(h, &ctx->_render_frame, sizeof(ctx->_render_frame));
+  return h;
+}
+
+void _sf_od_keep(sf_cam_t *cam, bool save) {
+  /* Clean copy for on_demand and rate-limited cameras: save cam's freshly drawn pixels, or put them back over
+   * whatever the caller drew on top (gizmos, UI) or left behind (a freshly locked texture) when it is skipped.
+   * Copies are tightly packed and follow set_target into any memory; an external target with no copy is redrawn. */
+  int      bpp = (cam->pix_fmt == SF_PIXFMT_IDX8) ? 1 : (cam->pix_fmt == SF_PIXFMT_RGB565) ? 2 : 4;
+  uint8_t *px  = cam->buffer ? (uint8_t*)cam->buffer : cam->buffer16 ? (uint8_t*)cam->buffer16 : cam->buffer8;
+  size_t   row = (size_t)cam->w * bpp;
+  if (!px) return;
+  if (save && cam->_od_size != row * cam->h) {
+    free(cam->_od_px);
+    cam->_od_size = row * cam->h;
+    cam->_od_px   = malloc(cam->_od_size);
+    if (!cam->_od_px) cam->_od_size = 0;
+  }
+  if (!cam->_od_px || cam->_od_size != row * cam->h) return;
+  for (int y = 0; y < cam->h; y++) {
+    uint8_t *line = px + (size_t)y * cam->stride * bpp;
+    uint8_t *copy = (uint8_t*)cam->_od_px + (size_t)y * row;
+    if (save) memcpy(copy, line, row);
+    else      memcpy(line, copy, row);
+  }
+}
+
+bool sf_render_idle(sf_ctx_t *ctx) {
+  /* True if the last sf_render_ctx redrew no camera (on_demand found nothing changed, or every rate limit skipped);
+   * an idle app can sleep until input arrives instead of presenting the same image again. */
+  return ctx->_idle;
+}
+
+void sf_render_sync(sf_ctx_t *ctx) {
+  /* Finish the pipelined frame in flight, copy it (only the ROI where set) into each camera and fire RENDER_END.
+   * Camera buffers and V/P describe that frame afterwards; returns at once when nothing is in flight. */
+  sf_snap_t *rs = &ctx->_snap;
+  if (!rs->in_flight) return;
+  sf_jobs_wait(ctx, &rs->done);
+  rs->in_flight = false;
+  for (int k = 0; k < rs->cam_count; k++) {
+    sf_cam_t *src = &rs->cams[k];
+    sf_cam_t *dst = (k == 0) ? &ctx->main_camera : (k <= ctx->cam_count) ? &ctx->cameras[k - 1] : NULL;
+    if (!dst || !src->_due || dst->_back_px != src->_back_px || dst->w != src->w || dst->h != src->h || dst->pix_fmt != src->pix_fmt) continue;
+    int      bpp = (dst->pix_fmt == SF_PIXFMT_IDX8) ? 1 : (dst->pix_fmt == SF_PIXFMT_RGB565) ? 2 : 4;
+    uint8_t *out = dst->buffer ? (uint8_t*)dst->buffer : dst->buffer16 ? (uint8_t*)dst->buffer16 : dst->buffer8;
+    uint8_t *in  = (uint8_t*)src->_back_px;
+    if (!out) continue;
+    int x0 = 0, y0 = 0, x1 = src->w, y1 = src->h;
+    if (src->roi_w > 0 && src->roi_h > 0 && src->_roi) {
+      x0 = src->roi_x;
+      y0 = src->roi_y;
+      x1 = (x0 + src->roi_w < src->w) ? x0 + src->roi_w : src->w;
+      y1 = (y0 + src->roi_h < src->h) ? y0 + src->roi_h : src->h;
+    }
+    for (int y = y0; y < y1; y++) {
+      memcpy(out + ((size_t)y * dst->stride + x0) * bpp, in + ((size_t)y * src->w + x0) * bpp, (size_t)(x1 - x0) * bpp);
+    }
+    dst->V = src->V;
+    dst->P = src->P;
+    if (dst->_keep) _sf_od_keep(dst, true);
+  }
+
+  sf_event_t ev;
+  ev.type = SF_EVT_RENDER_END;
+  sf_event_trigger(ctx, &ev);
+}
+
+bool _sf_snap_take(sf_ctx_t *ctx) {
+  /* Copy transforms, lights, billboards, live particles, sky, fog and render mode into ctx->_snap and give every
+   * camera a private copy that draws into its back buffer. Particles go in the frame allocator, which outlives the
+   * render in flight. Returns false (render serially instead) if memory runs out. */
+  sf_snap_t *rs = &ctx->_snap;
+  if (!rs->cams) {
+    rs->sprite_3ds = sf_arena_alloc(ctx, &ctx->arena, ctx->sprite_3d_cap * sizeof(sf_sprite_3_t));
+    rs->cams       = sf_arena_alloc(ctx, &ctx->arena, (SF_MAX_CAMS + 1) * sizeof(sf_cam_t));
+    if (!rs->sprite_3ds || !rs->cams) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate frame snapshot, rendering serially\n");
+      rs->cams = NULL;
+      return false;
+    }
+  }
+  int32_t    n_M = ctx->frame_pool.chunk_count * SF_POOL_CHUNK;
+  sf_fmat43_t *M = (sf_fmat43_t*)_sf_grow(rs->M,       &rs->frames_cap, n_M,              sizeof(sf_fmat43_t));
+  if (M) rs->M = M;
+  sf_enti_t  *E  = (sf_enti_t*) _sf_grow(rs->entities, &rs->enti_cap,   ctx->enti_count,  sizeof(sf_enti_t));
+  if (E) rs->entities = E;
+  sf_light_t *L  = (sf_light_t*)_sf_grow(rs->lights,   &rs->light_cap,  ctx->light_count, sizeof(sf_light_t));
+  if (L) rs->lights = L;
+  if (!M || !E || !L) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate frame snapshot, rendering serially\n");
+    return false;
   }
 
-  sf_render_emitrs(ctx, cam);
-  if (ctx->render_mode == SF_RENDER_DEPTH) {
-    sf_render_depth(ctx, cam);
-  } else if (ctx->render_mode == SF_RENDER_NORMAL && ctx->fog_enabled) {
-    sf_render_fog(ctx, cam);
+  int n_pcl = 0;
+  for (int i = 0; i < ctx->emitr_count; i++) {
+    for (int p = 0; p < ctx->emitrs[i]->max_particles; p++) n_pcl += ctx->emitrs[i]->particles[p].active;
+  }
+  rs->pcls = n_pcl ? (sf_snap_pcl_t*)sf_tmp_alloc(ctx, (size_t)n_pcl * sizeof(sf_snap_pcl_t)) : NULL;
+  if (n_pcl && !rs->pcls) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to snapshot %d particles, rendering serially\n", n_pcl);
+    return false;
   }
 
-  sf_event_t ev_end;
-  ev_end.type = SF_EVT_RENDER_END;
-  sf_event_trigger(ctx, &ev_end);
+  for (int k = 0; k <= ctx->cam_count; k++) {
+    sf_cam_t *cam  = (k == 0) ? &ctx->main_camera : &ctx->cameras[k - 1];
+    size_t    bpp  = (cam->pix_fmt == SF_PIXFMT_IDX8) ? 1 : (cam->pix_fmt == SF_PIXFMT_RGB565) ? 2 : 4;
+    size_t    need = (size_t)cam->w * (size_t)cam->h * bpp;
+    if (cam->_back_size != need) {
+      free(cam->_back_px);
+      cam->_back_px   = malloc(need);
+      cam->_back_size = cam->_back_px ? need : 0;
+      if (!cam->_back_px) {
+        SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate back buffer for '%s', rendering serially\n", cam->name ? cam->name : "main");
+        return false;
+      }
+    }
+  }
+
+  rs->frames_count = n_M;
+  for (int i = 0; i < ctx->frames_count; i++) {
+    rs->M[((sf_pool_hdr_t*)ctx->frames[i] - 1)->slot] = ctx->frames[i]->global_M;
+  }
+  rs->enti_count      = ctx->enti_count;
+  rs->light_count     = ctx->light_count;
+  rs->sprite_3d_count = ctx->sprite_3d_count;
+  for (int i = 0; i < ctx->enti_count;  i++) rs->entities[i] = *ctx->entities[i];
+  for (int i = 0; i < ctx->light_count; i++) rs->lights[i]   = *ctx->lights[i];
+  memcpy(rs->sprite_3ds, ctx->sprite_3ds, (size_t)ctx->sprite_3d_count * sizeof(sf_sprite_3_t));
+
+  rs->pcl_count = 0;
+  for (int i = 0; i < ctx->emitr_count; i++) {
+    sf_emitr_t *em = ctx->emitrs[i];
+    for (int p = 0; p < em->max_particles; p++) {
+      sf_particle_t *pt = &em->particles[p];
+      if (!pt->active) continue;
+      rs->pcls[rs->pcl_count++] = (sf_snap_pcl_t){ em->sprite, pt->pos, pt->anim_time, pt->life / pt->max_life, em->layers };
+    }
+  }
+
+  rs->look      = _sf_render_look(ctx, NULL);
+  rs->cam_count = ctx->cam_count + 1;
+  for (int k = 0; k < rs->cam_count; k++) {
+    sf_cam_t *cam = &rs->cams[k];
+    *cam          = (k == 0) ? ctx->main_camera : ctx->cameras[k - 1];
+    cam->stride   = cam->w;
+    cam->ext_px   = false;
+    cam->_own_px  = NULL;
+    cam->buffer   = (cam->pix_fmt == SF_PIXFMT_ARGB8888) ? (sf_pkd_clr_t*)cam->_back_px : NULL;
+    cam->buffer16 = (cam->pix_fmt == SF_PIXFMT_RGB565)   ? (uint16_t*)cam->_back_px     : NULL;
+    cam->buffer8  = (cam->pix_fmt == SF_PIXFMT_IDX8)     ? (uint8_t*)cam->_back_px      : NULL;
+    cam->_rs      = rs;
+  }
+  return true;
+}
+
+sf_fmat43_t _sf_render_M(sf_ctx_t *ctx, sf_cam_t *cam, sf_frame_t *f) {
+  /* World matrix of f as seen by cam: the snapshot copy when cam is drawing a pipelined frame, else global_M.
+   * Workers read only f's own pool header, never the live pool, which the main thread may grow meanwhile. */
+  (void)ctx;
+  const sf_snap_t *rs = cam->_rs;
+  if (!rs) return f->global_M;
+  uint32_t slot = ((const sf_pool_hdr_t*)f - 1)->slot;
+  return (slot < (uint32_t)rs->frames_count) ? rs->M[slot] : f->global_M;
+}
+
+sf_look_t _sf_render_look(sf_ctx_t *ctx, const sf_cam_t *cam) {
+  /* Sky, fog and render mode as seen by cam: the snapshot copy when cam is drawing a pipelined frame, else ctx's.
+   * sky is the active skybox's texture, or NULL when there is none or it is disabled. */
+  if (cam && cam->_rs) return cam->_rs->look;
+  sf_look_t look;
+  look.sky         = (ctx->active_skybox && ctx->skybox_enabled) ? ctx->active_skybox->tex : NULL;
+  look.sky_last    = ctx->sky_last;
+  look.fog_enabled = ctx->fog_enabled;
+  look.fog_color   = ctx->fog_color;
+  look.fog_start   = ctx->fog_start;
+  look.fog_end     = ctx->fog_end;
+  look.render_mode = ctx->render_mode;
+  return look;
+}
+
+void sf_dyn_res_update(sf_ctx_t *ctx) {
+  /* Steer every camera's res_scale toward ctx->dyn_res_budget (seconds per frame) using the mean of the last
+   * SF_DYN_RES_WINDOW frame times, by at most SF_DYN_RES_STEP per call within [dyn_res_min, dyn_res_max].
+   * Scaled and temporal cameras get their proxy and history buffers here, before any worker draws them. */
+  float sum = 0.0f;
+  int   cnt = 0;
+  for (int i = 1; i <= SF_DYN_RES_WINDOW && ctx->dyn_res_budget > 0.0f; i++) {
+    float dt = ctx->_perf_dt_hist[(ctx->_perf_dt_idx - i + SF_PERF_HIST_SIZE) % SF_PERF_HIST_SIZE];
+    if (dt > 0.0f) { sum += dt; cnt++; }
+  }
+  float ratio = (cnt > 0) ? ctx->dyn_res_budget * (float)cnt / sum : 1.0f;
+  float lo    = (ctx->dyn_res_min > 0.05f) ? ctx->dyn_res_min : 0.05f;
+  float hi    = (ctx->dyn_res_max < 1.0f)  ? ctx->dyn_res_max : 1.0f;
+  if (lo > hi) lo = hi;
+  for (int i = 0; i <= ctx->cam_count; i++) {
+    sf_cam_t *cam = (i == 0) ? &ctx->main_camera : &ctx->cameras[i - 1];
+    if (cnt > 0 && (ratio < 0.9f || ratio > 1.1f)) {
+      float cur  = (cam->res_scale > 0.0f) ? cam->res_scale : 1.0f;
+      float want = cur * sqrtf(ratio);
+      if (want > cur + SF_DYN_RES_STEP) want = cur + SF_DYN_RES_STEP;
+      if (want < cur - SF_DYN_RES_STEP) want = cur - SF_DYN_RES_STEP;
+      cam->res_scale = (want < lo) ? lo : (want > hi) ? hi : want;
+    }
+    if ((cam->res_scale > 0.0f && cam->res_scale < 1.0f) || cam->temporal) _sf_dyn_res_alloc(ctx, cam);
+  }
+}
+
+bool _sf_dyn_res_alloc(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Give cam a proxy camera with full-size ARGB and float depth buffers, of which a scaled sub-rectangle is used,
+   * plus two full-size history buffers when cam->temporal is set. */
+  size_t n = (size_t)cam->w * (size_t)cam->h;
+  if (cam->temporal && !cam->_taa) {
+    sf_taa_t *taa = (sf_taa_t*)calloc(1, sizeof(sf_taa_t));
+    if (taa) {
+      taa->hist[0] = (sf_pkd_clr_t*)malloc(n * sizeof(sf_pkd_clr_t));
+      taa->hist[1] = (sf_pkd_clr_t*)malloc(n * sizeof(sf_pkd_clr_t));
+    }
+    if (!taa || !taa->hist[0] || !taa->hist[1]) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate history for '%s', upscaling without it\n", cam->name ? cam->name : "main");
+      if (taa) free(taa->hist[0]);
+      if (taa) free(taa->hist[1]);
+      free(taa);
+    } else {
+      cam->_taa = taa;
+    }
+  }
+  if (cam->_lo) return true;
+  sf_cam_t *lo = (sf_cam_t*)calloc(1, sizeof(sf_cam_t));
+  if (lo) {
+    lo->buffer   = (sf_pkd_clr_t*)malloc(n * sizeof(sf_pkd_clr_t));
+    lo->z_buffer = (float*)       malloc(n * sizeof(float));
+  }
+  if (!lo || !lo->buffer || !lo->z_buffer) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate scaled buffers for '%s', rendering at full size\n", cam->name ? cam->name : "main");
+    if (lo) free(lo->buffer);
+    if (lo) free(lo->z_buffer);
+    free(lo);
+    return false;
+  }
+  cam->_lo = lo;
+  return true;
+}
+
+sf_cam_t* _sf_dyn_res_view(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Return what the render pass should draw for cam: cam itself at full scale, otherwise its proxy sized to
+   * res_scale and sharing cam's settings and projection. Temporal cameras always draw through a sub-pixel
+   * jittered proxy, full-size when res_scale is 1, so the resolve anti-aliases even without dynamic resolution. */
+  float s = cam->res_scale;
+  if (s <= 0.0f || s >= 1.0f) {
+    if (!cam->temporal) return cam;
+    s = 1.0f;
+  }
+  if (!cam->_rs) _sf_dyn_res_alloc(ctx, cam);
+  if (!cam->_lo || (s == 1.0f && !cam->_taa)) return cam;
+  if (cam->is_proj_dirty) {
+    float aspect = (float)cam->w / (float)cam->h;
+    cam->P = sf_make_psp_fmat4(cam->fov, aspect, cam->near_plane, cam->far_plane);
+    cam->is_proj_dirty = false;
+  }
+  sf_cam_t     *lo = cam->_lo;
+  sf_pkd_clr_t *px = lo->buffer;
+  float        *zb = lo->z_buffer;
+  *lo             = *cam;
+  lo->w           = (int)((float)cam->w * s + 0.5f);
+  lo->h           = (int)((float)cam->h * s + 0.5f);
+  if (lo->w < 1) lo->w = 1;
+  if (lo->h < 1) lo->h = 1;
+  lo->buffer_size = lo->w * lo->h;
+  lo->stride      = lo->w;
+  lo->ext_px      = false;
+  lo->_own_px     = NULL;
+  lo->buffer      = px;
+  lo->buffer16    = NULL;
+  lo->buffer8     = NULL;
+  lo->pix_fmt     = SF_PIXFMT_ARGB8888;
+  lo->z_buffer    = zb;
+  lo->z_buffer16  = NULL;
+  lo->depth_fmt   = (cam->depth_fmt == SF_DEPTH_U16) ? SF_DEPTH_F32 : cam->depth_fmt;
+  lo->_back_px    = NULL;
+  lo->_back_size  = 0;
+  lo->_lo         = NULL;
+  lo->_taa        = NULL;
+  sf_taa_t *taa   = cam->temporal ? cam->_taa : NULL;
+  if (taa) {
+    int   i  = (int)(taa->frame % SF_TAA_JITTER) + 1;
+    float hx = 0.0f, hy = 0.0f, f = 0.5f;
+    for (int k = i; k > 0; k /= 2, f *= 0.5f) hx += f * (float)(k % 2);
+    f = 1.0f / 3.0f;
+    for (int k = i; k > 0; k /= 3, f /= 3.0f) hy += f * (float)(k % 3);
+    taa->jx = hx - 0.5f;
+    taa->jy = hy - 0.5f;
+    lo->P.m[2][0] -= 2.0f * taa->jx / (float)lo->w * cam->P.m[2][3];
+    lo->P.m[2][1] += 2.0f * taa->jy / (float)lo->h * cam->P.m[2][3];
+  }
+  return lo;
+}
+
+void _sf_dyn_res_blit(sf_ctx_t *ctx, const sf_cam_t *lo, sf_cam_t *cam) {
+  /* Upscale a finished proxy image into cam's own pixels (nearest, or bilinear with ctx->dyn_res_bilinear), or with
+   * cam->temporal blend it with the reprojected previous output. cam's depth buffer is left untouched. */
+  cam->V = lo->V;
+  sf_upscale_t up = { .src = lo, .dst = cam, .bilinear = ctx->dyn_res_bilinear, .taa = cam->temporal ? cam->_taa : NULL };
+  if (!up.taa) {
+    sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_dyn_res_rows, &up);
+    return;
+  }
+  float near = cam->near_plane, far = cam->far_plane;
+  up.A   = (lo->depth_fmt == SF_DEPTH_F32_REV) ? -near : 2.0f * near * far;
+  up.B   = (lo->depth_fmt == SF_DEPTH_F32_REV) ? 0.0f  : far + near;
+  up.C   = (lo->depth_fmt == SF_DEPTH_F32_REV) ? -1.0f : far - near;
+  up.far = far;
+  up.R   = sf_fmat4_mul_fmat4(sf_fmat43_to_fmat4(sf_fmat43_mul_fmat43(_sf_rigid_inv(cam->V), up.taa->V)), up.taa->P);
+  sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_taa_rows, &up);
+  up.taa->V      = cam->V;
+  up.taa->P      = cam->P;
+  up.taa->valid  = true;
+  up.taa->cur   ^= 1;
+  up.taa->frame++;
+}
+
+void _sf_dyn_res_rows(sf_ctx_t *ctx, void *user, int y0, int y1, int worker) {
+  /* Upscale job body: rows [y0, y1) of the destination camera, sampled at pixel centres in 16.16 fixed point. */
+  (void)ctx; (void)worker;
+  const sf_upscale_t *up  = (const sf_upscale_t*)user;
+  const sf_cam_t     *src = up->src;
+  sf_cam_t           *dst = up->dst;
+  int32_t             sx  = (int32_t)(((int64_t)src->w << 16) / dst->w);
+  int32_t             sy  = (int32_t)(((int64_t)src->h << 16) / dst->h);
+  int32_t             bx  = up->bilinear ? (sx - 65536) / 2 : sx / 2;
+  int32_t             mx  = (src->w - 1) << 16;
+  int32_t             my  = (src->h - 1) << 16;
+  for (int y = y0; y < y1; y++) {
+    int32_t fy = (up->bilinear ? (sy - 65536) / 2 : sy / 2) + y * sy;
+    if (fy < 0)  fy = 0;
+    if (fy > my) fy = my;
+    const sf_pkd_clr_t *r0  = &src->buffer[(fy >> 16) * src->stride];
+    const sf_pkd_clr_t *r1  = ((fy >> 16) < src->h - 1) ? r0 + src->stride : r0;
+    uint32_t            wy  = (uint32_t)(fy >> 8) & 0xFF;
+    sf_pkd_clr_t       *out = dst->buffer ? &dst->buffer[y * dst->stride] : NULL;
+    int32_t             fx  = bx;
+    for (int x = 0; x < dst->w; x++, fx += sx) {
+      int32_t      cx = (fx < 0) ? 0 : (fx > mx) ? mx : fx;
+      int          ix = cx >> 16;
+      sf_pkd_clr_t c;
+      if (up->bilinear) {
+        int      ix1 = (ix < src->w - 1) ? ix + 1 : ix;
+        uint32_t wx  = (uint32_t)(cx >> 8) & 0xFF;
+        c = _sf_lerp_px(_sf_lerp_px(r0[ix], r0[ix1], wx), _sf_lerp_px(r1[ix], r1[ix1], wx), wy);
+      } else {
+        c = r0[ix];
+      }
+      if (out) out[x] = c;
+      else     _sf_put_px(dst, y * dst->stride + x, c);
+    }
+  }
+}
+
+void _sf_taa_rows(sf_ctx_t *ctx, void *user, int y0, int y1, int worker) {
+  /* Temporal resolve job body for rows [y0, y1): de-jittered current sample blended with depth-reprojected history
+   * clamped to the 3x3 neighbourhood; weight is SF_TAA_BLEND/256 plus SF_TAA_MOTION/256 per pixel of motion. */
+  (void)ctx; (void)worker;
+  const sf_upscale_t *up   = (const sf_upscale_t*)user;
+  const sf_cam_t     *src  = up->src;
+  sf_cam_t           *dst  = up->dst;
+  sf_taa_t           *taa  = up->taa;
+  const sf_pkd_clr_t *prev = taa->valid ? taa->hist[taa->cur ^ 1] : NULL;
+  sf_pkd_clr_t       *next = taa->hist[taa->cur];
+  const sf_fmat4_t   *R    = &up->R;
+  int                 lw   = src->w, lh = src->h, W = dst->w, H = dst->h;
+  float               kx   = (float)lw / (float)W, ky = (float)lh / (float)H;
+  float               ix0  = 0.5f * kx - 0.5f - taa->jx;
+  float               iy0  = 0.5f * ky - 0.5f - taa->jy;
+  float               p00  = 1.0f / dst->P.m[0][0], p11 = 1.0f / dst->P.m[1][1];
+  for (int y = y0; y < y1; y++) {
+    float fy = iy0 + (float)y * ky;
+    fy = (fy < 0.0f) ? 0.0f : (fy > (float)(lh - 1)) ? (float)(lh - 1) : fy;
+    int                 ya    = (int)fy;
+    int                 yb    = (ya < lh - 1) ? ya + 1 : ya;
+    uint32_t            wy    = (uint32_t)((fy - (float)ya) * 256.0f);
+    int                 ny    = (int)(fy + 0.5f);
+    const sf_pkd_clr_t *ra    = &src->buffer[ya * lw];
+    const sf_pkd_clr_t *rb    = &src->buffer[yb * lw];
+    float               ndc_y = 1.0f - 2.0f * ((float)y + 0.5f) / (float)H;
+    sf_pkd_clr_t       *out   = dst->buffer ? &dst->buffer[y * dst->stride] : NULL;
+    for (int x = 0; x < W; x++) {
+      float fx = ix0 + (float)x * kx;
+      fx = (fx < 0.0f) ? 0.0f : (fx > (float)(lw - 1)) ? (float)(lw - 1) : fx;
+      int          xa = (int)fx;
+      int          xb = (xa < lw - 1) ? xa + 1 : xa;
+      uint32_t     wx = (uint32_t)((fx - (float)xa) * 256.0f);
+      int          nx = (int)(fx + 0.5f);
+      sf_pkd_clr_t c  = _sf_lerp_px(_sf_lerp_px(ra[xa], ra[xb], wx), _sf_lerp_px(rb[xa], rb[xb], wx), wy);
+      if (prev) {
+        float z  = src->z_buffer[ny * lw + nx];
+        float d  = (z > 2.0f) ? up->far : up->A / (up->B - z * up->C);
+        float vx = (2.0f * ((float)x + 0.5f) / (float)W - 1.0f) * d * p00;
+        float vy = ndc_y * d * p11;
+        float cx = vx * R->m[0][0] + vy * R->m[1][0] - d * R->m[2][0] + R->m[3][0];
+        float cy = vx * R->m[0][1] + vy * R->m[1][1] - d * R->m[2][1] + R->m[3][1];
+        float cw = vx * R->m[0][3] + vy * R->m[1][3] - d * R->m[2][3] + R->m[3][3];
+        float sx = (cw > 1e-6f) ? ( cx / cw + 1.0f) * 0.5f * (float)W - 0.5f : -2.0f;
+        float sy = (cw > 1e-6f) ? (1.0f - cy / cw) * 0.5f * (float)H - 0.5f : -2.0f;
+        if (sx > -1.0f && sy > -1.0f && sx < (float)W && sy < (float)H) {
+          sx = (sx < 0.0f) ? 0.0f : (sx > (float)(W - 1)) ? (float)(W - 1) : sx;
+          sy = (sy < 0.0f) ? 0.0f : (sy > (float)(H - 1)) ? (float)(H - 1) : sy;
+          int                 hx = (int)sx, hy = (int)sy;
+          int                 hx1 = (hx < W - 1) ? hx + 1 : hx;
+          const sf_pkd_clr_t *h0 = &prev[hy * W];
+          const sf_pkd_clr_t *h1 = (hy < H - 1) ? h0 + W : h0;
+          uint32_t            hw = (uint32_t)((sx - (float)hx) * 256.0f);
+          sf_pkd_clr_t        hc = _sf_lerp_px(_sf_lerp_px(h0[hx], h0[hx1], hw), _sf_lerp_px(h1[hx], h1[hx1], hw),
+                                               (uint32_t)((sy - (float)hy) * 256.0f));
+          uint32_t mn = 0xFFFFFFFFu, mx = 0;
+          for (int j = -1; j <= 1; j++) {
+            int yy = ny + j;
+            if (yy < 0 || yy >= lh) continue;
+            for (int i = -1; i <= 1; i++) {
+              int xx = nx + i;
+              if (xx < 0 || xx >= lw) continue;
+              sf_pkd_clr_t n = src->buffer[yy * lw + xx];
+              for (int sh = 0; sh < 24; sh += 8) {
+                uint32_t v = (n >> sh) & 0xFF;
+                if (v < ((mn >> sh) & 0xFF)) mn = (mn & ~(0xFFu << sh)) | (v << sh);
+                if (v > ((mx >> sh) & 0xFF)) mx = (mx & ~(0xFFu << sh)) | (v << sh);
+              }
+            }
+          }
+          for (int sh = 0; sh < 24; sh += 8) {
+            uint32_t v = (hc >> sh) & 0xFF, lo = (mn >> sh) & 0xFF, hi = (mx >> sh) & 0xFF;
+            v  = (v < lo) ? lo : (v > hi) ? hi : v;
+            hc = (hc & ~(0xFFu << sh)) | (v << sh);
+          }
+          float mvx = sx - (float)x, mvy = sy - (float)y;
+          float a   = (float)SF_TAA_BLEND + sqrtf(mvx * mvx + mvy * mvy) * (float)SF_TAA_MOTION;
+          c = _sf_lerp_px(hc, c, (a < 256.0f) ? (uint32_t)a : 256);
+        }
+      }
+      next[y * W + x] = c;
+      if (out) out[x] = c;
+      else     _sf_put_px(dst, y * dst->stride + x, c);
+    }
+  }
+}
+
+void _sf_dyn_res_free(sf_cam_t *cam) {
+  /* Release cam's low-resolution proxy camera and temporal history, if it has them. */
+  if (cam->_taa) {
+    free(cam->_taa->hist[0]);
+    free(cam->_taa->hist[1]);
+    free(cam->_taa);
+    cam->_taa = NULL;
+  }
+  if (!cam->_lo) return;
+  free(cam->_lo->buffer);
+  free(cam->_lo->z_buffer);
+  free(cam->_lo);
+  cam->_lo = NULL;
+}
+
+sf_cam_t* _sf_roi_view(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Return cam's ROI proxy: a camera the size of the rectangle whose pixels alias cam's rows there and whose
+   * projection is cam's cropped off-axis, so clearing, culling, spans and post all stay inside it. */
+  (void)ctx;
+  if (cam->roi_w <= 0 || cam->roi_h <= 0 || !cam->_roi) return cam;
+  int x0 = cam->roi_x, y0 = cam->roi_y;
+  int x1 = (x0 + cam->roi_w < cam->w) ? x0 + cam->roi_w : cam->w;
+  int y1 = (y0 + cam->roi_h < cam->h) ? y0 + cam->roi_h : cam->h;
+  if (x1 <= x0 || y1 <= y0) return cam;
+  if (cam->is_proj_dirty) {
+    float aspect = (float)cam->w / (float)cam->h;
+    cam->P = sf_make_psp_fmat4(cam->fov, aspect, cam->near_plane, cam->far_plane);
+    cam->is_proj_dirty = false;
+  }
+  sf_cam_t *roi = cam->_roi;
+  float    *zb  = roi->z_buffer;
+  size_t    off = (size_t)y0 * cam->stride + x0;
+  *roi             = *cam;
+  roi->w           = x1 - x0;
+  roi->h           = y1 - y0;
+  roi->buffer_size = roi->w * roi->h;
+  roi->ext_px      = false;
+  roi->_own_px     = NULL;
+  roi->buffer      = cam->buffer   ? cam->buffer   + off : NULL;
+  roi->buffer16    = cam->buffer16 ? cam->buffer16 + off : NULL;
+  roi->buffer8     = cam->buffer8  ? cam->buffer8  + off : NULL;
+  roi->z_buffer    = zb;
+  roi->z_buffer16  = NULL;
+  roi->depth_fmt   = (cam->depth_fmt == SF_DEPTH_U16) ? SF_DEPTH_F32_REV : cam->depth_fmt;
+  roi->roi_x       = x0;
+  roi->roi_y       = y0;
+  roi->roi_w       = 0;
+  roi->roi_h       = 0;
+  roi->res_scale   = 1.0f;
+  roi->temporal    = false;
+  roi->_back_px    = NULL;
+  roi->_back_size  = 0;
+  roi->_lo         = NULL;
+  roi->_taa        = NULL;
+  roi->_roi        = NULL;
+  roi->_od_px      = NULL;
+  float sx = (float)cam->w / (float)roi->w, ox = (float)(cam->w - 2 * x0) / (float)roi->w - 1.0f;
+  float sy = (float)cam->h / (float)roi->h, oy = 1.0f - (float)(cam->h - 2 * y0) / (float)roi->h;
+  for (int i = 0; i < 4; i++) {
+    roi->P.m[i][0] = sx * cam->P.m[i][0] + ox * cam->P.m[i][3];
+    roi->P.m[i][1] = sy * cam->P.m[i][1] + oy * cam->P.m[i][3];
+  }
+  return roi;
+}
+
+void _sf_roi_done(const sf_cam_t *roi, sf_cam_t *cam) {
+  /* Hand a finished ROI pass back to cam: its view matrix, and the rectangle's depth in cam's own depth format. */
+  cam->V = roi->V;
+  float zk = cam->z_buffer16 ? _sf_depth_q16_k(cam) : 0.0f;
+  for (int y = 0; y < roi->h; y++) {
+    const float *src = &roi->z_buffer[y * roi->w];
+    size_t       di  = (size_t)(roi->roi_y + y) * cam->w + roi->roi_x;
+    if (cam->z_buffer16) {
+      for (int x = 0; x < roi->w; x++) cam->z_buffer16[di + x] = (src[x] > 2.0f) ? 0xFFFF : _sf_depth_to_q16(src[x], zk);
+    } else if (cam->z_buffer) {
+      memcpy(&cam->z_buffer[di], src, (size_t)roi->w * sizeof(float));
+    }
+  }
+}
+
+void _sf_roi_free(sf_cam_t *cam) {
+  /* Release cam's ROI proxy and its depth buffer, if it has one. */
+  if (!cam->_roi) return;
+  free(cam->_roi->z_buffer);
+  free(cam->_roi);
+  cam->_roi = NULL;
 }
 
 void sf_render_emitrs(sf_ctx_t *ctx, sf_cam_t *cam) {
-  /* Draw all active particles from every emitter as sprites into cam. */
+  /* Draw all active particles from every emitter on one of cam's layers as sprites into cam. */
+  if (cam->_rs) {
+    for (int i = 0; i < cam->_rs->pcl_count; i++) {
+      const sf_snap_pcl_t *pc = &cam->_rs->pcls[i];
+      if (!(pc->layers & cam->cull_mask)) continue;
+      sf_draw_sprite(ctx, cam, pc->sprite, pc->pos, pc->anim_time, pc->scale);
+    }
+    return;
+  }
   for (int i = 0; i < ctx->emitr_count; i++) {
-    sf_emitr_t *em = &ctx->emitrs[i];
+    sf_emitr_t *em = ctx->emitrs[i];
+    if (!(em->layers & cam->cull_mask)) continue;
     for (int p = 0; p < em->max_particles; p++) {
       if (em->particles[p].active) {
         float scale_mult = em->particles[p].life / em->particles[p].max_life;
@@ -1237,145 +2619,332 @@ void sf_render_emitrs(sf_ctx_t *ctx, sf_cam_t *cam) {
 void sf_render_skybox(sf_ctx_t *ctx, sf_cam_t *cam) {
   /* Fill the camera buffer with an equirectangular sky panorama using span interpolation.
    * Exact UVs are computed every SF_SKYBOX_SPAN pixels and linearly interpolated between. */
-  if (!ctx->active_skybox || !ctx->active_skybox->tex) {
+  if (!_sf_render_look(ctx, cam).sky) {
     sf_fill(ctx, cam, SF_CLR_BLACK);
     return;
   }
-  sf_tex_t *tex = ctx->active_skybox->tex;
-  float rx = cam->V.m[0][0], ry = cam->V.m[1][0], rz = cam->V.m[2][0];
-  float ux = cam->V.m[0][1], uy = cam->V.m[1][1], uz = cam->V.m[2][1];
-  float fx = -cam->V.m[0][2], fy = -cam->V.m[1][2], fz = -cam->V.m[2][2];
-  float inv_px  = 1.0f / cam->P.m[0][0];
-  float inv_py  = 1.0f / cam->P.m[1][1];
-  float inv_w   = 1.0f / (float)cam->w;
-  float inv_h   = 1.0f / (float)cam->h;
-  float inv_2pi = 1.0f / (2.0f * SF_PI);
-  float inv_pi  = 1.0f / SF_PI;
-  float fw      = (float)tex->w;
-  float fh      = (float)tex->h;
-  float step_x  = rx * 2.0f * inv_px * inv_w;
-  float step_y  = ry * 2.0f * inv_px * inv_w;
-  float step_z  = rz * 2.0f * inv_px * inv_w;
-
-  for (int py = 0; py < cam->h; py++) {
-    float ndc_y = 1.0f - (2.0f * ((float)py + 0.5f)) * inv_h;
-    float vd_y  = ndc_y * inv_py;
-    float vd_x0 = (inv_w - 1.0f) * inv_px;
-    float wd_x  = vd_x0 * rx + vd_y * ux + fx;
-    float wd_y_ = vd_x0 * ry + vd_y * uy + fy;
-    float wd_z  = vd_x0 * rz + vd_y * uz + fz;
-    sf_pkd_clr_t *row = &cam->buffer[py * cam->w];
+  sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_skybox_rows, cam);
+}
+
+void _sf_skybox_rows(sf_ctx_t *ctx, void *user, int y0, int y1, int worker) {
+  /* Skybox job body: panorama rows [y0, y1) of the camera passed as user. */
+  (void)worker;
+  sf_cam_t *cam = (sf_cam_t*)user;
+  sf_tex_t *tex = _sf_render_look(ctx, cam).sky;
+  sf_sky_t  s   = _sf_sky_setup(cam, tex);
+  sf_pkd_clr_t tmp[2 * SF_PX_CHUNK];
+  for (int py = y0; py < y1; py++) {
+    int ri = py * cam->stride;
+    _sf_sky_row(&s, cam, py);
     for (int px = 0; px < cam->w; px += SF_SKYBOX_SPAN) {
       int span_len = cam->w - px;
       if (span_len > SF_SKYBOX_SPAN) span_len = SF_SKYBOX_SPAN;
-      float xz0 = sqrtf(wd_x * wd_x + wd_z * wd_z);
-      float u0  = atan2f(wd_x, wd_z) * inv_2pi + 0.5f;
-      float v0  = atan2f(wd_y_, xz0)  * inv_pi  + 0.5f;
-      float ex  = wd_x  + step_x * (float)span_len;
-      float ey  = wd_y_ + step_y * (float)span_len;
-      float ez  = wd_z  + step_z * (float)span_len;
-      float xz1 = sqrtf(ex * ex + ez * ez);
-      float u1  = atan2f(ex, ez) * inv_2pi + 0.5f;
-      float v1  = atan2f(ey, xz1) * inv_pi  + 0.5f;
-      if (u1 - u0 >  0.5f) u1 -= 1.0f;
-      if (u0 - u1 >  0.5f) u1 += 1.0f;
-      float inv_span = 1.0f / (float)span_len;
-      float du = (u1 - u0) * inv_span;
-      float dv = (v1 - v0) * inv_span;
-      float u  = u0, v = v0;
+      _sf_sky_span(&s, span_len, true);
+      sf_pkd_clr_t *dst = _sf_px_span(cam, tmp, ri + px, span_len);
+      float u = s.u0, v = s.v0;
       for (int i = 0; i < span_len; i++) {
-        int tx = (int)(u * fw) & tex->w_mask;
-        int ty = (int)((1.0f - v) * fh) & tex->h_mask;
-        row[px + i] = tex->px[ty * tex->w + tx];
-        u += du; v += dv;
+        int tx = (int)(u * s.fw) & tex->w_mask;
+        int ty = (int)((1.0f - v) * s.fh) & tex->h_mask;
+        dst[i] = tex->px[ty * tex->w + tx];
+        u += s.du; v += s.dv;
       }
-      wd_x = ex; wd_y_ = ey; wd_z = ez;
+      _sf_px_flush(cam, tmp, ri + px, span_len);
     }
   }
 }
 
-void sf_render_fog(sf_ctx_t *ctx, sf_cam_t *cam) {
-  /* Post-process depth fog: blend each geometry pixel toward fog_color based on
-   * linearised view-space depth.  Sky/unwritten pixels (z > 2.0) are skipped. */
-  if (!ctx->fog_enabled) return;
-  float near     = cam->near_plane;
-  float far      = cam->far_plane;
-  float A        = 2.0f * near * far;
-  float B        = far + near;
-  float C        = far - near;
-  float inv_rng  = 1.0f / (ctx->fog_end - ctx->fog_start);
-  uint32_t fr    = (uint32_t)(ctx->fog_color.x * 255.0f + 0.5f);
-  uint32_t fg_   = (uint32_t)(ctx->fog_color.y * 255.0f + 0.5f);
-  uint32_t fb    = (uint32_t)(ctx->fog_color.z * 255.0f + 0.5f);
-  int n = cam->w * cam->h;
-  for (int i = 0; i < n; i++) {
-    float z = cam->z_buffer[i];
-    float t;
-    if (z > 2.0f) {
-      t = 1.0f;
-    } else {
-      float depth = A / (B - z * C);
-      t = (depth - ctx->fog_start) * inv_rng;
-      if (t <= 0.0f) continue;
-      if (t >  1.0f) t = 1.0f;
+void sf_render_sky_fill(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Paint the background (sky panorama or black) only where the z-buffer still holds the clear value.
+   * Run after opaque geometry; SF_SKYBOX_SPAN blocks with no clear pixel advance the ray but compute no UVs. */
+  sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_sky_fill_rows, cam);
+}
+
+void _sf_sky_fill_rows(sf_ctx_t *ctx, void *user, int y0, int y1, int worker) {
+  /* Sky-fill job body: background for rows [y0, y1) of the camera passed as user. */
+  (void)worker;
+  sf_cam_t *cam = (sf_cam_t*)user;
+  sf_pkd_clr_t *buf  = cam->buffer;
+  int           w    = cam->w;
+  sf_tex_t     *tex  = (cam->features & SF_CAM_SKYBOX) ? _sf_render_look(ctx, cam).sky : NULL;
+  if (!tex) {
+    for (int py = y0; py < y1; py++) {
+      sf_pkd_clr_t *row = buf ? &buf[py * cam->stride] : NULL;
+      int           zi  = py * w;
+      int           ci  = py * cam->stride;
+      int px = 0;
+      while (px < w) {
+        while (px < w && !_sf_depth_is_clear(cam, zi + px)) px++;
+        int run = px;
+        while (px < w &&  _sf_depth_is_clear(cam, zi + px)) px++;
+        if (row) for (int i = run; i < px; i++) row[i] = SF_CLR_BLACK;
+        else     for (int i = run; i < px; i++) _sf_put_px(cam, ci + i, SF_CLR_BLACK);
+      }
+    }
+    return;
+  }
+  sf_sky_t  s   = _sf_sky_setup(cam, tex);
+  sf_pkd_clr_t tmp[2 * SF_PX_CHUNK];
+  for (int py = y0; py < y1; py++) {
+    int zi = py * w;
+    int ci = py * cam->stride;
+    _sf_sky_row(&s, cam, py);
+    for (int px = 0; px < w; px += SF_SKYBOX_SPAN) {
+      int span_len = w - px;
+      if (span_len > SF_SKYBOX_SPAN) span_len = SF_SKYBOX_SPAN;
+      int first = 0;
+      while (first < span_len && !_sf_depth_is_clear(cam, zi + px + first)) first++;
+      _sf_sky_span(&s, span_len, first < span_len);
+      if (first == span_len) continue;
+      sf_pkd_clr_t *dst = _sf_px_span(cam, tmp, ci + px, span_len);
+      for (int i = first; i < span_len; i++) {
+        if (!_sf_depth_is_clear(cam, zi + px + i)) continue;
+        float u  = s.u0 + s.du * (float)i;
+        float v  = s.v0 + s.dv * (float)i;
+        int   tx = (int)(u * s.fw) & tex->w_mask;
+        int   ty = (int)((1.0f - v) * s.fh) & tex->h_mask;
+        dst[i] = tex->px[ty * tex->w + tx];
+      }
+      _sf_px_flush(cam, tmp, ci + px, span_len);
     }
-    sf_pkd_clr_t px = cam->buffer[i];
-    uint32_t r = (px >> 16) & 0xFF;
-    uint32_t g = (px >>  8) & 0xFF;
-    uint32_t b =  px        & 0xFF;
-    uint32_t it = (uint32_t)(t * 256.0f);
-    r = (r * (256u - it) + fr  * it) >> 8;
-    g = (g * (256u - it) + fg_ * it) >> 8;
-    b = (b * (256u - it) + fb  * it) >> 8;
-    cam->buffer[i] = (0xFFu << 24) | (r << 16) | (g << 8) | b;
   }
 }
 
+sf_sky_t _sf_sky_setup(const sf_cam_t *cam, sf_tex_t *tex) {
+  /* Per-camera constants shared by the skybox and sky-fill passes: view basis, inverse projection, per-pixel step. */
+  sf_sky_t s;
+  memset(&s, 0, sizeof(s));
+  s.tex    = tex;
+  s.r      = (sf_fvec3_t){  cam->V.m[0][0],  cam->V.m[1][0],  cam->V.m[2][0] };
+  s.u      = (sf_fvec3_t){  cam->V.m[0][1],  cam->V.m[1][1],  cam->V.m[2][1] };
+  s.f      = (sf_fvec3_t){ -cam->V.m[0][2], -cam->V.m[1][2], -cam->V.m[2][2] };
+  s.inv_px = 1.0f / cam->P.m[0][0];
+  s.inv_py = 1.0f / cam->P.m[1][1];
+  s.inv_w  = 1.0f / (float)cam->w;
+  s.inv_h  = 1.0f / (float)cam->h;
+  s.fw     = (float)tex->w;
+  s.fh     = (float)tex->h;
+  s.step   = (sf_fvec3_t){ s.r.x * 2.0f * s.inv_px * s.inv_w, s.r.y * 2.0f * s.inv_px * s.inv_w, s.r.z * 2.0f * s.inv_px * s.inv_w };
+  return s;
+}
+
+void _sf_sky_row(sf_sky_t *s, const sf_cam_t *cam, int py) {
+  /* Point s at the world-space view direction through the first pixel center of row py. */
+  float ndc_y = 1.0f - (2.0f * ((float)py + 0.5f)) * s->inv_h;
+  float vd_y  = (ndc_y + cam->P.m[2][1]) * s->inv_py;
+  float vd_x0 = (s->inv_w - 1.0f + cam->P.m[2][0]) * s->inv_px;
+  s->d = (sf_fvec3_t){ vd_x0 * s->r.x + vd_y * s->u.x + s->f.x,
+                       vd_x0 * s->r.y + vd_y * s->u.y + s->f.y,
+                       vd_x0 * s->r.z + vd_y * s->u.z + s->f.z };
+}
+
+void _sf_sky_span(sf_sky_t *s, int len, bool uv) {
+  /* Advance s by a len-pixel span. With uv, first set u0/v0 and du/dv from exact panorama
+   * UVs at both span ends, unwrapping u across the seam. */
+  sf_fvec3_t e = { s->d.x + s->step.x * (float)len, s->d.y + s->step.y * (float)len, s->d.z + s->step.z * (float)len };
+  if (uv) {
+    float inv_2pi = 1.0f / (2.0f * SF_PI);
+    float inv_pi  = 1.0f / SF_PI;
+    float xz0 = sqrtf(s->d.x * s->d.x + s->d.z * s->d.z);
+    float u0  = atan2f(s->d.x, s->d.z) * inv_2pi + 0.5f;
+    float v0  = atan2f(s->d.y, xz0)    * inv_pi  + 0.5f;
+    float xz1 = sqrtf(e.x * e.x + e.z * e.z);
+    float u1  = atan2f(e.x, e.z) * inv_2pi + 0.5f;
+    float v1  = atan2f(e.y, xz1) * inv_pi  + 0.5f;
+    if (u1 - u0 >  0.5f) u1 -= 1.0f;
+    if (u0 - u1 >  0.5f) u1 += 1.0f;
+    float inv_span = 1.0f / (float)len;
+    s->u0 = u0;
+    s->v0 = v0;
+    s->du = (u1 - u0) * inv_span;
+    s->dv = (v1 - v0) * inv_span;
+  }
+  s->d = e;
+}
+
+void sf_render_fog(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Post-process depth fog: blend each geometry pixel toward fog_color based on
+   * linearised view-space depth.  Sky/unwritten pixels (z > 2.0) are fully fogged. */
+  if (!_sf_render_look(ctx, cam).fog_enabled) return;
+  sf_post_t pp = _sf_post_setup(ctx, cam, true, false);
+  sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_post_job, &pp);
+}
+
 void sf_render_depth(sf_ctx_t *ctx, sf_cam_t *cam) {
   /* Visualise the z-buffer as a heatmap: blue (near) → cyan → green → yellow → red (far/sky).
-   * NDC z is highly nonlinear so we linearise to view-space depth first, then apply a power
-   * curve to spread the colours usefully across the visible scene range. */
-  static const float kr[5] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f};
-  static const float kg[5] = {0.0f, 1.0f, 1.0f, 1.0f, 0.0f};
-  static const float kb[5] = {1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
-  float near    = cam->near_plane;
-  float far     = cam->far_plane;
-  float A       = 2.0f * near * far;
-  float B       = far + near;
-  float C       = far - near;
-  float inv_rng = 1.0f / (far - near);
-  int n = cam->w * cam->h;
-  for (int i = 0; i < n; i++) {
-    float z = cam->z_buffer[i];
-    float t;
-    if (z > 2.0f) {
-      t = 1.0f;
-    } else {
-      float depth = A / (B - z * C);
-      t = (depth - near) * inv_rng;
+   * Depth is linearised to view space, then mapped through the precomputed power-curve LUT. */
+  sf_post_t pp = _sf_post_setup(ctx, cam, false, true);
+  sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_post_job, &pp);
+}
+
+void sf_render_post(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Run the post effects enabled for the current render mode in one fused pass over cam. */
+  sf_look_t look  = _sf_render_look(ctx, cam);
+  bool      depth = (look.render_mode == SF_RENDER_DEPTH);
+  bool      fog   = (look.render_mode == SF_RENDER_NORMAL && look.fog_enabled && (cam->features & SF_CAM_FOG));
+  if (!depth && !fog) return;
+  sf_post_t pp = _sf_post_setup(ctx, cam, fog, depth);
+  sf_jobs_parallel_for(ctx, cam->h, SF_JOB_ROWS, _sf_post_job, &pp);
+}
+
+sf_post_t _sf_post_setup(sf_ctx_t *ctx, sf_cam_t *cam, bool fog, bool depth) {
+  /* Precompute the per-camera constants shared by every row of the post pass. */
+  sf_post_t pp;
+  sf_look_t look    = _sf_render_look(ctx, cam);
+  float     near    = cam->near_plane;
+  float     far     = cam->far_plane;
+  float     fog_rng = look.fog_end - look.fog_start;
+  uint32_t  fr      = (uint32_t)(look.fog_color.x * 255.0f + 0.5f);
+  uint32_t  fg      = (uint32_t)(look.fog_color.y * 255.0f + 0.5f);
+  uint32_t  fb      = (uint32_t)(look.fog_color.z * 255.0f + 0.5f);
+  pp.fog           = fog && !depth;
+  pp.depth         = depth;
+  pp.A             = 2.0f * near * far;
+  pp.B             = far + near;
+  pp.C             = far - near;
+  pp.near_plane    = near;
+  pp.fog_start     = look.fog_start;
+  pp.fog_inv_rng   = 1.0f / fog_rng;
+  pp.fog_rgb       = (fr << 16) | (fg << 8) | fb;
+  pp.depth_inv_rng = 1.0f / (far - near);
+  pp.u16           = (cam->depth_fmt == SF_DEPTH_U16);
+  pp.q_scale       = depth ? 1.0f / 65535.0f : (far - near) / 65535.0f * pp.fog_inv_rng;
+  pp.q_off         = depth ? 0.0f            : (near - look.fog_start) * pp.fog_inv_rng;
+  pp.depth_lut     = ctx->_depth_lut;
+  pp.cam           = cam;
+  if (cam->depth_fmt == SF_DEPTH_F32_REV) {
+    pp.A = -near;
+    pp.B =  0.0f;
+    pp.C = -1.0f;
+  }
+  return pp;
+}
+
+void _sf_post_rows(sf_cam_t *cam, const sf_post_t *pp, int y0, int y1) {
+  /* Apply the post pass to rows [y0, y1) only, so a frame can be split across workers by row band. */
+  if (!pp->fog && !pp->depth) return;
+  const sf_pkd_clr_t *lut     = pp->depth_lut;
+  bool                depth   = pp->depth;
+  float               qs      = pp->q_scale, qo = pp->q_off;
+  float               off     = depth ? pp->near_plane    : pp->fog_start;
+  float               inv     = depth ? pp->depth_inv_rng : pp->fog_inv_rng;
+  float               scl     = depth ? (float)(SF_DEPTH_LUT_SIZE - 1) : 256.0f;
+  float               A       = pp->A, B = pp->B, C = pp->C;
+  uint32_t            fr      = (pp->fog_rgb >> 16) & 0xFF;
+  uint32_t            fg      = (pp->fog_rgb >>  8) & 0xFF;
+  uint32_t            fb      =  pp->fog_rgb        & 0xFF;
+  int                 rows    = y1 - y0;
+  int                 n       = cam->w;
+  if (cam->stride == cam->w) { n *= rows; rows = 1; }
+#if defined(__SSE2__)
+  __m128  vA    = _mm_set1_ps(A);
+  __m128  vB    = _mm_set1_ps(B);
+  __m128  vC    = _mm_set1_ps(C);
+  __m128  vtwo  = _mm_set1_ps(2.0f);
+  __m128  vzero = _mm_setzero_ps();
+  __m128  vone  = _mm_set1_ps(1.0f);
+  __m128  voff  = _mm_set1_ps(off);
+  __m128  vinv  = _mm_set1_ps(inv);
+  __m128  vscl  = _mm_set1_ps(scl);
+  __m128  vqs   = _mm_set1_ps(qs);
+  __m128  vqo   = _mm_set1_ps(qo);
+  __m128  vqmax = _mm_set1_ps(65535.0f);
+  __m128i vz16  = _mm_setzero_si128();
+  __m128i v256  = _mm_set1_epi16(256);
+  __m128i vfog  = _mm_unpacklo_epi8(_mm_set1_epi32((int)pp->fog_rgb), vz16);
+  __m128i valph = _mm_set1_epi32((int)0xFF000000u);
+#endif
+  for (int ry = 0; ry < rows; ry++) {
+    int                 y    = y0 + ry;
+    int                 base = y * cam->stride;
+    sf_pkd_clr_t       *buf  = cam->buffer ? cam->buffer + base : NULL;
+    const float        *zb   = pp->u16 ? NULL : cam->z_buffer   + (size_t)y * cam->w;
+    const uint16_t     *zq   = pp->u16 ? cam->z_buffer16 + (size_t)y * cam->w : NULL;
+    int                 i    = 0;
+#if defined(__SSE2__)
+    int                 n4   = buf ? n : 0;
+    for (; i + 4 <= n4; i += 4) {
+      __m128 sky, t;
+      if (zq) {
+        __m128 q   = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(zq + i)), vz16));
+        sky        = _mm_cmpeq_ps(q, vqmax);
+        t          = _mm_add_ps(_mm_mul_ps(q, vqs), vqo);
+      } else {
+        __m128 z   = _mm_loadu_ps(zb + i);
+        sky        = _mm_cmpgt_ps(z, vtwo);
+        __m128 den = _mm_sub_ps(vB, _mm_mul_ps(z, vC));
+        __m128 rcp = _mm_rcp_ps(den);
+        rcp        = _mm_mul_ps(rcp, _mm_sub_ps(vtwo, _mm_mul_ps(den, rcp)));
+        t          = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(vA, rcp), voff), vinv);
+      }
+      t          = _mm_min_ps(_mm_max_ps(t, vzero), vone);
+      t          = _mm_or_ps(_mm_and_ps(sky, vone), _mm_andnot_ps(sky, t));
+      if (depth) {
+        int idx[4];
+        _mm_storeu_si128((__m128i*)idx, _mm_cvtps_epi32(_mm_mul_ps(t, vscl)));
+        buf[i + 0] = lut[idx[0]];
+        buf[i + 1] = lut[idx[1]];
+        buf[i + 2] = lut[idx[2]];
+        buf[i + 3] = lut[idx[3]];
+        continue;
+      }
+      __m128i it = _mm_cvttps_epi32(_mm_mul_ps(t, vscl));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(it, vz16)) == 0xFFFF) continue;
+      __m128i it16 = _mm_packs_epi32(it, it);
+      it16         = _mm_unpacklo_epi16(it16, it16);
+      __m128i it_l = _mm_unpacklo_epi32(it16, it16);
+      __m128i it_h = _mm_unpackhi_epi32(it16, it16);
+      __m128i px   = _mm_loadu_si128((__m128i*)(buf + i));
+      __m128i px_l = _mm_unpacklo_epi8(px, vz16);
+      __m128i px_h = _mm_unpackhi_epi8(px, vz16);
+      px_l = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(px_l, _mm_sub_epi16(v256, it_l)), _mm_mullo_epi16(vfog, it_l)), 8);
+      px_h = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(px_h, _mm_sub_epi16(v256, it_h)), _mm_mullo_epi16(vfog, it_h)), 8);
+      _mm_storeu_si128((__m128i*)(buf + i), _mm_or_si128(_mm_packus_epi16(px_l, px_h), valph));
+    }
+#endif
+    for (; i < n; i++) {
+      float t = 1.0f;
+      if (zq) {
+        if (zq[i] != 0xFFFF) t = (float)zq[i] * qs + qo;
+      } else if (zb[i] <= 2.0f) {
+        t = (A / (B - zb[i] * C) - off) * inv;
+      }
       if (t < 0.0f) t = 0.0f;
       if (t > 1.0f) t = 1.0f;
-      t = powf(t, 0.2f);
+      if (depth) {
+        if (buf) buf[i] = lut[(int)(t * scl + 0.5f)];
+        else     _sf_put_px(cam, base + i, lut[(int)(t * scl + 0.5f)]);
+        continue;
+      }
+      uint32_t it = (uint32_t)(t * scl);
+      if (it == 0) continue;
+      sf_pkd_clr_t px = buf ? buf[i] : _sf_get_px(cam, base + i);
+      uint32_t r = (px >> 16) & 0xFF;
+      uint32_t g = (px >>  8) & 0xFF;
+      uint32_t b =  px        & 0xFF;
+      r = (r * (256u - it) + fr * it) >> 8;
+      g = (g * (256u - it) + fg * it) >> 8;
+      b = (b * (256u - it) + fb * it) >> 8;
+      if (buf) buf[i] = (0xFFu << 24) | (r << 16) | (g << 8) | b;
+      else     _sf_put_px(cam, base + i, (0xFFu << 24) | (r << 16) | (g << 8) | b);
     }
-    float scaled = t * 4.0f;
-    int seg = (int)scaled;
-    if (seg >= 4) seg = 3;
-    float f = scaled - (float)seg;
-    uint8_t r = (uint8_t)((kr[seg] + (kr[seg+1] - kr[seg]) * f) * 255.0f + 0.5f);
-    uint8_t g = (uint8_t)((kg[seg] + (kg[seg+1] - kg[seg]) * f) * 255.0f + 0.5f);
-    uint8_t b = (uint8_t)((kb[seg] + (kb[seg+1] - kb[seg]) * f) * 255.0f + 0.5f);
-    cam->buffer[i] = 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
   }
 }
 
+void _sf_post_job(sf_ctx_t *ctx, void *user, int y0, int y1, int worker) {
+  /* Post-pass job body: user is the sf_post_t from _sf_post_setup. */
+  (void)ctx; (void)worker;
+  const sf_post_t *pp = (const sf_post_t*)user;
+  _sf_post_rows(pp->cam, pp, y0, y1);
+}
+
 void sf_update_emitrs(sf_ctx_t *ctx) {
   /* Advance particle lifetimes, move them by velocity, and spawn new particles according to rate. */
   float dt = ctx->delta_time;
   for (int i = 0; i < ctx->emitr_count; i++) {
-    sf_emitr_t *em = &ctx->emitrs[i];
+    sf_emitr_t *em = ctx->emitrs[i];
     if (!em->frame) continue;
 
-    sf_fmat4_t M = em->frame->global_M;
+    sf_fmat43_t M = em->frame->global_M;
     sf_fvec3_t pos_w = { M.m[3][0], M.m[3][1], M.m[3][2] };
 
     for (int p = 0; p < em->max_particles; p++) {
@@ -1437,7 +3006,8 @@ void sf_update_emitrs(sf_ctx_t *ctx) {
 }
 
 void sf_time_update(sf_ctx_t *ctx) {
-  /* Sample the high-resolution clock to compute delta_time, elapsed_time, smoothed FPS, and frame count. */
+  /* Sample the high-resolution clock to compute delta_time, elapsed_time, smoothed FPS, and frame count, and start
+   * a new frame in the transient allocator. */
   uint64_t current_ticks = _sf_get_ticks();
   uint64_t diff = current_ticks - ctx->_last_ticks;
   ctx->delta_time = (float)((double)diff / (double)SF_NANOS_PER_SEC);
@@ -1450,25 +3020,43 @@ void sf_time_update(sf_ctx_t *ctx) {
   ctx->frame_count++;
   ctx->_perf_dt_hist[ctx->_perf_dt_idx] = ctx->delta_time;
   ctx->_perf_dt_idx = (ctx->_perf_dt_idx + 1) % SF_PERF_HIST_SIZE;
+  _sf_tmp_flip(ctx);
 }
 
 /* SF_MEMORY_FUNCTIONS */
 sf_arena_t sf_arena_init(sf_ctx_t *ctx, size_t size) {
-  /* Allocate a new arena of the given byte size; all subsequent allocs bump a single pointer. */
+  /* Reserve size bytes of address space for a new arena; all subsequent allocs bump a single pointer, and pages
+   * are committed SF_ARENA_COMMIT bytes at a time as the pointer reaches them. */
   sf_arena_t arena;
-  arena.size = size;
-  arena.offset = 0;
-  arena.buffer = malloc(size);
+  arena.size      = size;
+  arena.offset    = 0;
+  arena.committed = 0;
+  arena.buffer    = (uint8_t*)mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (arena.buffer == (uint8_t*)MAP_FAILED) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to reserve %zu byte arena\n", size);
+    arena.buffer = NULL;
+    arena.size   = 0;
+  }
   return arena;
 }
 
 void* sf_arena_alloc(sf_ctx_t *ctx, sf_arena_t *arena, size_t size) {
-  /* Bump-allocate size bytes from arena with alignment; returns NULL and logs error if full. */
+  /* Bump-allocate size bytes from arena with alignment, committing pages as needed; returns NULL and logs error if
+   * full. */
   size_t aligned_offset = SF_ALIGN_SIZE(arena->offset);
   if (aligned_offset + size > arena->size) {
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate, arena out of memory\n");
     return NULL;
   }
+  if (aligned_offset + size > arena->committed) {
+    size_t top = (aligned_offset + size + SF_ARENA_COMMIT - 1) / SF_ARENA_COMMIT * SF_ARENA_COMMIT;
+    if (top > arena->size) top = arena->size;
+    if (mprotect(arena->buffer + arena->committed, top - arena->committed, PROT_READ | PROT_WRITE) != 0) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate, could not commit arena pages\n");
+      return NULL;
+    }
+    arena->committed = top;
+  }
   void *ptr = &arena->buffer[aligned_offset];
   arena->offset = aligned_offset + size;
   SF_LOG(ctx, SF_LOG_DEBUG,
@@ -1490,14 +3078,132 @@ void sf_arena_restore(sf_ctx_t *ctx, sf_arena_t *arena, size_t mark) {
   arena->offset = mark;
 }
 
+void sf_arena_free(sf_arena_t *arena) {
+  /* Release an arena's whole reservation. */
+  if (arena->buffer) munmap(arena->buffer, arena->size);
+  arena->buffer    = NULL;
+  arena->committed = 0;
+}
+
+void* sf_heap_alloc(sf_ctx_t *ctx, size_t size) {
+  /* Allocate size bytes of long-lived asset data from the context arena, reusing a freed block of the same size
+   * class (quarter powers of two) when there is one, then a larger free block once the arena is full. */
+  sf_heap_t *hp  = &ctx->heap;
+  int32_t    cls = _sf_heap_class(size ? size : 1);
+  if (cls >= SF_HEAP_CLASSES) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate %zu bytes, larger than any heap class\n", size);
+    return NULL;
+  }
+  size_t         need = sizeof(sf_heap_blk_t) + _sf_heap_csize(cls);
+  bool           full = SF_ALIGN_SIZE(ctx->arena.offset) + need > ctx->arena.size;
+  sf_heap_blk_t *b    = hp->free_list[cls];
+  for (int32_t c = cls + 1; !b && full && c < SF_HEAP_CLASSES; c++) b = hp->free_list[c];
+  if (b) {
+    hp->free_list[b->cls] = *(sf_heap_blk_t**)(b + 1);
+    hp->idle             -= sizeof(sf_heap_blk_t) + _sf_heap_csize((int32_t)b->cls);
+    hp->idle_blocks--;
+  } else if (!full) {
+    b             = (sf_heap_blk_t*)sf_arena_alloc(ctx, &ctx->arena, need);
+    if (!b) return NULL;
+    b->cls        = (uint32_t)cls;
+    hp->reserved += need;
+  } else {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate %zu bytes, heap out of memory\n", size);
+    return NULL;
+  }
+  b->magic  = SF_HEAP_LIVE;
+  b->size   = size;
+  hp->used += size;
+  hp->live++;
+  if (hp->used > hp->peak) hp->peak = hp->used;
+  return b + 1;
+}
+
+void sf_heap_free(sf_ctx_t *ctx, const void *ptr) {
+  /* Return a block from sf_heap_alloc to its size-class free list. NULL is ignored; pointers the heap did not
+   * hand out, or already freed, are logged and left alone. */
+  if (!ptr) return;
+  sf_heap_t     *hp = &ctx->heap;
+  sf_heap_blk_t *b  = (sf_heap_blk_t*)ptr - 1;
+  if ((const uint8_t*)b < ctx->arena.buffer || (const uint8_t*)ptr > ctx->arena.buffer + ctx->arena.offset ||
+      b->magic != SF_HEAP_LIVE) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to free %p, not a live heap block\n", ptr);
+    return;
+  }
+  b->magic                   = SF_HEAP_FREE;
+  *(sf_heap_blk_t**)(b + 1)  = hp->free_list[b->cls];
+  hp->free_list[b->cls]      = b;
+  hp->idle                  += sizeof(sf_heap_blk_t) + _sf_heap_csize((int32_t)b->cls);
+  hp->idle_blocks++;
+  hp->used                  -= b->size;
+  hp->live--;
+}
+
+float sf_heap_frag(const sf_ctx_t *ctx) {
+  /* Fraction of the heap's arena bytes not holding live data: idle free-list blocks plus headers and class
+   * rounding. 0 means every reserved byte is in use. */
+  const sf_heap_t *hp = &ctx->heap;
+  return hp->reserved ? 1.0f - (float)hp->used / (float)hp->reserved : 0.0f;
+}
+
+int32_t _sf_heap_class(size_t size) {
+  /* Smallest size class holding size bytes; classes split each power of two from 32 bytes into four steps. */
+  if (size <= 32) return 0;
+  int32_t k = 5;
+  while (((size_t)2 << k) < size) k++;
+  size_t  q = (size_t)1 << (k - 2);
+  return (k - 5) * 4 + (int32_t)((size - ((size_t)1 << k) + q - 1) / q);
+}
+
+size_t _sf_heap_csize(int32_t cls) {
+  /* Payload bytes of a block in size class cls. */
+  return (size_t)(4 + (cls & 3)) << (3 + (cls >> 2));
+}
+
+void* sf_tmp_alloc(sf_ctx_t *ctx, size_t size) {
+  /* Allocate per-frame transient memory from the calling worker's side of the frame allocator. It stays valid
+   * until the end of the next frame (two sf_time_update calls), so a pipelined render can still read it. */
+  sf_arena_t *tmp = sf_tmp_arena(ctx);
+  if (!tmp) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate %zu transient bytes, not on a worker thread\n", size);
+    return NULL;
+  }
+  return sf_arena_alloc(ctx, tmp, size);
+}
+
+sf_arena_t* sf_tmp_arena(sf_ctx_t *ctx) {
+  /* The calling worker's current frame arena, or NULL off the worker pool. Scoped scratch can bracket its use
+   * with sf_arena_save/sf_arena_restore; nothing else touches it from another thread. */
+  int w = sf_jobs_worker(ctx);
+  if (w < 0 || ctx->jobs.count == 0) return NULL;
+  return &ctx->jobs.wrkrs[w].tmp[atomic_load_explicit(&ctx->jobs.tmp_side, memory_order_acquire)];
+}
+
+void _sf_tmp_flip(sf_ctx_t *ctx) {
+  /* Start a new frame in the transient allocator: empty the side not in use and make it current. A render still
+   * in flight from two frames back may be using that side, so it is finished first. */
+  sf_jobs_t *jb = &ctx->jobs;
+  if (jb->count == 0) return;
+  if (ctx->_snap.in_flight && ctx->_snap.tmp_flips++ > 0) sf_render_sync(ctx);
+  int next = 1 - atomic_load(&jb->tmp_side);
+  for (int i = 0; i < jb->count; i++) jb->wrkrs[i].tmp[next].offset = 0;
+  atomic_store_explicit(&jb->tmp_side, next, memory_order_release);
+}
+
 size_t _sf_obj_memusg(sf_obj_t *obj) {
-  /* Return the total arena bytes consumed by an obj's vertex, UV, normal, and face arrays. */
+  /* Return the total arena bytes consumed by an obj's vertex, UV, normal, and face arrays and its weld. */
   if (!obj) return 0;
   size_t v_size  = obj->v_cnt * sizeof(sf_fvec3_t);
   size_t vt_size = obj->vt_cnt * sizeof(sf_fvec2_t);
   size_t vn_size = obj->vn_cnt * sizeof(sf_fvec3_t);
-  size_t f_size  = obj->f_cnt * sizeof(sf_face_t);
-  return v_size + vt_size + vn_size + f_size;
+  size_t f_size  = obj->f ? obj->f_cnt * sizeof(sf_face_t) : 0;
+  size_t w_size  = 0;
+  if (obj->weld && obj->weld->valid) {
+    size_t vb = obj->weld->qv ? 3 * sizeof(int16_t) + (obj->weld->qt ? 2 * sizeof(uint16_t) : 0)
+                              : sizeof(sf_fvec3_t) + (obj->weld->vt ? sizeof(sf_fvec2_t) : 0);
+    w_size = obj->weld->v_cnt * vb + obj->weld->f_cnt * 3 * (obj->weld->idx16 ? sizeof(uint16_t) : sizeof(uint32_t));
+  }
+  return v_size + vt_size + vn_size + f_size + w_size;
 }
 
 char* _sf_arena_strdup(sf_ctx_t *ctx, const char *s) {
@@ -1509,6 +3215,359 @@ char* _sf_arena_strdup(sf_ctx_t *ctx, const char *s) {
   return m;
 }
 
+void* _sf_grow(void *p, int32_t *cap, int32_t n, size_t size) {
+  /* Make room for n elements of size bytes in heap array p, doubling *cap as needed. Returns the (possibly
+   * moved) array, or NULL with p and *cap untouched if realloc fails; a NULL p is allocated even for n == 0,
+   * so NULL always means failure. */
+  if (p && n <= *cap) return p;
+  int32_t c = *cap > 8 ? *cap * 2 : 16;
+  if (c < n) c = n;
+  void *q = realloc(p, (size_t)c * size);
+  if (q) *cap = c;
+  return q;
+}
+
+void sf_pool_init(sf_pool_t *pool, size_t item_size) {
+  /* Set up an empty pool of item_size-byte items, stored in chunks of SF_POOL_CHUNK that never move. */
+  memset(pool, 0, sizeof(sf_pool_t));
+  pool->stride    = sizeof(sf_pool_hdr_t) + SF_ALIGN_SIZE(item_size);
+  pool->free_head = -1;
+}
+
+void* sf_pool_add(sf_ctx_t *ctx, sf_pool_t *pool) {
+  /* Take a zeroed item off the free list, adding a chunk when it is empty, and append it to pool->items.
+   * Returns NULL and logs if out of memory. */
+  if (pool->free_head < 0) {
+    uint8_t **chunks = (uint8_t**)_sf_grow(pool->chunks, &pool->chunk_cap, pool->chunk_count + 1, sizeof(uint8_t*));
+    uint8_t  *c      = chunks ? (uint8_t*)malloc(SF_POOL_CHUNK * pool->stride) : NULL;
+    if (chunks) pool->chunks = chunks;
+    if (!c) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to grow pool, out of memory\n");
+      return NULL;
+    }
+    pool->chunks[pool->chunk_count] = c;
+    int32_t base = pool->chunk_count++ * SF_POOL_CHUNK;
+    for (int32_t i = SF_POOL_CHUNK - 1; i >= 0; i--) {
+      sf_pool_hdr_t *h = (sf_pool_hdr_t*)(c + (size_t)i * pool->stride);
+      h->slot         = (uint32_t)(base + i);
+      h->gen          = 1;
+      h->dense        = -1;
+      h->next         = pool->free_head;
+      pool->free_head = base + i;
+    }
+  }
+  void **items = (void**)_sf_grow(pool->items, &pool->item_cap, pool->count + 1, sizeof(void*));
+  if (!items) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to grow pool, out of memory\n");
+    return NULL;
+  }
+  pool->items = items;
+  sf_pool_hdr_t *h = _sf_pool_hdr(pool, pool->free_head);
+  pool->free_head = h->next;
+  h->dense        = pool->count;
+  void *item      = h + 1;
+  memset(item, 0, pool->stride - sizeof(sf_pool_hdr_t));
+  pool->items[pool->count++] = item;
+  return item;
+}
+
+bool sf_pool_remove(sf_pool_t *pool, void *item) {
+  /* Give item back to pool: the last live item fills its spot in pool->items, handles to it go stale, and every
+   * other item keeps its address. Returns false if item is not live in pool. */
+  sf_pool_hdr_t *h = _sf_pool_find(pool, item);
+  if (!h) return false;
+  int32_t d = h->dense;
+  pool->items[d] = pool->items[--pool->count];
+  ((sf_pool_hdr_t*)pool->items[d] - 1)->dense = d;
+  h->dense        = -1;
+  h->gen          = (h->gen + 1) ? h->gen + 1 : 1;
+  h->next         = pool->free_head;
+  pool->free_head = (int32_t)h->slot;
+  return true;
+}
+
+void* sf_pool_get(sf_pool_t *pool, sf_handle_t h) {
+  /* Resolve a handle from sf_pool_handle; NULL once the item it named has been removed. */
+  if (h.idx >= (uint32_t)(pool->chunk_count * SF_POOL_CHUNK)) return NULL;
+  sf_pool_hdr_t *hd = _sf_pool_hdr(pool, (int32_t)h.idx);
+  return (hd->gen == h.gen && hd->dense >= 0) ? (void*)(hd + 1) : NULL;
+}
+
+sf_handle_t sf_pool_handle(sf_pool_t *pool, const void *item) {
+  /* Generational handle for a live item; {0, 0} (never valid) if item is not live in pool. */
+  sf_pool_hdr_t *h = _sf_pool_find(pool, item);
+  return h ? (sf_handle_t){ h->slot, h->gen } : (sf_handle_t){ 0, 0 };
+}
+
+void sf_pool_free(sf_pool_t *pool) {
+  /* Release every chunk and the item list; all items and handles from pool become invalid. */
+  for (int32_t i = 0; i < pool->chunk_count; i++) free(pool->chunks[i]);
+  free(pool->chunks);
+  free(pool->items);
+  sf_pool_init(pool, pool->stride - sizeof(sf_pool_hdr_t));
+}
+
+sf_pool_hdr_t* _sf_pool_hdr(sf_pool_t *pool, int32_t slot) {
+  /* Header of slot; the item itself follows it directly. */
+  return (sf_pool_hdr_t*)(pool->chunks[slot / SF_POOL_CHUNK] + (size_t)(slot % SF_POOL_CHUNK) * pool->stride);
+}
+
+sf_pool_hdr_t* _sf_pool_find(sf_pool_t *pool, const void *item) {
+  /* Header of item if it is a live item of pool, else NULL. */
+  if (!item) return NULL;
+  const sf_pool_hdr_t *h = (const sf_pool_hdr_t*)item - 1;
+  if (h->slot >= (uint32_t)(pool->chunk_count * SF_POOL_CHUNK)) return NULL;
+  sf_pool_hdr_t *hd = _sf_pool_hdr(pool, (int32_t)h->slot);
+  return (hd == h && hd->dense >= 0) ? hd : NULL;
+}
+
+/* SF_JOB_FUNCTIONS */
+void sf_jobs_init(sf_ctx_t *ctx, int workers) {
+  /* Start the worker pool; workers <= 0 picks one per online core. Worker 0 is always the calling thread.
+   * Each worker reserves two jobs.tmp_size frame arenas (SF_JOB_TMP_SIZE when unset), committed as used.
+   * New threads wait for the final worker count to be published before they look at the pool. */
+  sf_jobs_t *jb = &ctx->jobs;
+  if (jb->count > 0) return;
+  if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (workers < 1) workers = 1;
+  if (workers > SF_MAX_JOB_WRKRS) workers = SF_MAX_JOB_WRKRS;
+  if (jb->tmp_size == 0) jb->tmp_size = SF_JOB_TMP_SIZE;
+  jb->wrkrs = sf_arena_alloc(ctx, &ctx->arena, workers * sizeof(sf_job_wrkr_t));
+  if (!jb->wrkrs) return;
+  memset(jb->wrkrs, 0, workers * sizeof(sf_job_wrkr_t));
+  atomic_init(&jb->queued, 0);
+  atomic_init(&jb->tmp_side, 0);
+  atomic_init(&jb->quit, false);
+  atomic_init(&jb->started, false);
+  pthread_mutex_init(&jb->lock, NULL);
+  pthread_cond_init(&jb->wake, NULL);
+  for (int i = 0; i < workers; i++) {
+    sf_job_wrkr_t *w = &jb->wrkrs[i];
+    w->ctx     = ctx;
+    w->id      = i;
+    w->ring    = sf_arena_alloc(ctx, &ctx->arena, SF_JOB_QUEUE_SIZE * sizeof(sf_job_t));
+    w->scratch = sf_arena_init(ctx, SF_JOB_SCRATCH_SIZE);
+    w->tmp[0]  = sf_arena_init(ctx, jb->tmp_size);
+    w->tmp[1]  = sf_arena_init(ctx, jb->tmp_size);
+    atomic_init(&w->top, 0);
+    atomic_init(&w->bot, 0);
+  }
+  jb->wrkrs[0].thread = pthread_self();
+  _sf_jobs_ctx        = ctx;
+  _sf_jobs_id         = 0;
+  int started = 1;
+  for (int i = 1; i < workers; i++) {
+    if (pthread_create(&jb->wrkrs[i].thread, NULL, _sf_jobs_main, &jb->wrkrs[i]) != 0) {
+      SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "failed to start worker %d, running with %d\n", i, started);
+      break;
+    }
+    started++;
+  }
+  pthread_mutex_lock(&jb->lock);
+  jb->count = started;
+  atomic_store(&jb->started, true);
+  pthread_cond_broadcast(&jb->wake);
+  pthread_mutex_unlock(&jb->lock);
+  SF_LOG(ctx, SF_LOG_INFO,
+              SF_LOG_INDENT "wrkrs  : %d\n"
+              SF_LOG_INDENT "queue  : %d\n"
+              SF_LOG_INDENT "scratch: %d\n"
+              SF_LOG_INDENT "tmp    : 2x%zu\n",
+              jb->count, SF_JOB_QUEUE_SIZE, SF_JOB_SCRATCH_SIZE, jb->tmp_size);
+}
+
+void sf_jobs_shutdown(sf_ctx_t *ctx) {
+  /* Stop and join all worker threads and free their scratch and frame arenas; queued jobs that never ran are dropped. */
+  sf_jobs_t *jb = &ctx->jobs;
+  if (jb->count <= 0) return;
+  pthread_mutex_lock(&jb->lock);
+  atomic_store(&jb->quit, true);
+  pthread_cond_broadcast(&jb->wake);
+  pthread_mutex_unlock(&jb->lock);
+  for (int i = 1; i < jb->count; i++) pthread_join(jb->wrkrs[i].thread, NULL);
+  for (int i = 0; i < jb->count; i++) {
+    sf_arena_free(&jb->wrkrs[i].scratch);
+    sf_arena_free(&jb->wrkrs[i].tmp[0]);
+    sf_arena_free(&jb->wrkrs[i].tmp[1]);
+  }
+  pthread_mutex_destroy(&jb->lock);
+  pthread_cond_destroy(&jb->wake);
+  if (_sf_jobs_ctx == ctx) _sf_jobs_ctx = NULL;
+  jb->count = 0;
+}
+
+void sf_jobs_submit(sf_ctx_t *ctx, sf_job_fn fn, void *user, int i0, int i1, sf_job_ctr_t *dep, sf_job_ctr_t *done) {
+  /* Queue fn(ctx, user, i0, i1, worker) to run once dep (if any) reaches zero; done (if any) is counted down after.
+   * Only pool threads may queue work; calls from any other thread run the job inline with worker = -1. */
+  sf_job_t job = { fn, user, i0, i1, dep, done };
+  if (done) atomic_fetch_add(&done->n, 1);
+  int w = sf_jobs_worker(ctx);
+  if (w < 0) {
+    if (dep) sf_jobs_wait(ctx, dep);
+    fn(ctx, user, i0, i1, -1);
+    if (done) atomic_fetch_sub(&done->n, 1);
+    return;
+  }
+  if (ctx->jobs.count <= 1 || !_sf_jobs_push(&ctx->jobs, w, job)) {
+    if (dep) sf_jobs_wait(ctx, dep);
+    _sf_jobs_exec(ctx, w, job);
+    return;
+  }
+  pthread_mutex_lock(&ctx->jobs.lock);
+  pthread_cond_signal(&ctx->jobs.wake);
+  pthread_mutex_unlock(&ctx->jobs.lock);
+}
+
+void sf_jobs_wait(sf_ctx_t *ctx, sf_job_ctr_t *ctr) {
+  /* Block until ctr reaches zero, running queued jobs on this thread in the meantime. */
+  int w = sf_jobs_worker(ctx);
+  while (atomic_load(&ctr->n) > 0) {
+    if (w < 0 || !_sf_jobs_run_one(ctx, w)) sched_yield();
+  }
+}
+
+void sf_jobs_parallel_for(sf_ctx_t *ctx, int n, int grain, sf_job_fn fn, void *user) {
+  /* Split [0, n) into chunks of at least grain items, run them across the pool and wait for all of them. */
+  if (n <= 0) return;
+  if (grain < 1) grain = 1;
+  int w = sf_jobs_worker(ctx);
+  int chunks = (n + grain - 1) / grain;
+  if (w < 0) {
+    fn(ctx, user, 0, n, -1);
+    return;
+  }
+  if (ctx->jobs.count <= 1 || chunks <= 1) {
+    _sf_jobs_exec(ctx, w, (sf_job_t){ fn, user, 0, n, NULL, NULL });
+    return;
+  }
+  if (chunks > ctx->jobs.count * 4) {
+    chunks = ctx->jobs.count * 4;
+    grain  = (n + chunks - 1) / chunks;
+  }
+  sf_job_ctr_t ctr;
+  atomic_init(&ctr.n, 0);
+  for (int i0 = grain; i0 < n; i0 += grain) {
+    int i1 = (i0 + grain < n) ? i0 + grain : n;
+    sf_job_t job = { fn, user, i0, i1, NULL, &ctr };
+    atomic_fetch_add(&ctr.n, 1);
+    if (!_sf_jobs_push(&ctx->jobs, w, job)) _sf_jobs_exec(ctx, w, job);
+  }
+  pthread_mutex_lock(&ctx->jobs.lock);
+  pthread_cond_broadcast(&ctx->jobs.wake);
+  pthread_mutex_unlock(&ctx->jobs.lock);
+  _sf_jobs_exec(ctx, w, (sf_job_t){ fn, user, 0, grain, NULL, NULL });
+  sf_jobs_wait(ctx, &ctr);
+}
+
+int sf_jobs_worker(sf_ctx_t *ctx) {
+  /* Return the pool index of the calling thread, or -1 if it is not one of ctx's workers. Pool threads record their
+   * index on entry; only worker 0 (the thread that called sf_jobs_init) can lose it to another context's init. */
+  if (_sf_jobs_ctx == ctx) return _sf_jobs_id;
+  if (ctx->jobs.count == 0) return 0;
+  if (!pthread_equal(ctx->jobs.wrkrs[0].thread, pthread_self())) return -1;
+  _sf_jobs_ctx = ctx;
+  _sf_jobs_id  = 0;
+  return 0;
+}
+
+sf_arena_t* sf_jobs_scratch(sf_ctx_t *ctx) {
+  /* Return the calling worker's scratch arena; anything allocated in it is released when the current job returns. */
+  int w = sf_jobs_worker(ctx);
+  return (w < 0 || ctx->jobs.count == 0) ? NULL : &ctx->jobs.wrkrs[w].scratch;
+}
+
+bool _sf_jobs_push(sf_jobs_t *jb, int w, sf_job_t job) {
+  /* Push job onto the bottom of worker w's deque; only w itself may call this. Fails when the ring is full. */
+  sf_job_wrkr_t *wr = &jb->wrkrs[w];
+  long b = atomic_load(&wr->bot);
+  long t = atomic_load(&wr->top);
+  if (b - t >= SF_JOB_QUEUE_SIZE) return false;
+  wr->ring[b & (SF_JOB_QUEUE_SIZE - 1)] = job;
+  atomic_store(&wr->bot, b + 1);
+  atomic_fetch_add(&jb->queued, 1);
+  return true;
+}
+
+bool _sf_jobs_pop(sf_jobs_t *jb, int w, sf_job_t *out) {
+  /* Take the newest job from the bottom of worker w's own deque (LIFO, cache-warm). */
+  sf_job_wrkr_t *wr = &jb->wrkrs[w];
+  long b = atomic_load(&wr->bot) - 1;
+  atomic_store(&wr->bot, b);
+  long t = atomic_load(&wr->top);
+  if (t > b) { atomic_store(&wr->bot, b + 1); return false; }
+  *out = wr->ring[b & (SF_JOB_QUEUE_SIZE - 1)];
+  if (t == b) {
+    bool won = atomic_compare_exchange_strong(&wr->top, &t, t + 1);
+    atomic_store(&wr->bot, b + 1);
+    if (!won) return false;
+  }
+  atomic_fetch_sub(&jb->queued, 1);
+  return true;
+}
+
+bool _sf_jobs_steal(sf_jobs_t *jb, int victim, sf_job_t *out) {
+  /* Take the oldest job from the top of another worker's deque (FIFO, largest remaining work). */
+  sf_job_wrkr_t *wr = &jb->wrkrs[victim];
+  long t = atomic_load(&wr->top);
+  long b = atomic_load(&wr->bot);
+  if (t >= b) return false;
+  *out = wr->ring[t & (SF_JOB_QUEUE_SIZE - 1)];
+  if (!atomic_compare_exchange_strong(&wr->top, &t, t + 1)) return false;
+  atomic_fetch_sub(&jb->queued, 1);
+  return true;
+}
+
+bool _sf_jobs_run_one(sf_ctx_t *ctx, int w) {
+  /* Run one job from w's deque, or steal one from the others; returns false if nothing runnable was found. */
+  sf_jobs_t *jb = &ctx->jobs;
+  sf_job_t   job;
+  for (int k = 0; k < jb->count; k++) {
+    bool got = (k == 0) ? _sf_jobs_pop(jb, w, &job) : _sf_jobs_steal(jb, (w + k) % jb->count, &job);
+    if (!got) continue;
+    if (job.dep && atomic_load(&job.dep->n) > 0 && _sf_jobs_push(jb, w, job)) continue;
+    if (job.dep) sf_jobs_wait(ctx, job.dep);
+    _sf_jobs_exec(ctx, w, job);
+    return true;
+  }
+  return false;
+}
+
+void _sf_jobs_exec(sf_ctx_t *ctx, int w, sf_job_t job) {
+  /* Call a job on worker w, rewinding its scratch arena afterwards and counting down its done counter. */
+  if (ctx->jobs.count > 0) {
+    sf_arena_t *scratch = &ctx->jobs.wrkrs[w].scratch;
+    size_t      mark    = scratch->offset;
+    job.fn(ctx, job.user, job.i0, job.i1, w);
+    scratch->offset = mark;
+  } else {
+    job.fn(ctx, job.user, job.i0, job.i1, w);
+  }
+  if (job.done) atomic_fetch_sub(&job.done->n, 1);
+}
+
+void* _sf_jobs_main(void *arg) {
+  /* Worker thread loop: wait for sf_jobs_init to publish the pool, then sleep until work is queued and run or
+   * steal jobs, spinning briefly before sleeping again. */
+  sf_job_wrkr_t *wr  = (sf_job_wrkr_t*)arg;
+  sf_ctx_t      *ctx = wr->ctx;
+  sf_jobs_t     *jb  = &ctx->jobs;
+  int            idle = SF_JOB_SPIN;
+  _sf_jobs_ctx = ctx;
+  _sf_jobs_id  = wr->id;
+  pthread_mutex_lock(&jb->lock);
+  while (!atomic_load(&jb->started)) pthread_cond_wait(&jb->wake, &jb->lock);
+  pthread_mutex_unlock(&jb->lock);
+  while (!atomic_load(&jb->quit)) {
+    if (_sf_jobs_run_one(ctx, wr->id)) { idle = 0; continue; }
+    if (++idle < SF_JOB_SPIN) { sched_yield(); continue; }
+    pthread_mutex_lock(&jb->lock);
+    while (atomic_load(&jb->queued) == 0 && !atomic_load(&jb->quit)) pthread_cond_wait(&jb->wake, &jb->lock);
+    pthread_mutex_unlock(&jb->lock);
+    idle = 0;
+  }
+  return NULL;
+}
+
 /* SF_EVENT_FUNCTIONS */
 void sf_event_reg(sf_ctx_t *ctx, sf_event_type_t type, sf_event_cb cb, void *userdata) {
   /* Register a callback to be fired whenever the given event type is triggered. */
@@ -1640,8 +3699,8 @@ bool sf_key_pressed(sf_ctx_t *ctx, sf_key_t key) {
 /* SF_SCENE_FUNCTIONS */
 sf_tex_t* sf_load_texture_bmp(sf_ctx_t *ctx, const char *filename, const char *texname) {
   /* Load a 24-bit BMP file into the texture pool, applying gamma correction and treating magenta as transparent. */
-  if (ctx->tex_count >= SF_MAX_TEXTURES) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load texture '%s', max (%d) reached\n", texname, SF_MAX_TEXTURES);
+  if (ctx->tex_count >= ctx->tex_cap) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load texture '%s', max (%d) reached\n", texname, ctx->tex_cap);
     return NULL;
   }
   if (sf_get_texture_(ctx, texname, false) != NULL) {
@@ -1674,10 +3733,11 @@ sf_tex_t* sf_load_texture_bmp(sf_ctx_t *ctx, const char *filename, const char *t
   tex->w_mask = w - 1;
   tex->h_mask = h_abs - 1;
   tex->id = ctx->tex_count - 1;
-  tex->px = sf_arena_alloc(ctx, &ctx->arena, w * h_abs * sizeof(sf_pkd_clr_t));
+  tex->px = sf_heap_alloc(ctx, w * h_abs * sizeof(sf_pkd_clr_t));
   size_t name_len = strlen(texname) + 1;
-  tex->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  tex->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (tex->name) memcpy((void*)tex->name, texname, name_len);
+  _sf_names_put(ctx, &ctx->names[SF_NAME_TEX], tex->name, tex);
   fseek(file, data_offset, SEEK_SET);
   int padding = (4 - (w * 3) % 4) % 4;
   uint8_t bgr[3];
@@ -1704,7 +3764,7 @@ sf_tex_t* sf_load_texture_bmp(sf_ctx_t *ctx, const char *filename, const char *t
               SF_LOG_INDENT "w      : %d\n"
               SF_LOG_INDENT "h      : %d\n"
               SF_LOG_INDENT "used   : %d/%d\n",
-              filename, texname, tex->id, w, h_abs, ctx->tex_count, SF_MAX_TEXTURES);
+              filename, texname, tex->id, w, h_abs, ctx->tex_count, ctx->tex_cap);
   return tex;
 }
 
@@ -1719,20 +3779,24 @@ sf_sprite_2_t* sf_load_sprite(sf_ctx_t *ctx, const char *spritename, float durat
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load sprite '%s', name in use\n", spritename);
     return NULL;
   }
-  if (ctx->sprite_count >= SF_MAX_SPRITES || frame_count > SF_MAX_SPRITE_FRAMES) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load sprite '%s', max reached or too many frames\n", spritename);
+  if (frame_count > SF_MAX_SPRITE_FRAMES) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load sprite '%s', too many frames\n", spritename);
     return NULL;
   }
 
-  sf_sprite_2_t *spr = &ctx->sprites[ctx->sprite_count++];
+  sf_sprite_2_t *spr = (sf_sprite_2_t*)sf_pool_add(ctx, &ctx->sprite_pool);
+  if (!spr) return NULL;
+  ctx->sprites      = (sf_sprite_2_t**)ctx->sprite_pool.items;
+  ctx->sprite_count = ctx->sprite_pool.count;
   spr->id = ctx->sprite_count - 1;
   spr->frame_count = frame_count;
   spr->frame_duration = duration;
   spr->base_scale = scale;
 
   size_t name_len = strlen(spritename) + 1;
-  spr->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  spr->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (spr->name) memcpy((void*)spr->name, spritename, name_len);
+  _sf_names_put(ctx, &ctx->names[SF_NAME_SPRITE], spr->name, spr);
 
   va_list args;
   va_start(args, frame_count);
@@ -1748,13 +3812,14 @@ sf_sprite_2_t* sf_load_sprite(sf_ctx_t *ctx, const char *spritename, float durat
               SF_LOG_INDENT "frames : %d\n"
               SF_LOG_INDENT "dur    : %.2fs\n"
               SF_LOG_INDENT "scale  : %.2f\n"
-              SF_LOG_INDENT "used   : %d/%d\n",
-              spr->name, spr->id, frame_count, duration, scale, ctx->sprite_count, SF_MAX_SPRITES);
+              SF_LOG_INDENT "used   : %d\n",
+              spr->name, spr->id, frame_count, duration, scale, ctx->sprite_count);
   return spr;
 }
 
 sf_obj_t* sf_load_obj(sf_ctx_t *ctx, const char *filename, const char *objname) {
-  /* Parse a Wavefront .obj file and store verts, UVs, normals, and faces in the arena. */
+  /* Parse a Wavefront .obj file and store verts, UVs, normals, and faces in the arena.
+   * The file is read whole, split into lines, and the lines are parsed across the job pool. */
   char auto_name[32];
   if (objname == NULL) {
     snprintf(auto_name, sizeof(auto_name), "obj_%d", ctx->obj_count);
@@ -1766,8 +3831,8 @@ sf_obj_t* sf_load_obj(sf_ctx_t *ctx, const char *filename, const char *objname)
     return NULL;
   }
 
-  if (ctx->obj_count >= SF_MAX_OBJS) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load obj '%s', max (%d) reached\n", objname, SF_MAX_OBJS);
+  if (ctx->obj_count >= ctx->obj_cap) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load obj '%s', max (%d) reached\n", objname, ctx->obj_cap);
     return NULL;
   }
 
@@ -1777,38 +3842,69 @@ sf_obj_t* sf_load_obj(sf_ctx_t *ctx, const char *filename, const char *objname)
     return NULL;
   }
 
-  int32_t v_cnt = 0, vt_cnt = 0, vn_cnt = 0, f_cnt = 0; char line[256];
-  while (fgets(line, sizeof(line), file)) {
+  fseek(file, 0, SEEK_END);
+  long  fsize = ftell(file);
+  rewind(file);
+  char *text  = (fsize >= 0) ? (char*)malloc((size_t)fsize + 1) : NULL;
+  if (!text) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "could not read %s\n", filename);
+    fclose(file);
+    return NULL;
+  }
+  size_t tlen = fread(text, 1, (size_t)fsize, file);
+  char  *end  = text + tlen;
+  *end = '\0';
+  fclose(file);
+  for (char *c = text; c < end; c++) if (*c == '\0') *c = ' ';
+
+  int32_t v_cnt = 0, vt_cnt = 0, vn_cnt = 0, f_cnt = 0;
+  for (char *line = text; line < end; ) {
     if      (line[0] == 'v' && line[1] == ' ') v_cnt++;
     else if (line[0] == 'v' && line[1] == 't' && line[2] == ' ') vt_cnt++;
     else if (line[0] == 'v' && line[1] == 'n' && line[2] == ' ') vn_cnt++;
     else if (line[0] == 'f' && line[1] == ' ') f_cnt++;
+    char *nl = (char*)memchr(line, '\n', (size_t)(end - line));
+    if (!nl) break;
+    *nl  = '\0';
+    line = nl + 1;
+  }
+  char **lines = (char**)malloc((size_t)(v_cnt + vt_cnt + vn_cnt + f_cnt + 1) * sizeof(char*));
+  if (!lines) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "could not index %s\n", filename);
+    free(text);
+    return NULL;
   }
 
   sf_obj_t *obj = &ctx->objs[ctx->obj_count++];
   memset(obj, 0, sizeof(sf_obj_t));
+  obj->_ctx  = ctx;
   obj->v_cnt = v_cnt; obj->vt_cnt = vt_cnt; obj->vn_cnt = vn_cnt; obj->f_cnt = f_cnt;
   obj->v_cap = v_cnt; obj->vt_cap = vt_cnt; obj->f_cap = f_cnt;
 
   size_t path_len = strlen(filename) + 1;
-  obj->src_path = (const char*)sf_arena_alloc(ctx, &ctx->arena, path_len);
+  obj->src_path = (const char*)sf_heap_alloc(ctx, path_len);
   if (obj->src_path) memcpy((void*)obj->src_path, filename, path_len);
 
-  obj->v  = sf_arena_alloc(ctx, &ctx->arena, v_cnt * sizeof(sf_fvec3_t));
-  obj->vt = sf_arena_alloc(ctx, &ctx->arena, vt_cnt * sizeof(sf_fvec2_t));
-  obj->vn = sf_arena_alloc(ctx, &ctx->arena, vn_cnt * sizeof(sf_fvec3_t));
-  obj->f  = sf_arena_alloc(ctx, &ctx->arena, f_cnt * sizeof(sf_face_t));
+  obj->v  = sf_heap_alloc(ctx, v_cnt * sizeof(sf_fvec3_t));
+  obj->vt = sf_heap_alloc(ctx, vt_cnt * sizeof(sf_fvec2_t));
+  obj->vn = sf_heap_alloc(ctx, vn_cnt * sizeof(sf_fvec3_t));
+  obj->f  = sf_heap_alloc(ctx, f_cnt * sizeof(sf_face_t));
 
   size_t name_len = strlen(objname) + 1;
-  obj->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  obj->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (obj->name) {
     memcpy((void*)obj->name, objname, name_len);
+    _sf_names_put(ctx, &ctx->names[SF_NAME_OBJ], obj->name, obj);
   }
   obj->id = ctx->obj_count - 1;
 
   if (!obj->v || !obj->f || !obj->name) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "out of arena memory for %s\n", filename);
-    fclose(file);
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "out of memory for %s\n", filename);
+    _sf_names_del(&ctx->names[SF_NAME_OBJ], obj->name, obj);
+    ctx->obj_count--;
+    _sf_obj_release(ctx, obj);
+    free(lines);
+    free(text);
     return NULL;
   }
 
@@ -1823,45 +3919,27 @@ sf_obj_t* sf_load_obj(sf_ctx_t *ctx, const char *filename, const char *objname)
               SF_LOG_INDENT "size   : %zu\n"
               SF_LOG_INDENT "used   : %d/%d\n",
               filename, objname, obj->id, v_cnt, vt_cnt, vn_cnt, f_cnt,
-              _sf_obj_memusg(obj), ctx->obj_count, SF_MAX_OBJS);
+              _sf_obj_memusg(obj), ctx->obj_count, ctx->obj_cap);
 
-  rewind(file);
-  int v_idx = 0, vt_idx = 0, vn_idx = 0, f_idx = 0;
-  while (fgets(line, sizeof(line), file)) {
-    if (line[0] == 'v' && line[1] == ' ') {
-      sscanf(line, "v %f %f %f", &obj->v[v_idx].x, &obj->v[v_idx].y, &obj->v[v_idx].z);
-      v_idx++;
-    }
-    else if (line[0] == 'v' && line[1] == 't' && line[2] == ' ') {
-      sscanf(line, "vt %f %f", &obj->vt[vt_idx].x, &obj->vt[vt_idx].y);
-      vt_idx++;
-    }
-    else if (line[0] == 'v' && line[1] == 'n' && line[2] == ' ') {
-      sscanf(line, "vn %f %f %f", &obj->vn[vn_idx].x, &obj->vn[vn_idx].y, &obj->vn[vn_idx].z);
-      vn_idx++;
-    }
-    else if (line[0] == 'f' && line[1] == ' ') {
-      int v[3] = {0}, vt[3] = {0}, vn[3] = {0};
-      char t1[32], t2[32], t3[32];
-      if (sscanf(line, "f %31s %31s %31s", t1, t2, t3) == 3) {
-        sscanf(t1, "%d/%d/%d", &v[0], &vt[0], &vn[0]);
-        if (strstr(t1, "//")) sscanf(t1, "%d//%d", &v[0], &vn[0]);
-
-        sscanf(t2, "%d/%d/%d", &v[1], &vt[1], &vn[1]);
-        if (strstr(t2, "//")) sscanf(t2, "%d//%d", &v[1], &vn[1]);
-
-        sscanf(t3, "%d/%d/%d", &v[2], &vt[2], &vn[2]);
-        if (strstr(t3, "//")) sscanf(t3, "%d//%d", &v[2], &vn[2]);
+  int v_idx = 0, vt_idx = v_cnt, vn_idx = v_cnt + vt_cnt, f_idx = v_cnt + vt_cnt + vn_cnt;
+  int n_all = v_cnt + vt_cnt + vn_cnt + f_cnt;
+  for (char *line = text; line < end; line += strlen(line) + 1) {
+    if      (line[0] == 'v' && line[1] == ' ' && v_idx < v_cnt) lines[v_idx++] = line;
+    else if (line[0] == 'v' && line[1] == 't' && line[2] == ' ' && vt_idx < v_cnt + vt_cnt) lines[vt_idx++] = line;
+    else if (line[0] == 'v' && line[1] == 'n' && line[2] == ' ' && vn_idx < v_cnt + vt_cnt + vn_cnt) lines[vn_idx++] = line;
+    else if (line[0] == 'f' && line[1] == ' ' && f_idx < n_all) lines[f_idx++] = line;
+  }
+  sf_obj_ld_t ld = { obj, lines, v_cnt, vt_cnt, vn_cnt };
+  sf_jobs_parallel_for(ctx, v_cnt + vt_cnt + vn_cnt + f_cnt, 1024, _sf_load_obj_lines, &ld);
+  free(lines);
+  free(text);
 
-        for (int i = 0; i < 3; i++) {
-          obj->f[f_idx].idx[i].v  = v[i] > 0 ? v[i] - 1 : -1;
-          obj->f[f_idx].idx[i].vt = vt[i] > 0 ? vt[i] - 1 : -1;
-          obj->f[f_idx].idx[i].vn = vn[i] > 0 ? vn[i] - 1 : -1;
-        }
-        f_idx++;
-      }
-    }
+  int f_ok = 0;
+  for (int i = 0; i < f_cnt; i++) {
+    if (obj->f[i].idx[0].v == -2) continue;
+    obj->f[f_ok++] = obj->f[i];
   }
+  obj->f_cnt = f_ok;
 
   sf_fvec3_t bs_c = {0.0f, 0.0f, 0.0f};
   for (int i = 0; i < v_cnt; i++) {
@@ -1881,15 +3959,51 @@ sf_obj_t* sf_load_obj(sf_ctx_t *ctx, const char *filename, const char *objname)
   }
   obj->bs_center = bs_c;
   obj->bs_radius = sqrtf(bs_r2);
-
-  fclose(file);
+  sf_obj_weld(ctx, obj);
   return obj;
 }
 
+void _sf_load_obj_lines(sf_ctx_t *ctx, void *user, int i0, int i1, int worker) {
+  /* sf_load_obj job body: parse lines [i0, i1) of the sf_obj_ld_t index; bad faces are marked with v = -2. */
+  (void)ctx; (void)worker;
+  sf_obj_ld_t *ld  = (sf_obj_ld_t*)user;
+  sf_obj_t    *obj = ld->obj;
+  int          vt0 = ld->n_v, vn0 = vt0 + ld->n_vt, f0 = vn0 + ld->n_vn;
+  for (int li = i0; li < i1; li++) {
+    const char *line = ld->lines[li];
+    if (li < vt0) {
+      sscanf(line, "v %f %f %f", &obj->v[li].x, &obj->v[li].y, &obj->v[li].z);
+    } else if (li < vn0) {
+      sscanf(line, "vt %f %f", &obj->vt[li - vt0].x, &obj->vt[li - vt0].y);
+    } else if (li < f0) {
+      sscanf(line, "vn %f %f %f", &obj->vn[li - vn0].x, &obj->vn[li - vn0].y, &obj->vn[li - vn0].z);
+    } else {
+      sf_face_t *face = &obj->f[li - f0];
+      int v[3] = {0}, vt[3] = {0}, vn[3] = {0};
+      char t1[32], t2[32], t3[32];
+      if (sscanf(line, "f %31s %31s %31s", t1, t2, t3) != 3) { face->idx[0].v = -2; continue; }
+      sscanf(t1, "%d/%d/%d", &v[0], &vt[0], &vn[0]);
+      if (strstr(t1, "//")) sscanf(t1, "%d//%d", &v[0], &vn[0]);
+
+      sscanf(t2, "%d/%d/%d", &v[1], &vt[1], &vn[1]);
+      if (strstr(t2, "//")) sscanf(t2, "%d//%d", &v[1], &vn[1]);
+
+      sscanf(t3, "%d/%d/%d", &v[2], &vt[2], &vn[2]);
+      if (strstr(t3, "//")) sscanf(t3, "%d//%d", &v[2], &vn[2]);
+
+      for (int i = 0; i < 3; i++) {
+        face->idx[i].v  = v[i] > 0 ? v[i] - 1 : -1;
+        face->idx[i].vt = vt[i] > 0 ? vt[i] - 1 : -1;
+        face->idx[i].vn = vn[i] > 0 ? vn[i] - 1 : -1;
+      }
+    }
+  }
+}
+
 sf_skybox_t* sf_load_skybox(sf_ctx_t *ctx, const char *filename, const char *skyboxname) {
   /* Load an equirectangular BMP panorama as a skybox. The texture dimensions must be powers of two. */
-  if (ctx->skybox_count >= SF_MAX_SKYBOXES) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load skybox '%s', max (%d) reached\n", skyboxname, SF_MAX_SKYBOXES);
+  if (ctx->skybox_count >= ctx->skybox_cap) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to load skybox '%s', max (%d) reached\n", skyboxname, ctx->skybox_cap);
     return NULL;
   }
   if (sf_get_skybox_(ctx, skyboxname, false) != NULL) {
@@ -1902,14 +4016,15 @@ sf_skybox_t* sf_load_skybox(sf_ctx_t *ctx, const char *filename, const char *sky
   sb->id            = ctx->skybox_count - 1;
   sb->tex           = tex;
   size_t name_len   = strlen(skyboxname) + 1;
-  sb->name          = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  sb->name          = (const char*)sf_heap_alloc(ctx, name_len);
   if (sb->name) memcpy((void*)sb->name, skyboxname, name_len);
+  _sf_names_put(ctx, &ctx->names[SF_NAME_SKYBOX], sb->name, sb);
   SF_LOG(ctx, SF_LOG_INFO,
               SF_LOG_INDENT "file   : %s\n"
               SF_LOG_INDENT "name   : %s\n"
               SF_LOG_INDENT "id     : %d\n"
               SF_LOG_INDENT "used   : %d/%d\n",
-              filename, skyboxname, sb->id, ctx->skybox_count, SF_MAX_SKYBOXES);
+              filename, skyboxname, sb->id, ctx->skybox_count, ctx->skybox_cap);
   return sb;
 }
 
@@ -1924,25 +4039,25 @@ sf_emitr_t* sf_add_emitr(sf_ctx_t *ctx, const char *emitrname, sf_emitr_type_t t
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to add emitter '%s', name in use\n", emitrname);
     return NULL;
   }
-  if (ctx->emitr_count >= SF_MAX_EMITRS) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to add emitter '%s', max (%d) reached\n", emitrname, SF_MAX_EMITRS);
-    return NULL;
-  }
 
-  sf_emitr_t *em = &ctx->emitrs[ctx->emitr_count++];
-  memset(em, 0, sizeof(sf_emitr_t));
+  sf_emitr_t *em = (sf_emitr_t*)sf_pool_add(ctx, &ctx->emitr_pool);
+  if (!em) return NULL;
+  ctx->emitrs      = (sf_emitr_t**)ctx->emitr_pool.items;
+  ctx->emitr_count = ctx->emitr_pool.count;
   em->id = ctx->emitr_count - 1;
   em->type = type;
   em->sprite = sprite;
   em->max_particles = max_p;
-  em->particles = sf_arena_alloc(ctx, &ctx->arena, max_p * sizeof(sf_particle_t));
+  em->layers = SF_LAYER_DEFAULT;
+  em->particles = sf_heap_alloc(ctx, max_p * sizeof(sf_particle_t));
   em->frame = sf_add_frame(ctx, NULL);
 
   size_t name_len = strlen(emitrname) + 1;
-  em->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  em->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (em->name) {
     memcpy((void*)em->name, emitrname, name_len);
     if (em->frame) em->frame->name = em->name;
+    _sf_names_put(ctx, &ctx->names[SF_NAME_EMITR], em->name, em);
   }
 
   em->spawn_rate = 10.0f; 
@@ -1957,8 +4072,8 @@ sf_emitr_t* sf_add_emitr(sf_ctx_t *ctx, const char *emitrname, sf_emitr_type_t t
               SF_LOG_INDENT "id     : %d\n"
               SF_LOG_INDENT "type   : %s\n"
               SF_LOG_INDENT "max_p  : %d\n"
-              SF_LOG_INDENT "used   : %d/%d\n",
-              em->name, em->id, type == SF_EMITR_DIR ? "dir" : type == SF_EMITR_VOLUME ? "volume" : "omni", max_p, ctx->emitr_count, SF_MAX_EMITRS);
+              SF_LOG_INDENT "used   : %d\n",
+              em->name, em->id, type == SF_EMITR_DIR ? "dir" : type == SF_EMITR_VOLUME ? "volume" : "omni", max_p, ctx->emitr_count);
   return em;
 }
 
@@ -1978,30 +4093,32 @@ sf_enti_t* sf_add_enti(sf_ctx_t *ctx, sf_obj_t *obj, const char *entiname) {
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to add entity '%s', name in use\n", entiname);
     return NULL;
   }
-  if (ctx->enti_count >= SF_MAX_ENTITIES) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to add entity, max (%d) reached\n", SF_MAX_ENTITIES);
-    return NULL;
-  }
 
-  sf_enti_t *enti = &ctx->entities[ctx->enti_count++];
+  sf_enti_t *enti = (sf_enti_t*)sf_pool_add(ctx, &ctx->enti_pool);
+  if (!enti) return NULL;
+  ctx->entities   = (sf_enti_t**)ctx->enti_pool.items;
+  ctx->enti_count = ctx->enti_pool.count;
   enti->obj       = *obj;
   enti->id        = ctx->enti_count - 1;
   enti->tex       = NULL;
   enti->tex_scale = (sf_fvec2_t){1.0f, 1.0f};
   enti->frame     = sf_add_frame(ctx, NULL);
+  enti->layers    = SF_LAYER_DEFAULT;
+  ctx->_scene_gen++;
 
   size_t name_len = strlen(entiname) + 1;
-  enti->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  enti->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (enti->name) {
     memcpy((void*)enti->name, entiname, name_len);
     if (enti->frame) enti->frame->name = enti->name;
+    _sf_names_put(ctx, &ctx->names[SF_NAME_ENTI], enti->name, enti);
   }
 
   SF_LOG(ctx, SF_LOG_INFO,
               SF_LOG_INDENT "enti   : %s (id %d)\n"
               SF_LOG_INDENT "obj    : %s (id %d)\n"
-              SF_LOG_INDENT "used   : %d/%d\n",
-              enti->name, enti->id, enti->obj.name, enti->obj.id, ctx->enti_count, SF_MAX_ENTITIES);
+              SF_LOG_INDENT "used   : %d\n",
+              enti->name, enti->id, enti->obj.name, enti->obj.id, ctx->enti_count);
 
   return enti;
 }
@@ -2027,20 +4144,25 @@ sf_cam_t* sf_add_cam(sf_ctx_t *ctx, const char *camname, int w, int h, float fov
   cam->w                 = w;
   cam->h                 = h;
   cam->buffer_size       = w * h;
+  cam->stride            = w;
   cam->buffer            = (sf_pkd_clr_t*) malloc(w * h * sizeof(sf_pkd_clr_t));
   cam->z_buffer          = (float*)        malloc(w * h * sizeof(float));
   cam->fov               = fov;
   cam->near_plane        = 0.1f;
   cam->far_plane         = 100.0f;
   cam->is_proj_dirty     = true;
+  cam->cull_mask         = SF_LAYER_ALL;
+  cam->features          = SF_CAM_ALL;
+  cam->res_scale         = 1.0f;
   cam->id                = ctx->cam_count - 1;
   cam->frame             = sf_add_frame(ctx, NULL);
 
   size_t name_len = strlen(camname) + 1;
-  cam->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  cam->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (cam->name) {
     memcpy((void*)cam->name, camname, name_len);
     if (cam->frame) cam->frame->name = cam->name;
+    _sf_names_put(ctx, &ctx->names[SF_NAME_CAM], cam->name, cam);
   }
 
   SF_LOG(ctx, SF_LOG_INFO,
@@ -2067,12 +4189,11 @@ sf_light_t* sf_add_light(sf_ctx_t *ctx, const char *lightname, sf_light_type_t t
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to add light '%s', name in use\n", lightname);
     return NULL;
   }
-  if (ctx->light_count >= SF_MAX_LIGHTS) {
-    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to add light '%s', max (%d) reached\n", lightname, SF_MAX_LIGHTS);
-    return NULL;
-  }
 
-  sf_light_t *l = &ctx->lights[ctx->light_count++];
+  sf_light_t *l = (sf_light_t*)sf_pool_add(ctx, &ctx->light_pool);
+  if (!l) return NULL;
+  ctx->lights      = (sf_light_t**)ctx->light_pool.items;
+  ctx->light_count = ctx->light_pool.count;
   l->type      = type;
   l->color     = color;
   l->intensity = intensity;
@@ -2080,10 +4201,11 @@ sf_light_t* sf_add_light(sf_ctx_t *ctx, const char *lightname, sf_light_type_t t
   l->frame     = sf_add_frame(ctx, NULL);
 
   size_t name_len = strlen(lightname) + 1;
-  l->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  l->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (l->name) {
     memcpy((void*)l->name, lightname, name_len);
     if (l->frame) l->frame->name = l->name;
+    _sf_names_put(ctx, &ctx->names[SF_NAME_LIGHT], l->name, l);
   }
 
   SF_LOG(ctx, SF_LOG_INFO,
@@ -2092,19 +4214,16 @@ sf_light_t* sf_add_light(sf_ctx_t *ctx, const char *lightname, sf_light_type_t t
               SF_LOG_INDENT "type   : %s\n"
               SF_LOG_INDENT "color  : %.2f %.2f %.2f\n"
               SF_LOG_INDENT "intens : %.2f\n"
-              SF_LOG_INDENT "used   : %d/%d\n",
+              SF_LOG_INDENT "used   : %d\n",
               l->name, l->id, type == SF_LIGHT_DIR ? "dir" : "point",
-              color.x, color.y, color.z, intensity, ctx->light_count, SF_MAX_LIGHTS);
+              color.x, color.y, color.z, intensity, ctx->light_count);
   return l;
 }
 
 sf_tex_t* sf_get_texture_(sf_ctx_t *ctx, const char *texname, bool should_log_failure) {
-  /* Linear search for a texture by name; use the sf_get_texture() macro instead. */
-  for (int32_t i = 0; i < ctx->tex_count; ++i) {
-    if (ctx->textures[i].name && strcmp(ctx->textures[i].name, texname) == 0) {
-      return &ctx->textures[i];
-    }
-  }
+  /* Hashed lookup of a texture by name; use the sf_get_texture() macro instead. */
+  sf_tex_t *tex = (sf_tex_t*)_sf_names_find(&ctx->names[SF_NAME_TEX], texname);
+  if (tex) return tex;
   if (should_log_failure) {
     SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "texture '%s' not found\n", texname);
   }
@@ -2112,35 +4231,25 @@ sf_tex_t* sf_get_texture_(sf_ctx_t *ctx, const char *texname, bool should_log_fa
 }
 
 sf_sprite_2_t* sf_get_sprite_(sf_ctx_t *ctx, const char *spritename, bool should_log_failure) {
-  /* Linear search for a sprite by name; use the sf_get_sprite() macro instead. */
-  for (int32_t i = 0; i < ctx->sprite_count; ++i) {
-    if (ctx->sprites[i].name && strcmp(ctx->sprites[i].name, spritename) == 0) {
-      return &ctx->sprites[i];
-    }
-  }
+  /* Hashed lookup of a sprite by name; use the sf_get_sprite() macro instead. */
+  sf_sprite_2_t *spr = (sf_sprite_2_t*)_sf_names_find(&ctx->names[SF_NAME_SPRITE], spritename);
+  if (spr) return spr;
   if (should_log_failure) SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "sprite '%s' not found\n", spritename);
   return NULL;
 }
 
 sf_emitr_t* sf_get_emitr_(sf_ctx_t *ctx, const char *emitrname, bool should_log_failure) {
-  /* Linear search for an emitter by name; use the sf_get_emitr() macro instead. */
-  for (int32_t i = 0; i < ctx->emitr_count; ++i) {
-    if (ctx->emitrs[i].name && strcmp(ctx->emitrs[i].name, emitrname) == 0) {
-      return &ctx->emitrs[i];
-    }
-  }
+  /* Hashed lookup of an emitter by name; use the sf_get_emitr() macro instead. */
+  sf_emitr_t *em = (sf_emitr_t*)_sf_names_find(&ctx->names[SF_NAME_EMITR], emitrname);
+  if (em) return em;
   if (should_log_failure) SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "emitter '%s' not found\n", emitrname);
   return NULL;
 }
 
 sf_obj_t* sf_get_obj_(sf_ctx_t *ctx, const char *objname, bool should_log_failure) {
-  /* Linear search for a mesh by name; use the sf_get_obj() macro instead. */
-  for (int32_t i = 0; i < ctx->obj_count; ++i) {
-    if (ctx->objs[i].name && strcmp(ctx->objs[i].name, objname) == 0) {
-      return &ctx->objs[i];
-    }
-  }
- 
+  /* Hashed lookup of a mesh by name; use the sf_get_obj() macro instead. */
+  sf_obj_t *obj = (sf_obj_t*)_sf_names_find(&ctx->names[SF_NAME_OBJ], objname);
+  if (obj) return obj;
   if (should_log_failure) {
     SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "object '%s' not found\n", objname);
   }
@@ -2148,13 +4257,9 @@ sf_obj_t* sf_get_obj_(sf_ctx_t *ctx, const char *objname, bool should_log_failur
 }
 
 sf_enti_t* sf_get_enti_(sf_ctx_t *ctx, const char *entiname, bool should_log_failure) {
-  /* Linear search for an entity by name; use the sf_get_enti() macro instead. */
-  for (int32_t i = 0; i < ctx->enti_count; ++i) {
-    if (ctx->entities[i].name && strcmp(ctx->entities[i].name, entiname) == 0) {
-      return &ctx->entities[i];
-    }
-  }
-
+  /* Hashed lookup of an entity by name; use the sf_get_enti() macro instead. */
+  sf_enti_t *enti = (sf_enti_t*)_sf_names_find(&ctx->names[SF_NAME_ENTI], entiname);
+  if (enti) return enti;
   if (should_log_failure) {
     SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "entity '%s' not found\n", entiname);
   }
@@ -2163,62 +4268,186 @@ sf_enti_t* sf_get_enti_(sf_ctx_t *ctx, const char *entiname, bool should_log_fai
 }
 
 sf_cam_t* sf_get_cam_(sf_ctx_t *ctx, const char *camname, bool should_log_failure) {
-  /* Linear search for a camera by name; use the sf_get_cam() macro instead. */
-  for (int32_t i = 0; i < ctx->cam_count; ++i) {
-    if (ctx->cameras[i].name && strcmp(ctx->cameras[i].name, camname) == 0) {
-      return &ctx->cameras[i];
-    }
-  }
+  /* Hashed lookup of a camera by name; use the sf_get_cam() macro instead. */
+  sf_cam_t *cam = (sf_cam_t*)_sf_names_find(&ctx->names[SF_NAME_CAM], camname);
+  if (cam) return cam;
   if (should_log_failure) {
     SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "camera '%s' not found\n", camname);
   }
   return NULL;
 }
 
-sf_light_t* sf_get_light_(sf_ctx_t *ctx, const char *lightname, bool should_log_failure) {
-  /* Linear search for a light by name; use the sf_get_light() macro instead. */
-  for (int32_t i = 0; i < ctx->light_count; ++i) {
-    if (ctx->lights[i].name && strcmp(ctx->lights[i].name, lightname) == 0) {
-      return &ctx->lights[i];
+sf_light_t* sf_get_light_(sf_ctx_t *ctx, const char *lightname, bool should_log_failure) {
+  /* Hashed lookup of a light by name; use the sf_get_light() macro instead. */
+  sf_light_t *l = (sf_light_t*)_sf_names_find(&ctx->names[SF_NAME_LIGHT], lightname);
+  if (l) return l;
+  if (should_log_failure) SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "light '%s' not found\n", lightname);
+  return NULL;
+}
+
+sf_skybox_t* sf_get_skybox_(sf_ctx_t *ctx, const char *skyboxname, bool should_log_failure) {
+  /* Hashed lookup of a skybox by name; use the sf_get_skybox() macro instead. */
+  sf_skybox_t *sb = (sf_skybox_t*)_sf_names_find(&ctx->names[SF_NAME_SKYBOX], skyboxname);
+  if (sb) return sb;
+  if (should_log_failure) {
+    SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "skybox '%s' not found\n", skyboxname);
+  }
+  return NULL;
+}
+
+bool sf_rename(sf_ctx_t *ctx, sf_name_kind_t kind, void *item, const char *name) {
+  /* Rename an object of the given kind (and the frame sharing its name) and keep the name index in step.
+   * Fails if another object of that kind already has the name. */
+  if (!ctx || !item || !name || kind < 0 || kind >= SF_NAME_MAX) return false;
+  const char **slot = NULL;
+  sf_frame_t  *fr   = NULL;
+  switch (kind) {
+    case SF_NAME_OBJ:    slot = &((sf_obj_t*)item)->name;                                              break;
+    case SF_NAME_ENTI:   slot = &((sf_enti_t*)item)->name;     fr = ((sf_enti_t*)item)->frame;        break;
+    case SF_NAME_TEX:    slot = &((sf_tex_t*)item)->name;                                              break;
+    case SF_NAME_CAM:    slot = &((sf_cam_t*)item)->name;      fr = ((sf_cam_t*)item)->frame;         break;
+    case SF_NAME_LIGHT:  slot = &((sf_light_t*)item)->name;    fr = ((sf_light_t*)item)->frame;       break;
+    case SF_NAME_SPRITE: slot = &((sf_sprite_2_t*)item)->name;                                         break;
+    case SF_NAME_EMITR:  slot = &((sf_emitr_t*)item)->name;    fr = ((sf_emitr_t*)item)->frame;       break;
+    case SF_NAME_SKYBOX: slot = &((sf_skybox_t*)item)->name;                                           break;
+    case SF_NAME_FRAME:  slot = &((sf_frame_t*)item)->name;                                            break;
+    default: return false;
+  }
+  void *other = _sf_names_find(&ctx->names[kind], name);
+  if (other == item) return true;
+  if (other) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to rename '%s' to '%s', name in use\n", *slot ? *slot : "(null)", name);
+    return false;
+  }
+  size_t n   = strlen(name) + 1;
+  char  *mem = (char*)sf_heap_alloc(ctx, n);
+  if (!mem) return false;
+  memcpy(mem, name, n);
+  const char *old   = *slot;
+  bool        owned = kind != SF_NAME_FRAME || _sf_names_find(&ctx->names[kind], old) == item;
+  _sf_names_del(&ctx->names[kind], old, item);
+  if (fr && fr->name == old) fr->name = mem;
+  if (kind == SF_NAME_OBJ) {
+    for (int i = 0; i < ctx->enti_count; i++) {
+      if (ctx->entities[i]->obj.name == old) ctx->entities[i]->obj.name = mem;
+    }
+  }
+  *slot = mem;
+  if (owned) sf_heap_free(ctx, old);
+  return _sf_names_put(ctx, &ctx->names[kind], mem, item);
+}
+
+uint32_t _sf_names_hash(const char *s) {
+  /* 32-bit FNV-1a of a NUL-terminated name. */
+  uint32_t h = 2166136261u;
+  while (*s) { h ^= (uint8_t)*s++; h *= 16777619u; }
+  return h;
+}
+
+void* _sf_names_find(const sf_names_t *n, const char *name) {
+  /* Item registered under name, or NULL. Linear probing; the table is never more than 3/4 full. */
+  if (!name || !n->cap) return NULL;
+  uint32_t h    = _sf_names_hash(name);
+  int32_t  mask = n->cap - 1;
+  for (int32_t i = (int32_t)h & mask; n->ents[i].key; i = (i + 1) & mask) {
+    const sf_name_ent_t *e = &n->ents[i];
+    if (e->item && e->hash == h && strcmp(e->key, name) == 0) return e->item;
+  }
+  return NULL;
+}
+
+bool _sf_names_put(sf_ctx_t *ctx, sf_names_t *n, const char *name, void *item) {
+  /* Point name at item, replacing any previous entry. The index keeps its own copy of name, so the caller's string
+   * may change or be freed afterwards. Rehashes into a table at most half full when 3/4 of the slots are used. */
+  if (!name || !item) return false;
+  if ((n->used + 1) * 4 > n->cap * 3) {
+    int32_t cap = 16;
+    while (cap < (n->count + 1) * 2) cap *= 2;
+    sf_name_ent_t *ents = (sf_name_ent_t*)calloc((size_t)cap, sizeof(sf_name_ent_t));
+    if (!ents) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to index name '%s', out of memory\n", name);
+      return false;
+    }
+    for (int32_t i = 0; i < n->cap; i++) {
+      if (!n->ents[i].item) continue;
+      int32_t k = (int32_t)n->ents[i].hash & (cap - 1);
+      while (ents[k].key) k = (k + 1) & (cap - 1);
+      ents[k] = n->ents[i];
+    }
+    free(n->ents);
+    n->ents = ents;
+    n->cap  = cap;
+    n->used = n->count;
+  }
+  uint32_t       h    = _sf_names_hash(name);
+  int32_t        mask = n->cap - 1;
+  sf_name_ent_t *tomb = NULL;
+  int32_t        i    = (int32_t)h & mask;
+  for (; n->ents[i].key; i = (i + 1) & mask) {
+    sf_name_ent_t *e = &n->ents[i];
+    if (!e->item) { if (!tomb) tomb = e; continue; }
+    if (e->hash == h && strcmp(e->key, name) == 0) { e->item = item; return true; }
+  }
+  size_t len = strlen(name) + 1;
+  char  *key = (char*)malloc(len);
+  if (!key) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to index name '%s', out of memory\n", name);
+    return false;
+  }
+  memcpy(key, name, len);
+  sf_name_ent_t *e = tomb ? tomb : &n->ents[i];
+  if (!tomb) n->used++;
+  *e = (sf_name_ent_t){ h, key, item };
+  n->count++;
+  return true;
+}
+
+void _sf_names_del(sf_names_t *n, const char *name, const void *item) {
+  /* Drop name's entry if it still points at item, leaving a tombstone so later probes keep going. */
+  if (!name || !n->cap) return;
+  uint32_t h    = _sf_names_hash(name);
+  int32_t  mask = n->cap - 1;
+  for (int32_t i = (int32_t)h & mask; n->ents[i].key; i = (i + 1) & mask) {
+    sf_name_ent_t *e = &n->ents[i];
+    if (e->item && e->hash == h && strcmp(e->key, name) == 0) {
+      if (e->item == item) { free((void*)e->key); e->key = ""; e->item = NULL; n->count--; }
+      return;
     }
   }
-  if (should_log_failure) SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "light '%s' not found\n", lightname);
-  return NULL;
 }
 
-sf_skybox_t* sf_get_skybox_(sf_ctx_t *ctx, const char *skyboxname, bool should_log_failure) {
-  /* Linear search for a skybox by name; use the sf_get_skybox() macro instead. */
-  for (int32_t i = 0; i < ctx->skybox_count; ++i) {
-    if (ctx->skyboxes[i].name && strcmp(ctx->skyboxes[i].name, skyboxname) == 0) {
-      return &ctx->skyboxes[i];
-    }
-  }
-  if (should_log_failure) {
-    SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "skybox '%s' not found\n", skyboxname);
+void _sf_names_free(sf_names_t *n) {
+  /* Release a name index and its key copies. */
+  for (int32_t i = 0; i < n->cap; i++) {
+    if (n->ents[i].item) free((void*)n->ents[i].key);
   }
-  return NULL;
+  free(n->ents);
+  memset(n, 0, sizeof(sf_names_t));
 }
 
 void sf_remove_enti(sf_ctx_t *ctx, sf_enti_t *enti) {
   /* Remove an entity and its frame from the scene. */
-  if (!ctx || !enti) return;
-  int idx = (int)(enti - ctx->entities);
-  if (idx < 0 || idx >= ctx->enti_count) return;
+  if (!ctx || !enti || !sf_pool_remove(&ctx->enti_pool, enti)) return;
+  ctx->_scene_gen++;
+  _sf_names_del(&ctx->names[SF_NAME_ENTI], enti->name, enti);
+  ctx->enti_count = ctx->enti_pool.count;
   if (enti->frame) sf_remove_frame(ctx, enti->frame);
-  ctx->entities[idx] = ctx->entities[--ctx->enti_count];
   SF_LOG(ctx, SF_LOG_INFO,
               SF_LOG_INDENT "name   : %s\n"
               SF_LOG_INDENT "remain : %d\n",
               enti->name ? enti->name : "(null)", ctx->enti_count);
+  _sf_obj_release(ctx, &enti->obj);
+  sf_heap_free(ctx, enti->name);
 }
 
 void sf_remove_light(sf_ctx_t *ctx, sf_light_t *light) {
   /* Remove a light and its frame from the scene. */
-  if (!ctx || !light) return;
-  int idx = (int)(light - ctx->lights);
-  if (idx < 0 || idx >= ctx->light_count) return;
+  if (!ctx || !light || !sf_pool_remove(&ctx->light_pool, light)) return;
+  ctx->_scene_gen++;
+  _sf_names_del(&ctx->names[SF_NAME_LIGHT], light->name, light);
+  ctx->light_count = ctx->light_pool.count;
   if (light->frame) sf_remove_frame(ctx, light->frame);
-  ctx->lights[idx] = ctx->lights[--ctx->light_count];
+  sf_heap_free(ctx, light->name);
 }
 
 void sf_remove_cam(sf_ctx_t *ctx, sf_cam_t *cam) {
@@ -2226,28 +4455,73 @@ void sf_remove_cam(sf_ctx_t *ctx, sf_cam_t *cam) {
   if (!ctx || !cam || cam == &ctx->main_camera) return;
   int idx = (int)(cam - ctx->cameras);
   if (idx < 0 || idx >= ctx->cam_count) return;
+  sf_render_sync(ctx);
+  free(cam->_back_px);
+  free(cam->_od_px);
+  _sf_dyn_res_free(cam);
+  _sf_roi_free(cam);
   if (cam->frame) sf_remove_frame(ctx, cam->frame);
+  _sf_names_del(&ctx->names[SF_NAME_CAM], cam->name, cam);
+  sf_heap_free(ctx, cam->name);
   ctx->cameras[idx] = ctx->cameras[--ctx->cam_count];
+  if (idx < ctx->cam_count) _sf_names_put(ctx, &ctx->names[SF_NAME_CAM], ctx->cameras[idx].name, &ctx->cameras[idx]);
 }
 
 void sf_remove_emitr(sf_ctx_t *ctx, sf_emitr_t *emitr) {
   /* Remove an emitter and its frame from the scene. */
-  if (!ctx || !emitr) return;
-  int idx = (int)(emitr - ctx->emitrs);
-  if (idx < 0 || idx >= ctx->emitr_count) return;
+  if (!ctx || !emitr || !sf_pool_remove(&ctx->emitr_pool, emitr)) return;
+  _sf_names_del(&ctx->names[SF_NAME_EMITR], emitr->name, emitr);
+  ctx->emitr_count = ctx->emitr_pool.count;
   if (emitr->frame) sf_remove_frame(ctx, emitr->frame);
-  ctx->emitrs[idx] = ctx->emitrs[--ctx->emitr_count];
+  sf_render_sync(ctx);
+  sf_heap_free(ctx, emitr->particles);
+  sf_heap_free(ctx, emitr->name);
+  emitr->particles = NULL;
 }
 
 void sf_remove_obj(sf_ctx_t *ctx, sf_obj_t *obj) {
-  /* Remove a mesh object from the scene if no entities reference it. */
+  /* Remove a mesh object from the scene. Entities keep drawing their copy; the mesh memory is reclaimed once
+   * the last of them is removed or given another mesh. */
   if (!ctx || !obj) return;
   int idx = (int)(obj - ctx->objs);
   if (idx < 0 || idx >= ctx->obj_count) return;
-  for (int i = 0; i < ctx->enti_count; i++) {
-    if (&ctx->entities[i].obj == obj) return;
-  }
+  sf_obj_t gone = *obj;
+  ctx->_scene_gen++;
+  _sf_names_del(&ctx->names[SF_NAME_OBJ], obj->name, obj);
   ctx->objs[idx] = ctx->objs[--ctx->obj_count];
+  if (idx < ctx->obj_count) _sf_names_put(ctx, &ctx->names[SF_NAME_OBJ], ctx->objs[idx].name, &ctx->objs[idx]);
+  _sf_obj_release(ctx, &gone);
+}
+
+void _sf_obj_release(sf_ctx_t *ctx, const sf_obj_t *mesh) {
+  /* Return a mesh's arrays, name and source path to the heap unless a listed obj or an entity still shares
+   * them. Waits for any frame in flight first, since its snapshot may still be reading the arrays. */
+  if (mesh->v || mesh->f || mesh->weld) {
+    for (int i = 0; i < ctx->obj_count; i++) {
+      const sf_obj_t *o = &ctx->objs[i];
+      if (o->v == mesh->v && o->f == mesh->f && (mesh->f || o->weld == mesh->weld)) return;
+    }
+    for (int i = 0; i < ctx->enti_count; i++) {
+      const sf_obj_t *o = &ctx->entities[i]->obj;
+      if (o->v == mesh->v && o->f == mesh->f && (mesh->f || o->weld == mesh->weld)) return;
+    }
+  }
+  sf_render_sync(ctx);
+  sf_heap_free(ctx, mesh->v);
+  sf_heap_free(ctx, mesh->vt);
+  sf_heap_free(ctx, mesh->vn);
+  sf_heap_free(ctx, mesh->f);
+  sf_heap_free(ctx, mesh->name);
+  sf_heap_free(ctx, mesh->src_path);
+  if (mesh->weld) {
+    sf_heap_free(ctx, mesh->weld->v);
+    sf_heap_free(ctx, mesh->weld->vt);
+    sf_heap_free(ctx, mesh->weld->idx16);
+    sf_heap_free(ctx, mesh->weld->idx32);
+    sf_heap_free(ctx, mesh->weld->qv);
+    sf_heap_free(ctx, mesh->weld->qt);
+    sf_heap_free(ctx, mesh->weld);
+  }
 }
 
 void sf_remove_tex(sf_ctx_t *ctx, sf_tex_t *tex) {
@@ -2255,31 +4529,43 @@ void sf_remove_tex(sf_ctx_t *ctx, sf_tex_t *tex) {
   if (!ctx || !tex) return;
   int idx = (int)(tex - ctx->textures);
   if (idx < 0 || idx >= ctx->tex_count) return;
+  sf_render_sync(ctx);
+  ctx->_scene_gen++;
+  _sf_names_del(&ctx->names[SF_NAME_TEX], tex->name, tex);
+  sf_heap_free(ctx, tex->px);
+  sf_heap_free(ctx, tex->name);
   ctx->textures[idx] = ctx->textures[--ctx->tex_count];
+  if (idx < ctx->tex_count) _sf_names_put(ctx, &ctx->names[SF_NAME_TEX], ctx->textures[idx].name, &ctx->textures[idx]);
 }
 
 void sf_remove_sprite(sf_ctx_t *ctx, sf_sprite_2_t *sprite) {
   /* Remove a sprite from the scene. */
-  if (!ctx || !sprite) return;
-  int idx = (int)(sprite - ctx->sprites);
-  if (idx < 0 || idx >= ctx->sprite_count) return;
-  ctx->sprites[idx] = ctx->sprites[--ctx->sprite_count];
+  if (!ctx || !sprite || !sf_pool_remove(&ctx->sprite_pool, sprite)) return;
+  ctx->_scene_gen++;
+  _sf_names_del(&ctx->names[SF_NAME_SPRITE], sprite->name, sprite);
+  ctx->sprite_count = ctx->sprite_pool.count;
+  sf_heap_free(ctx, sprite->name);
 }
 
 void sf_remove_skybox(sf_ctx_t *ctx, sf_skybox_t *skybox) {
   /* Remove a skybox from the scene; deactivates it if it was active. */
   if (!ctx || !skybox) return;
+  sf_render_sync(ctx);
   int idx = (int)(skybox - ctx->skyboxes);
   if (idx < 0 || idx >= ctx->skybox_count) return;
   if (ctx->active_skybox == skybox) {
     ctx->active_skybox = NULL;
     ctx->skybox_enabled = false;
   }
+  _sf_names_del(&ctx->names[SF_NAME_SKYBOX], skybox->name, skybox);
+  sf_heap_free(ctx, skybox->name);
   ctx->skyboxes[idx] = ctx->skyboxes[--ctx->skybox_count];
+  if (idx < ctx->skybox_count) _sf_names_put(ctx, &ctx->names[SF_NAME_SKYBOX], ctx->skyboxes[idx].name, &ctx->skyboxes[idx]);
 }
 
 void sf_set_fog(sf_ctx_t *ctx, sf_fvec3_t color, float start, float end) {
   /* Configure and enable fog.  Toggle off/on with ctx->fog_enabled = false/true. */
+  sf_render_sync(ctx);
   ctx->fog_color   = color;
   ctx->fog_start   = start;
   ctx->fog_end     = end;
@@ -2288,6 +4574,7 @@ void sf_set_fog(sf_ctx_t *ctx, sf_fvec3_t color, float start, float end) {
 
 void sf_set_active_skybox(sf_ctx_t *ctx, sf_skybox_t *skybox) {
   /* Set or clear the active skybox rendered behind all scene geometry. Pass NULL to disable. */
+  sf_render_sync(ctx);
   ctx->active_skybox = skybox;
   ctx->skybox_enabled = (skybox != NULL);
 }
@@ -2342,18 +4629,35 @@ void sf_enti_set_tex(sf_ctx_t *ctx, const char *entiname, const char *texname) {
   sf_tex_t *tex = sf_get_texture_(ctx, texname, true);
   if (enti && tex) {
     enti->tex = tex;
+    ctx->_scene_gen++;
   }
 }
 
+void sf_enti_set_obj(sf_ctx_t *ctx, sf_enti_t *enti, const sf_obj_t *obj) {
+  /* Give an entity a copy of obj's mesh, reclaiming its previous mesh if nothing else still uses it. */
+  if (!ctx || !enti || !obj) return;
+  sf_obj_t prev = enti->obj;
+  enti->obj     = *obj;
+  ctx->_scene_gen++;
+  _sf_obj_release(ctx, &prev);
+}
+
 void sf_obj_recenter(sf_obj_t *obj) {
-  /* Shift all vertices so the bounding-sphere center is at the origin. */
-  if (!obj || obj->v_cnt == 0) return;
+  /* Shift all vertices (and the welded copy, if any) so the bounding-sphere center is at the origin. */
+  if (!obj || (obj->v_cnt == 0 && !obj->weld)) return;
+  _sf_obj_touch(obj);
   sf_fvec3_t c = obj->bs_center;
   for (int i = 0; i < obj->v_cnt; i++) {
     obj->v[i].x -= c.x;
     obj->v[i].y -= c.y;
     obj->v[i].z -= c.z;
   }
+  if (obj->weld && obj->weld->qv) obj->weld->q_c = sf_fvec3_sub(obj->weld->q_c, c);
+  for (int i = 0; obj->weld && obj->weld->v && i < obj->weld->v_cnt; i++) {
+    obj->weld->v[i].x -= c.x;
+    obj->weld->v[i].y -= c.y;
+    obj->weld->v[i].z -= c.z;
+  }
   obj->bs_center = (sf_fvec3_t){0.0f, 0.0f, 0.0f};
 }
 
@@ -2374,7 +4678,7 @@ void sf_camera_set_pos(sf_ctx_t *ctx, sf_cam_t *cam, float x, float y, float z)
 void sf_camera_move_loc(sf_ctx_t *ctx, sf_cam_t *cam, float fwd, float right, float up) {
   /* Move a camera along its own local axes (forward, right, up). */
   if (!cam || !cam->frame) return;
-  sf_fmat4_t m = cam->frame->global_M;
+  sf_fmat43_t m = cam->frame->global_M;
   sf_fvec3_t m_fwd = {-m.m[2][0] * fwd, -m.m[2][1] * fwd, -m.m[2][2] * fwd};
   sf_fvec3_t m_rgt = { m.m[0][0] * right, m.m[0][1] * right, m.m[0][2] * right};
   sf_fvec3_t m_up  = { m.m[1][0] * up,  m.m[1][1] * up,  m.m[1][2] * up};
@@ -2399,6 +4703,200 @@ void sf_camera_add_yp(sf_ctx_t *ctx, sf_cam_t *cam, float yaw_offset, float pitc
   cam->frame->is_dirty = true;
 }
 
+bool sf_camera_set_depth(sf_ctx_t *ctx, sf_cam_t *cam, sf_depth_fmt_t fmt) {
+  /* Switch a camera's depth buffer format, reallocating it as 32-bit float or 16-bit linear storage. */
+  if (!cam) return false;
+  sf_render_sync(ctx);
+  if (cam->depth_fmt == fmt && (cam->z_buffer || cam->z_buffer16)) return true;
+  size_t n = (size_t)cam->w * (size_t)cam->h;
+  if (fmt == SF_DEPTH_U16) {
+    uint16_t *zq = (uint16_t*)malloc(n * sizeof(uint16_t));
+    if (!zq) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate 16-bit depth for '%s'\n", cam->name ? cam->name : "main");
+      return false;
+    }
+    free(cam->z_buffer);
+    free(cam->z_buffer16);
+    cam->z_buffer   = NULL;
+    cam->z_buffer16 = zq;
+  } else if (!cam->z_buffer) {
+    float *zb = (float*)malloc(n * sizeof(float));
+    if (!zb) {
+      SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate float depth for '%s'\n", cam->name ? cam->name : "main");
+      return false;
+    }
+    free(cam->z_buffer16);
+    cam->z_buffer16 = NULL;
+    cam->z_buffer   = zb;
+  }
+  cam->depth_fmt = fmt;
+  sf_clear_depth(ctx, cam);
+  return true;
+}
+
+bool sf_camera_set_pixfmt(sf_ctx_t *ctx, sf_cam_t *cam, sf_pixfmt_t fmt) {
+  /* Switch a camera's colour buffer to ARGB8888, RGB565 or 8-bit indexed; pixels are packed as they are written.
+   * An indexed camera without a palette gets RGB332 before the switch, so a failed palette leaves it unchanged. */
+  if (!cam) return false;
+  if (cam->pix_fmt == fmt && (cam->buffer || cam->buffer16 || cam->buffer8)) return true;
+  sf_render_sync(ctx);
+  if (cam->ext_px) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "cannot change pixel format of '%s' while it draws to an external target\n", cam->name ? cam->name : "main");
+    return false;
+  }
+  if (fmt == SF_PIXFMT_IDX8 && !cam->palette) {
+    sf_pkd_clr_t rgb332[256];
+    for (int i = 0; i < 256; i++) {
+      uint32_t r = ((i >> 5) & 7) * 255 / 7;
+      uint32_t g = ((i >> 2) & 7) * 255 / 7;
+      uint32_t b = ( i       & 3) * 255 / 3;
+      rgb332[i] = 0xFF000000u | (r << 16) | (g << 8) | b;
+    }
+    if (!sf_camera_set_pal(ctx, cam, rgb332)) return false;
+  }
+  size_t n    = (size_t)cam->w * (size_t)cam->h;
+  size_t bpp  = (fmt == SF_PIXFMT_IDX8) ? 1 : (fmt == SF_PIXFMT_RGB565) ? 2 : 4;
+  void  *px   = calloc(n, bpp);
+  if (!px) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate %zu bpp buffer for '%s'\n", bpp, cam->name ? cam->name : "main");
+    return false;
+  }
+  free(cam->buffer);
+  free(cam->buffer16);
+  free(cam->buffer8);
+  cam->buffer   = (fmt == SF_PIXFMT_ARGB8888) ? (sf_pkd_clr_t*)px : NULL;
+  cam->buffer16 = (fmt == SF_PIXFMT_RGB565)   ? (uint16_t*)px     : NULL;
+  cam->buffer8  = (fmt == SF_PIXFMT_IDX8)     ? (uint8_t*)px      : NULL;
+  cam->pix_fmt  = fmt;
+  sf_camera_refresh(ctx, cam);
+  return true;
+}
+
+bool sf_camera_set_pal(sf_ctx_t *ctx, sf_cam_t *cam, const sf_pkd_clr_t *pal) {
+  /* Set the 256-entry palette of an indexed camera and rebuild its RGB555 -> index nearest-colour table.
+   * The table is only rebuilt when the palette actually changes; on failure the camera keeps its old palette. */
+  if (!cam || !pal) return false;
+  sf_render_sync(ctx);
+  if (cam->palette && cam->_pal_inv && memcmp(cam->palette, pal, 256 * sizeof(sf_pkd_clr_t)) == 0) return true;
+  sf_pkd_clr_t *np = cam->palette  ? cam->palette  : (sf_pkd_clr_t*)malloc(256 * sizeof(sf_pkd_clr_t));
+  uint8_t      *ni = cam->_pal_inv ? cam->_pal_inv : (uint8_t*)malloc(SF_PAL_INV_SIZE);
+  if (!np || !ni) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate palette for '%s'\n", cam->name ? cam->name : "main");
+    if (np != cam->palette)  free(np);
+    if (ni != cam->_pal_inv) free(ni);
+    return false;
+  }
+  cam->palette  = np;
+  cam->_pal_inv = ni;
+  memcpy(cam->palette, pal, 256 * sizeof(sf_pkd_clr_t));
+  sf_camera_refresh(ctx, cam);
+  for (int i = 0; i < SF_PAL_INV_SIZE; i++) {
+    int r = ((i >> 10) & 31) * 255 / 31;
+    int g = ((i >>  5) & 31) * 255 / 31;
+    int b = ( i        & 31) * 255 / 31;
+    int best = 0, best_d = 0x7FFFFFFF;
+    for (int p = 0; p < 256; p++) {
+      int dr = r - (int)((pal[p] >> 16) & 0xFF);
+      int dg = g - (int)((pal[p] >>  8) & 0xFF);
+      int db = b - (int)( pal[p]        & 0xFF);
+      int d  = dr * dr * 3 + dg * dg * 4 + db * db * 2;
+      if (d < best_d) { best_d = d; best = p; }
+      if (d == 0) break;
+    }
+    cam->_pal_inv[i] = (uint8_t)best;
+  }
+  return true;
+}
+
+bool sf_camera_set_target(sf_ctx_t *ctx, sf_cam_t *cam, void *pixels, int pitch) {
+  /* Draw cam straight into caller memory (e.g. a locked texture) whose rows are pitch bytes apart;
+   * pass NULL to detach and go back to the camera's own buffer. */
+  if (!cam) return false;
+  int bpp = (cam->pix_fmt == SF_PIXFMT_IDX8) ? 1 : (cam->pix_fmt == SF_PIXFMT_RGB565) ? 2 : 4;
+  if (pixels && (pitch < cam->w * bpp || pitch % bpp != 0)) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to set target for '%s', bad pitch %d\n", cam->name ? cam->name : "main", pitch);
+    return false;
+  }
+  if (!cam->ext_px) {
+    cam->_own_px = cam->buffer ? (void*)cam->buffer : cam->buffer16 ? (void*)cam->buffer16 : (void*)cam->buffer8;
+  }
+  void *px    = pixels ? pixels : cam->_own_px;
+  cam->ext_px = (pixels != NULL);
+  cam->stride = pixels ? pitch / bpp : cam->w;
+  if (!pixels) cam->_own_px = NULL;
+  if (cam->pix_fmt == SF_PIXFMT_RGB565)    cam->buffer16 = (uint16_t*)px;
+  else if (cam->pix_fmt == SF_PIXFMT_IDX8) cam->buffer8  = (uint8_t*)px;
+  else                                     cam->buffer   = (sf_pkd_clr_t*)px;
+  if (!cam->_od_px) sf_camera_refresh(ctx, cam);
+  return true;
+}
+
+void sf_camera_set_rate(sf_ctx_t *ctx, sf_cam_t *cam, int every, float hz) {
+  /* Let sf_render_ctx redraw cam only every Nth call and/or at most hz times per second (0 = no limit), picking
+   * the update_phase least used by other cameras with the same period so expensive views spread across frames.
+   * Skipped frames restore a kept copy of the last image (one w*h copy per redraw), so external targets stay valid. */
+  if (!cam) return;
+  cam->update_every = every > 1 ? every : 0;
+  cam->update_hz    = hz > 0.0f ? hz : 0.0f;
+  cam->update_phase = 0;
+  if (cam->update_every <= 1) return;
+  int used[64] = {0};
+  for (int i = 0; i <= ctx->cam_count; i++) {
+    sf_cam_t *c = (i == 0) ? &ctx->main_camera : &ctx->cameras[i - 1];
+    if (c != cam && c->update_every == cam->update_every) used[c->update_phase % 64]++;
+  }
+  int span = cam->update_every < 64 ? cam->update_every : 64;
+  for (int p = 1; p < span; p++) {
+    if (used[p] < used[cam->update_phase]) cam->update_phase = p;
+  }
+}
+
+void sf_camera_refresh(sf_ctx_t *ctx, sf_cam_t *cam) {
+  /* Make the next sf_render_ctx redraw cam even if its update rate would skip it. */
+  (void)ctx;
+  if (cam) cam->_has_frame = false;
+}
+
+bool sf_camera_set_roi(sf_ctx_t *ctx, sf_cam_t *cam, int x, int y, int w, int h) {
+  /* Limit cam to the w x h pixel rectangle at (x, y): the rest of its image is neither cleared nor drawn, and
+   * entities projecting outside the rectangle are culled. w or h <= 0 goes back to drawing the whole image. */
+  if (!cam) return false;
+  sf_render_sync(ctx);
+  if (w <= 0 || h <= 0) {
+    _sf_roi_free(cam);
+    cam->roi_x = cam->roi_y = cam->roi_w = cam->roi_h = 0;
+    return true;
+  }
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > cam->w) w = cam->w - x;
+  if (y + h > cam->h) h = cam->h - y;
+  if (w <= 0 || h <= 0) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to set roi for '%s', rectangle is off the image\n", cam->name ? cam->name : "main");
+    return false;
+  }
+  if (!cam->_roi) cam->_roi = (sf_cam_t*)calloc(1, sizeof(sf_cam_t));
+  float *zb = cam->_roi ? (float*)realloc(cam->_roi->z_buffer, (size_t)w * h * sizeof(float)) : NULL;
+  if (!zb) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to allocate roi depth for '%s'\n", cam->name ? cam->name : "main");
+    _sf_roi_free(cam);
+    cam->roi_x = cam->roi_y = cam->roi_w = cam->roi_h = 0;
+    return false;
+  }
+  cam->_roi->z_buffer = zb;
+  cam->roi_x          = x;
+  cam->roi_y          = y;
+  cam->roi_w          = w;
+  cam->roi_h          = h;
+  return true;
+}
+
+void sf_mark_dirty(sf_ctx_t *ctx) {
+  /* Tell on_demand rendering that something it cannot see changed (texture pixels, obj->v written directly).
+   * Mesh, texture and scene-membership edits through the API bump the same generation on their own. */
+  ctx->_scene_gen++;
+}
+
 void sf_load_sff(sf_ctx_t *ctx, const char *filename, const char *worldname) {
   /* Load a .sff world file, populating textures, objects, entities, cameras, lights, emitters, and skybox */
   char r_path[512];
@@ -2482,6 +4980,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
     fprintf(f, "    pos    = (%.3f, %.3f, %.3f)\n", p.x, p.y, p.z);
   }
   fprintf(f, "    fov    = %.2f\n", ctx->main_camera.fov);
+  _sf_sff_write_cam(f, &ctx->main_camera);
   fprintf(f, "}\n\n");
 
   for (int i = 0; i < ctx->cam_count; i++) {
@@ -2494,6 +4993,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
     }
     fprintf(f, "    fov    = %.2f\n", c->fov);
     fprintf(f, "    size   = (%d, %d, 0)\n", c->w, c->h);
+    _sf_sff_write_cam(f, c);
     fprintf(f, "}\n\n");
   }
 
@@ -2508,7 +5008,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
       sf_gen_save_obj(ctx, o, gen_id);
       snprintf(gen_path, sizeof(gen_path), "sf_generated/%s/%s_%s.obj", gen_id, o->name, gen_id);
       size_t plen = strlen(gen_path) + 1;
-      o->src_path = (const char*)sf_arena_alloc(ctx, &ctx->arena, plen);
+      o->src_path = (const char*)sf_heap_alloc(ctx, plen);
       if (o->src_path) memcpy((void*)o->src_path, gen_path, plen);
       path = o->src_path;
     }
@@ -2524,7 +5024,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
   if (ctx->tex_count) fprintf(f, "\n");
 
   for (int i = 0; i < ctx->sprite_count; i++) {
-    sf_sprite_2_t *s = &ctx->sprites[i];
+    sf_sprite_2_t *s = ctx->sprites[i];
     if (!s->name || s->frame_count == 0) continue;
     fprintf(f, "sprite %s {\n", s->name);
     fprintf(f, "    duration = %.2f\n", s->frame_duration);
@@ -2542,7 +5042,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
   }
 
   for (int i = 0; i < ctx->enti_count; i++) {
-    sf_enti_t *e = &ctx->entities[i];
+    sf_enti_t *e = ctx->entities[i];
     if (!e->name || !e->frame) continue;
     fprintf(f, "entity %s {\n", e->name);
     fprintf(f, "    mesh    = %s\n", e->obj.name ? e->obj.name : "");
@@ -2553,12 +5053,13 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
     if (e->tex && e->tex->name) fprintf(f, "    texture = %s\n", e->tex->name);
     if (e->tex_scale.x != 1.0f || e->tex_scale.y != 1.0f)
       fprintf(f, "    tex_scale = (%.3f, %.3f)\n", e->tex_scale.x, e->tex_scale.y);
+    if (e->layers != SF_LAYER_DEFAULT) fprintf(f, "    layers  = 0x%x\n", e->layers);
     _sf_write_frame_ref(f, e->frame, ctx);
     fprintf(f, "}\n\n");
   }
 
   for (int i = 0; i < ctx->light_count; i++) {
-    sf_light_t *l = &ctx->lights[i];
+    sf_light_t *l = ctx->lights[i];
     if (!l->name || !l->frame) continue;
     fprintf(f, "light %s {\n", l->name);
     fprintf(f, "    type      = %s\n", l->type == SF_LIGHT_DIR ? "dir" : "point");
@@ -2571,7 +5072,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
   }
 
   for (int i = 0; i < ctx->emitr_count; i++) {
-    sf_emitr_t *em = &ctx->emitrs[i];
+    sf_emitr_t *em = ctx->emitrs[i];
     if (!em->name || !em->frame) continue;
     fprintf(f, "emitter %s {\n", em->name);
     const char *tstr = (em->type == SF_EMITR_DIR) ? "dir" : (em->type == SF_EMITR_VOLUME) ? "vol" : "omni";
@@ -2590,6 +5091,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
     if (em->type == SF_EMITR_VOLUME)
       fprintf(f, "    volume     = (%.3f, %.3f, %.3f)\n", em->volume_size.x, em->volume_size.y, em->volume_size.z);
     fprintf(f, "    max        = %d\n", em->max_particles);
+    if (em->layers != SF_LAYER_DEFAULT) fprintf(f, "    layers     = 0x%x\n", em->layers);
     _sf_write_frame_ref(f, em->frame, ctx);
     fprintf(f, "}\n\n");
   }
@@ -2608,6 +5110,7 @@ bool sf_save_sff(sf_ctx_t *ctx, const char *filepath) {
       fprintf(f, "    normal  = (%.4f, %.4f, %.4f)\n", b->normal.x, b->normal.y, b->normal.z);
     if (b->frame && b->frame->name)
       fprintf(f, "    frame   = %s\n", b->frame->name);
+    if (b->layers != SF_LAYER_DEFAULT) fprintf(f, "    layers  = 0x%x\n", b->layers);
     fprintf(f, "}\n\n");
   }
 
@@ -2668,15 +5171,50 @@ int _sf_sff_prse_list(const char *s, char out[][64], int max) {
   return count;
 }
 
-sf_frame_t* _sf_sff_get_frame_(sf_ctx_t *ctx, const char *name) {
-  /* Find a frame by name during .sff loading; searches backwards to prefer most recent. */
-  for (int i = ctx->frames_count - 1; i >= 0; i--) {
-    sf_frame_t *f = &ctx->frames[i];
-    if (!f->parent && !f->is_root) continue; /* skip freed frames */
-    if (f->name && strcmp(f->name, name) == 0)
-      return f;
+uint32_t _sf_sff_prse_feats(const char *s) {
+  /* Parse a "[skybox, fog, particles, billboards]" list into SF_CAM_* feature bits; unknown names are ignored. */
+  char     items[8][64];
+  int      n     = _sf_sff_prse_list(s, items, 8);
+  uint32_t feats = 0;
+  for (int i = 0; i < n; i++) {
+    if      (strcmp(items[i], "skybox")     == 0) feats |= SF_CAM_SKYBOX;
+    else if (strcmp(items[i], "fog")        == 0) feats |= SF_CAM_FOG;
+    else if (strcmp(items[i], "particles")  == 0) feats |= SF_CAM_PARTICLES;
+    else if (strcmp(items[i], "billboards") == 0) feats |= SF_CAM_BILLBOARDS;
   }
-  return NULL;
+  return feats;
+}
+
+void _sf_sff_write_cam(FILE *f, const sf_cam_t *cam) {
+  /* Write a camera's cull_mask, features and update rate keys, omitting whichever still has its default value. */
+  if (cam->cull_mask != SF_LAYER_ALL) fprintf(f, "    cull_mask = 0x%x\n", cam->cull_mask);
+  if (cam->update_every > 1)         fprintf(f, "    update_every = %d\n", cam->update_every);
+  if (cam->update_hz > 0.0f)         fprintf(f, "    update_hz = %.2f\n", cam->update_hz);
+  if (cam->features == SF_CAM_ALL) return;
+  fprintf(f, "    features = [");
+  const char *names[4] = { "skybox", "fog", "particles", "billboards" };
+  int         n        = 0;
+  for (int b = 0; b < 4; b++) {
+    if (cam->features & (1u << b)) fprintf(f, "%s%s", n++ ? ", " : "", names[b]);
+  }
+  fprintf(f, "]\n");
+}
+
+sf_frame_t* _sf_sff_get_frame_(sf_ctx_t *ctx, const char *name) {
+  /* Find a frame by name during .sff loading: of the named frame block and the frames of the entity, light, camera
+   * and emitter of that name, the one latest in ctx->frames wins, as with a backwards scan of the frame list. */
+  sf_enti_t  *e    = (sf_enti_t*) _sf_names_find(&ctx->names[SF_NAME_ENTI],  name);
+  sf_light_t *l    = (sf_light_t*)_sf_names_find(&ctx->names[SF_NAME_LIGHT], name);
+  sf_cam_t   *c    = (sf_cam_t*)  _sf_names_find(&ctx->names[SF_NAME_CAM],   name);
+  sf_emitr_t *em   = (sf_emitr_t*)_sf_names_find(&ctx->names[SF_NAME_EMITR], name);
+  sf_frame_t *f[5] = { (sf_frame_t*)_sf_names_find(&ctx->names[SF_NAME_FRAME], name),
+                       e ? e->frame : NULL, l ? l->frame : NULL, c ? c->frame : NULL, em ? em->frame : NULL };
+  sf_frame_t *best = NULL;
+  for (int i = 0; i < 5; i++) {
+    if (!f[i] || (best && ((sf_pool_hdr_t*)f[i] - 1)->dense < ((sf_pool_hdr_t*)best - 1)->dense)) continue;
+    best = f[i];
+  }
+  return best;
 }
 
 void _sf_sff_prse_frame(sf_ctx_t *ctx, FILE *f, const char *name, int *frame_count) {
@@ -2699,8 +5237,9 @@ void _sf_sff_prse_frame(sf_ctx_t *ctx, FILE *f, const char *name, int *frame_cou
   fr->scale = scale;
   fr->is_dirty = true;
   size_t name_len = strlen(name) + 1;
-  fr->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  fr->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (fr->name) memcpy((void*)fr->name, name, name_len);
+  _sf_names_put(ctx, &ctx->names[SF_NAME_FRAME], fr->name, fr);
   (*frame_count)++;
 }
 
@@ -2712,18 +5251,28 @@ void _sf_sff_prse_cam(sf_ctx_t *ctx, FILE *f, const char *name, int *cam_count)
   float fov = 60.0f;
   int w = 0, h = 0;
   bool has_target = false;
+  uint32_t cull_mask = SF_LAYER_ALL, features = SF_CAM_ALL;
+  int every = 0;
+  float hz = 0.0f;
   while (_sf_sff_read_kv(f, key, sizeof(key), val, sizeof(val))) {
-    if      (strcmp(key, "pos")    == 0) pos    = _sf_sff_prse_vec3(val);
-    else if (strcmp(key, "target") == 0) { target = _sf_sff_prse_vec3(val); has_target = true; }
-    else if (strcmp(key, "fov")    == 0) sscanf(val, "%f", &fov);
-    else if (strcmp(key, "frame")  == 0) snprintf(parent_frame, sizeof(parent_frame), "%s", val);
-    else if (strcmp(key, "size")   == 0) { sf_fvec3_t s = _sf_sff_prse_vec3(val); w = (int)s.x; h = (int)s.y; }
+    if      (strcmp(key, "pos")          == 0) pos    = _sf_sff_prse_vec3(val);
+    else if (strcmp(key, "target")       == 0) { target = _sf_sff_prse_vec3(val); has_target = true; }
+    else if (strcmp(key, "fov")          == 0) sscanf(val, "%f", &fov);
+    else if (strcmp(key, "frame")        == 0) snprintf(parent_frame, sizeof(parent_frame), "%s", val);
+    else if (strcmp(key, "size")         == 0) { sf_fvec3_t s = _sf_sff_prse_vec3(val); w = (int)s.x; h = (int)s.y; }
+    else if (strcmp(key, "cull_mask")    == 0) cull_mask = (uint32_t)strtoul(val, NULL, 0);
+    else if (strcmp(key, "features")     == 0) features  = _sf_sff_prse_feats(val);
+    else if (strcmp(key, "update_every") == 0) sscanf(val, "%d", &every);
+    else if (strcmp(key, "update_hz")    == 0) sscanf(val, "%f", &hz);
   }
   if (strcmp(name, "main") == 0) {
     sf_camera_set_pos(ctx, &ctx->main_camera, pos.x, pos.y, pos.z);
     if (has_target) sf_camera_look_at(ctx, &ctx->main_camera, target);
     ctx->main_camera.fov = fov;
     ctx->main_camera.is_proj_dirty = true;
+    ctx->main_camera.cull_mask = cull_mask;
+    ctx->main_camera.features = features;
+    sf_camera_set_rate(ctx, &ctx->main_camera, every, hz);
     if (parent_frame[0]) {
       sf_frame_t *pf = _sf_sff_get_frame_(ctx, parent_frame);
       if (pf) sf_frame_set_parent(ctx->main_camera.frame, pf);
@@ -2735,6 +5284,9 @@ void _sf_sff_prse_cam(sf_ctx_t *ctx, FILE *f, const char *name, int *cam_count)
     if (cam) {
       sf_camera_set_pos(ctx, cam, pos.x, pos.y, pos.z);
       if (has_target) sf_camera_look_at(ctx, cam, target);
+      cam->cull_mask = cull_mask;
+      cam->features = features;
+      sf_camera_set_rate(ctx, cam, every, hz);
       if (parent_frame[0]) {
         sf_frame_t *pf = _sf_sff_get_frame_(ctx, parent_frame);
         if (pf) sf_frame_set_parent(cam->frame, pf);
@@ -2751,6 +5303,7 @@ void _sf_sff_prse_enti(sf_ctx_t *ctx, FILE *f, const char *name, int *enti_count
   sf_fvec3_t pos = {0,0,0}, rot = {0,0,0}, scale = {1,1,1};
   sf_fvec2_t tex_scale = {1.0f, 1.0f};
   bool has_tex_scale = false;
+  uint32_t layers = SF_LAYER_DEFAULT;
   while (_sf_sff_read_kv(f, key, sizeof(key), val, sizeof(val))) {
     if      (strcmp(key, "mesh")      == 0) snprintf(mesh_name, sizeof(mesh_name), "%s", val);
     else if (strcmp(key, "texture")   == 0) snprintf(tex_name, sizeof(tex_name), "%s", val);
@@ -2759,6 +5312,7 @@ void _sf_sff_prse_enti(sf_ctx_t *ctx, FILE *f, const char *name, int *enti_count
     else if (strcmp(key, "pos")       == 0) pos   = _sf_sff_prse_vec3(val);
     else if (strcmp(key, "rot")       == 0) rot   = _sf_sff_prse_vec3(val);
     else if (strcmp(key, "scale")     == 0) scale = _sf_sff_prse_vec3(val);
+    else if (strcmp(key, "layers")    == 0) layers = (uint32_t)strtoul(val, NULL, 0);
   }
   sf_obj_t *obj = sf_get_obj_(ctx, mesh_name, true);
   if (!obj) return;
@@ -2771,6 +5325,7 @@ void _sf_sff_prse_enti(sf_ctx_t *ctx, FILE *f, const char *name, int *enti_count
   sf_enti_set_scale(ctx, enti, scale.x, scale.y, scale.z);
   if (tex_name[0]) enti->tex = sf_get_texture_(ctx, tex_name, true);
   if (has_tex_scale) enti->tex_scale = tex_scale;
+  enti->layers = layers;
   if (parent_frame[0]) {
     sf_frame_t *pf = _sf_sff_get_frame_(ctx, parent_frame);
     if (pf) sf_frame_set_parent(enti->frame, pf);
@@ -2818,16 +5373,19 @@ void _sf_sff_prse_sprit(sf_ctx_t *ctx, FILE *f, const char *name, int *sprite_co
     else if (strcmp(key, "frames")   == 0) frame_count = _sf_sff_prse_list(val, frame_names, SF_MAX_SPRITE_FRAMES);
   }
   if (frame_count == 0) return;
-  if (ctx->sprite_count >= SF_MAX_SPRITES) return;
   if (NULL != sf_get_sprite_(ctx, name, false)) return;
-  sf_sprite_2_t *spr = &ctx->sprites[ctx->sprite_count++];
+  sf_sprite_2_t *spr = (sf_sprite_2_t*)sf_pool_add(ctx, &ctx->sprite_pool);
+  if (!spr) return;
+  ctx->sprites      = (sf_sprite_2_t**)ctx->sprite_pool.items;
+  ctx->sprite_count = ctx->sprite_pool.count;
   spr->id = ctx->sprite_count - 1;
   spr->frame_count = frame_count;
   spr->frame_duration = duration;
   spr->base_scale = scale;
   size_t name_len = strlen(name) + 1;
-  spr->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, name_len);
+  spr->name = (const char*)sf_heap_alloc(ctx, name_len);
   if (spr->name) memcpy((void*)spr->name, name, name_len);
+  _sf_names_put(ctx, &ctx->names[SF_NAME_SPRITE], spr->name, spr);
   for (int i = 0; i < frame_count; i++)
     spr->frames[i] = sf_get_texture_(ctx, frame_names[i], true);
   (*sprite_count)++;
@@ -2841,6 +5399,7 @@ void _sf_sff_prse_emitr(sf_ctx_t *ctx, FILE *f, const char *name, int *emitr_cou
   float spawn_rate = 10.0f, life = 1.0f, speed = 1.0f, spread = 0.0f;
   sf_fvec3_t pos = {0,0,0}, dir = {0,1,0}, volume = {1,1,1};
   bool has_dir = false, has_vol = false;
+  uint32_t layers = SF_LAYER_DEFAULT;
   while (_sf_sff_read_kv(f, key, sizeof(key), val, sizeof(val))) {
     if      (strcmp(key, "type")       == 0) snprintf(type_str, sizeof(type_str), "%s", val);
     else if (strcmp(key, "sprite")     == 0) snprintf(spr_name, sizeof(spr_name), "%s", val);
@@ -2853,6 +5412,7 @@ void _sf_sff_prse_emitr(sf_ctx_t *ctx, FILE *f, const char *name, int *emitr_cou
     else if (strcmp(key, "dir")        == 0) { dir    = _sf_sff_prse_vec3(val); has_dir = true; }
     else if (strcmp(key, "spread")     == 0) sscanf(val, "%f", &spread);
     else if (strcmp(key, "volume")     == 0) { volume = _sf_sff_prse_vec3(val); has_vol = true; }
+    else if (strcmp(key, "layers")     == 0) layers = (uint32_t)strtoul(val, NULL, 0);
   }
   sf_emitr_type_t type = SF_EMITR_OMNI;
   if      (strcmp(type_str, "dir") == 0) type = SF_EMITR_DIR;
@@ -2865,6 +5425,7 @@ void _sf_sff_prse_emitr(sf_ctx_t *ctx, FILE *f, const char *name, int *emitr_cou
   em->spawn_rate = spawn_rate;
   em->particle_life = life;
   em->speed = speed;
+  em->layers = layers;
   if (type == SF_EMITR_DIR || has_dir) { em->dir = sf_fvec3_norm(dir); em->spread = spread; }
   if (type == SF_EMITR_VOLUME || has_vol) em->volume_size = volume;
   if (parent_frame[0]) {
@@ -2880,6 +5441,7 @@ void _sf_sff_prse_sprit_3d(sf_ctx_t *ctx, FILE *f, const char *name, int *sprite
   char spr_name[64] = {0}, frame_name[64] = {0};
   sf_fvec3_t pos = {0,0,0}, normal = {0,0,0};
   float scale = 1.0f, opacity = 1.0f, angle = 0.0f;
+  uint32_t layers = SF_LAYER_DEFAULT;
   while (_sf_sff_read_kv(f, key, sizeof(key), val, sizeof(val))) {
     if      (strcmp(key, "sprite")  == 0) snprintf(spr_name,   sizeof(spr_name),   "%s", val);
     else if (strcmp(key, "frame")   == 0) snprintf(frame_name, sizeof(frame_name), "%s", val);
@@ -2888,6 +5450,7 @@ void _sf_sff_prse_sprit_3d(sf_ctx_t *ctx, FILE *f, const char *name, int *sprite
     else if (strcmp(key, "opacity") == 0) sscanf(val, "%f", &opacity);
     else if (strcmp(key, "angle")   == 0) sscanf(val, "%f", &angle);
     else if (strcmp(key, "normal")  == 0) normal  = _sf_sff_prse_vec3(val);
+    else if (strcmp(key, "layers")  == 0) layers  = (uint32_t)strtoul(val, NULL, 0);
   }
   if (!spr_name[0]) return;
   sf_sprite_2_t *spr = sf_get_sprite_(ctx, spr_name, true);
@@ -2895,6 +5458,7 @@ void _sf_sff_prse_sprit_3d(sf_ctx_t *ctx, FILE *f, const char *name, int *sprite
   sf_sprite_3_t *b = sf_add_sprite_3d(ctx, spr, name, pos, scale, opacity, angle);
   if (b) {
     b->normal = normal;
+    b->layers = layers;
     if (frame_name[0]) b->frame = _sf_sff_get_frame_(ctx, frame_name);
   }
   (*sprite_3d_count)++;
@@ -2998,19 +5562,14 @@ sf_frame_t* sf_get_root(sf_ctx_t *ctx, sf_convention_t conv) {
 }
 
 sf_frame_t* sf_add_frame(sf_ctx_t *ctx, sf_frame_t *parent) {
-  /* Allocate a new scene-graph frame (from the free list or pool) and attach it to parent. */
-  sf_frame_t *f;
-  if (ctx->free_frames) {
-    f = ctx->free_frames;
-    ctx->free_frames = f->next_sibling;
-  } else {
-    if (ctx->frames_count >= SF_MAX_FRAMES) return NULL;
-    f = &ctx->frames[ctx->frames_count++];
-  }
-  memset(f, 0, sizeof(sf_frame_t));
+  /* Allocate a new scene-graph frame from the frame pool and attach it to parent. */
+  sf_frame_t *f = (sf_frame_t*)sf_pool_add(ctx, &ctx->frame_pool);
+  if (!f) return NULL;
+  ctx->frames       = (sf_frame_t**)ctx->frame_pool.items;
+  ctx->frames_count = ctx->frame_pool.count;
   f->scale = (sf_fvec3_t){1.0f, 1.0f, 1.0f};
-  f->local_M = sf_make_idn_fmat4();
-  f->global_M = sf_make_idn_fmat4();
+  f->local_M = sf_make_idn_fmat43();
+  f->global_M = sf_make_idn_fmat43();
   f->is_dirty = true;
   f->is_root = false;
 
@@ -3019,16 +5578,41 @@ sf_frame_t* sf_add_frame(sf_ctx_t *ctx, sf_frame_t *parent) {
   f->parent = parent;
   f->next_sibling = parent->first_child;
   parent->first_child = f;
+  ctx->frame_flat.stale = true;
 
   return f;
 }
 
 void sf_update_frames(sf_ctx_t *ctx) {
-  /* Walk every root's tree and recompute global_M for dirty frames. */
-  for (int i = 0; i < SF_CONV_MAX; i++) {
-    if (ctx->roots[i]) {
-      _sf_calc_frame_tree(ctx->roots[i], sf_make_idn_fmat4(), false);
+  /* Recompute global_M for dirty frames and their descendants in one forward sweep over the frames sorted
+   * parents-first. A first pass gathers the dirty flags and re-sorts if any frame was re-parented. */
+  sf_frame_flat_t *fl  = &ctx->frame_flat;
+  bool             any = false;
+  if (fl->stale && !_sf_frame_sort(ctx)) return;
+  for (int32_t i = 0; i < fl->count; i++) {
+    sf_frame_t *f = fl->order[i];
+    if (f->parent != (fl->parent[i] < 0 ? NULL : fl->order[fl->parent[i]])) {
+      if (!_sf_frame_sort(ctx)) return;
+      i   = -1;
+      any = false;
+      continue;
+    }
+    fl->dirty[i] = f->is_dirty;
+    any         |= f->is_dirty;
+  }
+  if (!any) return;
+  for (int32_t i = 0; i < fl->count; i++) {
+    int32_t p = fl->parent[i];
+    if (!fl->dirty[i] && (p < 0 || !fl->dirty[p])) continue;
+    sf_frame_t *f = fl->order[i];
+    fl->dirty[i]  = 1;
+    f->is_dirty   = false;
+    if (f->is_root) {
+      f->global_M = f->local_M;
+      continue;
     }
+    _sf_frame_local(f);
+    f->global_M = sf_fmat43_mul_fmat43(f->local_M, fl->order[p]->global_M);
   }
 }
 
@@ -3065,8 +5649,9 @@ void sf_frame_set_parent(sf_frame_t *child, sf_frame_t *new_parent) {
 }
 
 void sf_remove_frame(sf_ctx_t *ctx, sf_frame_t *f) {
-  /* Recursively unlink a frame and all its children, returning them to the free list. */
-  if (!f || f->is_root) return;
+  /* Recursively unlink a frame and all its children, returning them to the frame pool. */
+  if (!f || f->is_root || !sf_pool_remove(&ctx->frame_pool, f)) return;
+  ctx->frames_count = ctx->frame_pool.count;
   sf_frame_t *c = f->first_child;
   while (c) {
     sf_frame_t *next = c->next_sibling;
@@ -3080,11 +5665,15 @@ void sf_remove_frame(sf_ctx_t *ctx, sf_frame_t *f) {
       curr = &((*curr)->next_sibling);
     }
   }
+  if (f->name && _sf_names_find(&ctx->names[SF_NAME_FRAME], f->name) == f) {
+    _sf_names_del(&ctx->names[SF_NAME_FRAME], f->name, f);
+    sf_heap_free(ctx, f->name);
+  }
+  ctx->frame_flat.stale = true;
   f->parent = NULL;
   f->first_child = NULL;
+  f->next_sibling = NULL;
   f->name = NULL;
-  f->next_sibling = ctx->free_frames;
-  ctx->free_frames = f;
 }
 
 void sf_frame_walk(sf_ctx_t *ctx, sf_frame_t *root, sf_frame_walk_fn cb, void *userdata) {
@@ -3096,15 +5685,13 @@ void sf_frame_walk(sf_ctx_t *ctx, sf_frame_t *root, sf_frame_walk_fn cb, void *u
 
 void _sf_set_up_frames(sf_ctx_t *ctx) {
   /* Create the three convention roots (DEFAULT, NED, FLU) with their fixed basis matrices. */
-  ctx->roots[SF_CONV_DEFAULT] = &ctx->frames[ctx->frames_count++];
-  memset(ctx->roots[SF_CONV_DEFAULT], 0, sizeof(sf_frame_t));
-  ctx->roots[SF_CONV_DEFAULT]->local_M  = sf_make_idn_fmat4();
-  ctx->roots[SF_CONV_DEFAULT]->global_M = sf_make_idn_fmat4();
+  ctx->roots[SF_CONV_DEFAULT] = (sf_frame_t*)sf_pool_add(ctx, &ctx->frame_pool);
+  ctx->roots[SF_CONV_DEFAULT]->local_M  = sf_make_idn_fmat43();
+  ctx->roots[SF_CONV_DEFAULT]->global_M = sf_make_idn_fmat43();
   ctx->roots[SF_CONV_DEFAULT]->is_root  = true;
 
-  ctx->roots[SF_CONV_NED] = &ctx->frames[ctx->frames_count++];
-  memset(ctx->roots[SF_CONV_NED], 0, sizeof(sf_frame_t));
-  sf_fmat4_t ned_M = sf_make_idn_fmat4();
+  ctx->roots[SF_CONV_NED] = (sf_frame_t*)sf_pool_add(ctx, &ctx->frame_pool);
+  sf_fmat43_t ned_M = sf_make_idn_fmat43();
   ned_M.m[0][0]= 0; ned_M.m[0][1]= 1; ned_M.m[0][2]= 0; 
   ned_M.m[1][0]= 0; ned_M.m[1][1]= 0; ned_M.m[1][2]=-1; 
   ned_M.m[2][0]=-1; ned_M.m[2][1]= 0; ned_M.m[2][2]= 0; 
@@ -3112,36 +5699,71 @@ void _sf_set_up_frames(sf_ctx_t *ctx) {
   ctx->roots[SF_CONV_NED]->global_M = ned_M;
   ctx->roots[SF_CONV_NED]->is_root  = true;
 
-  ctx->roots[SF_CONV_FLU] = &ctx->frames[ctx->frames_count++];
-  memset(ctx->roots[SF_CONV_FLU], 0, sizeof(sf_frame_t));
-  sf_fmat4_t flu_M = sf_make_idn_fmat4();
+  ctx->roots[SF_CONV_FLU] = (sf_frame_t*)sf_pool_add(ctx, &ctx->frame_pool);
+  sf_fmat43_t flu_M = sf_make_idn_fmat43();
   flu_M.m[0][0]= 0; flu_M.m[0][1]=-1; flu_M.m[0][2]= 0; 
   flu_M.m[1][0]= 0; flu_M.m[1][1]= 0; flu_M.m[1][2]= 1; 
   flu_M.m[2][0]=-1; flu_M.m[2][1]= 0; flu_M.m[2][2]= 0; 
   ctx->roots[SF_CONV_FLU]->local_M  = flu_M;
   ctx->roots[SF_CONV_FLU]->global_M = flu_M;
   ctx->roots[SF_CONV_FLU]->is_root  = true;
-}
-
-void _sf_calc_frame_tree(sf_frame_t *f, sf_fmat4_t parent_global_M, bool force_dirty) {
-  /* Recursively recompute global_M for this frame and its children if dirty. */
-  if (!f) return;
-  bool current_dirty = f->is_dirty || force_dirty;
-
-  if (current_dirty) {
-    if (!f->is_root) {
-      sf_fmat4_t t_mat  = sf_make_tsl_fmat4(f->pos.x, f->pos.y, f->pos.z);
-      sf_fmat4_t r_mat  = sf_make_rot_fmat4(f->rot);
-      sf_fmat4_t s_mat  = sf_make_scale_fmat4(f->scale);
-      sf_fmat4_t rs_mat = sf_fmat4_mul_fmat4(r_mat, s_mat);
-      f->local_M = sf_fmat4_mul_fmat4(rs_mat, t_mat);
+  ctx->frames           = (sf_frame_t**)ctx->frame_pool.items;
+  ctx->frames_count     = ctx->frame_pool.count;
+  ctx->frame_flat.stale = true;
+}
+
+bool _sf_frame_sort(sf_ctx_t *ctx) {
+  /* Rebuild ctx->frame_flat: every frame reachable from a root, breadth-first so parents come before children,
+   * with each frame's parent index. Iterative, so hierarchy depth costs no stack. */
+  sf_frame_flat_t *fl = &ctx->frame_flat;
+  int32_t          n  = ctx->frame_pool.count;
+  int32_t          c0 = fl->cap, c1 = fl->cap, c2 = fl->cap;
+  sf_frame_t     **o  = (sf_frame_t**)_sf_grow(fl->order,  &c0, n, sizeof(sf_frame_t*));
+  if (o) fl->order = o;
+  int32_t         *pa = (int32_t*)    _sf_grow(fl->parent, &c1, n, sizeof(int32_t));
+  if (pa) fl->parent = pa;
+  uint8_t         *d  = (uint8_t*)    _sf_grow(fl->dirty,  &c2, n, sizeof(uint8_t));
+  if (d) fl->dirty = d;
+  if (!o || !pa || !d) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to sort %d frames\n", n);
+    return false;
+  }
+  fl->cap   = c0;
+  fl->count = 0;
+  for (int i = 0; i < SF_CONV_MAX; i++) {
+    if (!ctx->roots[i]) continue;
+    fl->order[fl->count]    = ctx->roots[i];
+    fl->parent[fl->count++] = -1;
+  }
+  for (int32_t i = 0; i < fl->count; i++) {
+    for (sf_frame_t *c = fl->order[i]->first_child; c && fl->count < n; c = c->next_sibling) {
+      fl->order[fl->count]    = c;
+      fl->parent[fl->count++] = i;
     }
-    f->global_M = sf_fmat4_mul_fmat4(f->local_M, parent_global_M);
-    f->is_dirty = false;
   }
- 
-  _sf_calc_frame_tree(f->first_child, f->global_M, current_dirty);
-  _sf_calc_frame_tree(f->next_sibling, parent_global_M, force_dirty);
+  fl->stale = false;
+  return true;
+}
+
+void _sf_frame_local(sf_frame_t *f) {
+  /* Set local_M = R * S * T from pos, rot and scale, written out directly instead of building and multiplying
+   * three 4x4 matrices. Only the affine 3x4 part is stored. */
+  float cx = cosf(f->rot.x), sx = sinf(f->rot.x);
+  float cy = cosf(f->rot.y), sy = sinf(f->rot.y);
+  float cz = cosf(f->rot.z), sz = sinf(f->rot.z);
+  sf_fmat43_t *m = &f->local_M;
+  m->m[0][0] = (cy * cz)                * f->scale.x;
+  m->m[0][1] = (cy * sz)                * f->scale.y;
+  m->m[0][2] = (-sy)                    * f->scale.z;
+  m->m[1][0] = (sx * sy * cz - cx * sz) * f->scale.x;
+  m->m[1][1] = (sx * sy * sz + cx * cz) * f->scale.y;
+  m->m[1][2] = (sx * cy)                * f->scale.z;
+  m->m[2][0] = (cx * sy * cz + sx * sz) * f->scale.x;
+  m->m[2][1] = (cx * sy * sz - sx * cz) * f->scale.y;
+  m->m[2][2] = (cx * cy)                * f->scale.z;
+  m->m[3][0] = f->pos.x;
+  m->m[3][1] = f->pos.y;
+  m->m[3][2] = f->pos.z;
 }
 
 void _sf_write_frame_ref(FILE *f, sf_frame_t *fr, sf_ctx_t *ctx) {
@@ -3164,6 +5786,17 @@ bool _sf_frame_walk_r(sf_frame_t *f, int depth, sf_frame_walk_fn cb, void *ud) {
 /* SF_DRAWING_FUNCTIONS */
 void sf_fill(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c) {
   /* Fill the entire camera pixel buffer with a solid color. */
+  if (cam->stride != cam->w) {
+    sf_rect(ctx, cam, c, (sf_ivec2_t){0, 0}, (sf_ivec2_t){cam->w - 1, cam->h - 1});
+    return;
+  }
+  if (!cam->buffer) {
+    _sf_put_px(cam, 0, c);
+    if (cam->buffer8) { memset(cam->buffer8, cam->buffer8[0], cam->buffer_size); return; }
+    uint16_t c16 = cam->buffer16[0];
+    for (int i = 1; i < cam->buffer_size; ++i) cam->buffer16[i] = c16;
+    return;
+  }
   if (c == 0) { memset(cam->buffer, 0, cam->buffer_size * sizeof(sf_pkd_clr_t)); return; }
   sf_pkd_clr_t *buf = cam->buffer;
   int n = cam->buffer_size;
@@ -3173,16 +5806,24 @@ void sf_fill(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c) {
 void sf_pixel(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c, sf_ivec2_t v0) {
   /* Write a single pixel, clipping to the camera bounds. */
   if (v0.x < 0 || v0.x >= cam->w || v0.y < 0 || v0.y >= cam->h) return;
-  cam->buffer[_sf_vec_to_index(ctx, cam, v0)] = c;
+  if (cam->buffer) cam->buffer[_sf_vec_to_index(ctx, cam, v0)] = c;
+  else             _sf_put_px(cam, (int)_sf_vec_to_index(ctx, cam, v0), c);
 }
 
 void sf_pixel_depth(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c, sf_ivec2_t v, float z) {
-  /* Write a pixel only if z is closer than the current z-buffer value. */
+  /* Write a pixel only if z (a projected depth from _sf_project_vertex) is closer than the stored depth. */
   if (v.x >= cam->w || v.y >= cam->h) return;
   uint32_t idx = _sf_vec_to_index(ctx, cam, v);
-  if (z < cam->z_buffer[idx]) {
-    cam->z_buffer[idx] = z;
-    cam->buffer[idx] = c;
+  uint32_t zi  = v.y * cam->w + v.x;
+  if (cam->z_buffer16) {
+    uint16_t q = _sf_depth_to_q16(z, _sf_depth_q16_k(cam));
+    if (q < cam->z_buffer16[zi]) {
+      cam->z_buffer16[zi] = q;
+      _sf_put_px(cam, (int)idx, c);
+    }
+  } else if (z < cam->z_buffer[zi]) {
+    cam->z_buffer[zi] = z;
+    _sf_put_px(cam, (int)idx, c);
   }
 }
 
@@ -3219,8 +5860,9 @@ void sf_rect(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c, sf_ivec2_t v0, sf_ive
   if (l < 0) l = 0; if (r >= cam->w) r = cam->w - 1;
   if (t < 0) t = 0; if (b >= cam->h) b = cam->h - 1;
   for (int y = t; y <= b; ++y) {
-    int bi = y * cam->w + l;
-    for (int x = l; x <= r; ++x) cam->buffer[bi++] = c;
+    int bi = y * cam->stride + l;
+    if (cam->buffer) for (int x = l; x <= r; ++x) cam->buffer[bi++] = c;
+    else             for (int x = l; x <= r; ++x) _sf_put_px(cam, bi++, c);
   }
 }
 
@@ -3237,9 +5879,13 @@ void sf_tri(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c, sf_fvec3_t v0, sf_fvec
   float dza = (v2.z - v0.z) * inv_h02;
   int h01 = iy1 - iy0;
   bool swap = (h01 > 0) ? (v1.x < v0.x + dxa * h01) : (v1.x < v0.x);
-  int cam_w = cam->w, cam_h = cam->h;
+  int cam_w = cam->w, cam_h = cam->h, cam_s = cam->stride;
   sf_pkd_clr_t *cam_buf = cam->buffer;
   float *z_buf = cam->z_buffer;
+  uint16_t *z16 = cam->z_buffer16;
+  float zk = z16 ? _sf_depth_q16_k(cam) : 0.0f;
+  sf_pkd_clr_t tmp[2 * SF_PX_CHUNK];
+  int chunk = cam_buf ? cam_w : SF_PX_CHUNK;
   for (int half = 0; half < 2; half++) {
     int yb, ye_raw;
     float bx0, bz0, dxb, dzb;
@@ -3274,13 +5920,30 @@ void sf_tri(sf_ctx_t *ctx, sf_cam_t *cam, sf_pkd_clr_t c, sf_fvec3_t v0, sf_fvec
       if (x_s < 0) x_s = 0;
       if (x_e >= cam_w) x_e = cam_w - 1;
       float cz = lz + dz * (float)(x_s - ox);
-      int bi = y * cam_w + x_s;
-      if (use_depth) {
-        for (int x = x_s; x <= x_e; ++x, ++bi, cz += dz) {
-          if (cz < z_buf[bi]) { z_buf[bi] = cz; cam_buf[bi] = c; }
+      int   bi = y * cam_w + x_s, ci = y * cam_s + x_s;
+      float qa = (use_depth && z16) ? _sf_depth_q16f(cz, zk) : 0.0f;
+      for (int xa = x_s; xa <= x_e; xa += chunk, ci += chunk) {
+        int           n  = (x_e - xa + 1 < chunk) ? x_e - xa + 1 : chunk;
+        sf_pkd_clr_t *px = _sf_px_span(cam, tmp, ci, n);
+        if (use_depth && z16) {
+          for (int k = 0; k < n; ) {
+            int   m  = (n - k < SF_DEPTH_SPAN) ? n - k : SF_DEPTH_SPAN;
+            float qb = _sf_depth_q16f(cz + dz * (float)m, zk);
+            float dq = (qb - qa) / (float)m, q = qa;
+            for (int e = k + m; k < e; ++k, ++bi, q += dq) {
+              uint16_t qi = (uint16_t)q;
+              if (qi < z16[bi]) { z16[bi] = qi; px[k] = c; }
+            }
+            cz += dz * (float)m; qa = qb;
+          }
+        } else if (use_depth) {
+          for (int k = 0; k < n; ++k, ++bi, cz += dz) {
+            if (cz < z_buf[bi]) { z_buf[bi] = cz; px[k] = c; }
+          }
+        } else {
+          for (int k = 0; k < n; ++k) px[k] = c;
         }
-      } else {
-        for (int x = x_s; x <= x_e; ++x, ++bi) cam_buf[bi] = c;
+        _sf_px_flush(cam, tmp, ci, n);
       }
       ax += dxa; az += dza;
       bx += dxb; bz += dzb;
@@ -3313,9 +5976,13 @@ void sf_tri_tex(sf_ctx_t *ctx, sf_cam_t *cam, sf_tex_t *tex, sf_fvec3_t v0, sf_f
   int tex_w = tex->w, tex_h = tex->h;
   int tex_wm = tex->w_mask, tex_hm = tex->h_mask;
   sf_pkd_clr_t *tex_px = tex->px;
-  int cam_w = cam->w, cam_h = cam->h;
+  int cam_w = cam->w, cam_h = cam->h, cam_s = cam->stride;
   sf_pkd_clr_t *cam_buf = cam->buffer;
   float *z_buf = cam->z_buffer;
+  uint16_t *z16 = cam->z_buffer16;
+  float zk = z16 ? _sf_depth_q16_k(cam) : 0.0f;
+  sf_pkd_clr_t tmp[2 * SF_PX_CHUNK];
+  int chunk = cam_buf ? cam_w : SF_PX_CHUNK;
   for (int half = 0; half < 2; half++) {
     int yb, ye_raw;
     float bx0, bz0, bux0, buy0, buz0, dxb, dzb, duxb, duyb, duzb;
@@ -3374,33 +6041,50 @@ void sf_tri_tex(sf_ctx_t *ctx, sf_cam_t *cam, sf_tex_t *tex, sf_fvec3_t v0, sf_f
         float cux = lux + dux * skip;
         float cuy = luy + duy * skip;
         float cuz = luz + duz * skip;
-        int bi = y * cam_w + x0;
-        for (int x = x0; x <= x1; ++x, ++bi, cz += dz, cux += dux, cuy += duy, cuz += duz) {
-          if (cz >= z_buf[bi]) continue;
-          float inv_z = 1.0f / cuz;
-          int tx = (int)(cux * inv_z * tex_w) & tex_wm;
-          int ty = (int)(cuy * inv_z * tex_h) & tex_hm;
-          sf_pkd_clr_t texel = tex_px[ty * tex_w + tx];
-          if ((texel >> 24) == 0) continue;
-          uint32_t tr = (texel >> 16) & 0xFF;
-          uint32_t tg = (texel >> 8) & 0xFF;
-          uint32_t tb = texel & 0xFF;
-          uint32_t lr = (tr * li_r) >> 8; if (lr > 255) lr = 255;
-          uint32_t lg = (tg * li_g) >> 8; if (lg > 255) lg = 255;
-          uint32_t lb = (tb * li_b) >> 8; if (lb > 255) lb = 255;
-          if (opa_full) {
-            z_buf[bi] = cz;
-            cam_buf[bi] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[lr] << 16) | ((uint32_t)_sf_gamma_lut[lg] << 8) | _sf_gamma_lut[lb];
-          } else {
-            uint32_t bg = cam_buf[bi];
-            uint32_t bg_r = _sf_degamma_lut[(bg >> 16) & 0xFF];
-            uint32_t bg_g = _sf_degamma_lut[(bg >> 8)  & 0xFF];
-            uint32_t bg_b = _sf_degamma_lut[ bg         & 0xFF];
-            uint32_t fr = (lr * opa8 + bg_r * inv_opa8) >> 8; if (fr > 255) fr = 255;
-            uint32_t fg = (lg * opa8 + bg_g * inv_opa8) >> 8; if (fg > 255) fg = 255;
-            uint32_t fb = (lb * opa8 + bg_b * inv_opa8) >> 8; if (fb > 255) fb = 255;
-            cam_buf[bi] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[fr] << 16) | ((uint32_t)_sf_gamma_lut[fg] << 8) | _sf_gamma_lut[fb];
+        int bi = y * cam_w + x0, ci = y * cam_s + x0;
+        float qa = z16 ? _sf_depth_q16f(cz, zk) : 0.0f, qf = 0.0f, dq = 0.0f;
+        int   seg = x0;
+        for (int xa = x0; xa <= x1; xa += chunk, ci += chunk) {
+          int           n  = (x1 - xa + 1 < chunk) ? x1 - xa + 1 : chunk;
+          sf_pkd_clr_t *px = _sf_px_span(cam, tmp, ci, n);
+          for (int k = 0, x = xa; k < n; ++k, ++x, ++bi, cz += dz, cux += dux, cuy += duy, cuz += duz, qf += dq) {
+            uint16_t q = 0;
+            if (z16) {
+              if (x == seg) {
+                int   m  = (x1 - x + 1 < SF_DEPTH_SPAN) ? x1 - x + 1 : SF_DEPTH_SPAN;
+                float qb = _sf_depth_q16f(cz + dz * (float)m, zk);
+                qf = qa; dq = (qb - qa) / (float)m; qa = qb; seg += m;
+              }
+              q = (uint16_t)qf;
+              if (q >= z16[bi]) continue;
+            }
+            else if (cz >= z_buf[bi]) continue;
+            float inv_z = 1.0f / cuz;
+            int tx = (int)(cux * inv_z * tex_w) & tex_wm;
+            int ty = (int)(cuy * inv_z * tex_h) & tex_hm;
+            sf_pkd_clr_t texel = tex_px[ty * tex_w + tx];
+            if ((texel >> 24) == 0) continue;
+            uint32_t tr = (texel >> 16) & 0xFF;
+            uint32_t tg = (texel >> 8) & 0xFF;
+            uint32_t tb = texel & 0xFF;
+            uint32_t lr = (tr * li_r) >> 8; if (lr > 255) lr = 255;
+            uint32_t lg = (tg * li_g) >> 8; if (lg > 255) lg = 255;
+            uint32_t lb = (tb * li_b) >> 8; if (lb > 255) lb = 255;
+            if (opa_full) {
+              if (z16) z16[bi] = q; else z_buf[bi] = cz;
+              px[k] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[lr] << 16) | ((uint32_t)_sf_gamma_lut[lg] << 8) | _sf_gamma_lut[lb];
+            } else {
+              uint32_t bg = px[k];
+              uint32_t bg_r = _sf_degamma_lut[(bg >> 16) & 0xFF];
+              uint32_t bg_g = _sf_degamma_lut[(bg >> 8)  & 0xFF];
+              uint32_t bg_b = _sf_degamma_lut[ bg         & 0xFF];
+              uint32_t fr = (lr * opa8 + bg_r * inv_opa8) >> 8; if (fr > 255) fr = 255;
+              uint32_t fg = (lg * opa8 + bg_g * inv_opa8) >> 8; if (fg > 255) fg = 255;
+              uint32_t fb = (lb * opa8 + bg_b * inv_opa8) >> 8; if (fb > 255) fb = 255;
+              px[k] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[fr] << 16) | ((uint32_t)_sf_gamma_lut[fg] << 8) | _sf_gamma_lut[fb];
+            }
           }
+          _sf_px_flush(cam, tmp, ci, n);
         }
       }
       ax += dxa; az += dza; aux += duxa; auy += duya; auz += duza;
@@ -3445,13 +6129,14 @@ void sf_put_text(sf_ctx_t *ctx, sf_cam_t *cam, const char *text, sf_ivec2_t p, s
 }
 
 void sf_clear_depth(sf_ctx_t *ctx, sf_cam_t *cam) {
-  /* Reset the z-buffer to maximum depth (0x7F7F7F7F ≈ far). */
+  /* Reset the z-buffer to maximum depth (0x7F7F7F7F ≈ far for float, 0xFFFF for 16-bit). */
+  if (cam->z_buffer16) { memset(cam->z_buffer16, 0xFF, cam->buffer_size * sizeof(uint16_t)); return; }
   memset(cam->z_buffer, 0x7F, cam->buffer_size * sizeof(float));
 }
 
 void sf_draw_cam_pip(sf_ctx_t *ctx, sf_cam_t *dest, sf_cam_t *src, sf_ivec2_t pos) {
   /* Blit a secondary camera's buffer into dest at screen-space pos (picture-in-picture). */
-  if (!dest || !dest->buffer || !src || !src->buffer) return;
+  if (!dest || !src) return;
   int sx0 = 0, sy0 = 0;
   int dx0 = pos.x, dy0 = pos.y;
   int copy_w = src->w, copy_h = src->h;
@@ -3460,9 +6145,17 @@ void sf_draw_cam_pip(sf_ctx_t *ctx, sf_cam_t *dest, sf_cam_t *src, sf_ivec2_t po
   if (dx0 + copy_w > dest->w) copy_w = dest->w - dx0;
   if (dy0 + copy_h > dest->h) copy_h = dest->h - dy0;
   if (copy_w <= 0 || copy_h <= 0) return;
+  if (!dest->buffer || !src->buffer) {
+    for (int y = 0; y < copy_h; ++y) {
+      int si = (sy0 + y) * src->stride  + sx0;
+      int di = (dy0 + y) * dest->stride + dx0;
+      for (int x = 0; x < copy_w; ++x) _sf_put_px(dest, di + x, _sf_get_px(src, si + x));
+    }
+    return;
+  }
   for (int y = 0; y < copy_h; ++y) {
-    sf_pkd_clr_t *src_row = &src->buffer[(sy0 + y) * src->w + sx0];
-    sf_pkd_clr_t *dst_row = &dest->buffer[(dy0 + y) * dest->w + dx0];
+    sf_pkd_clr_t *src_row = &src->buffer[(sy0 + y) * src->stride  + sx0];
+    sf_pkd_clr_t *dst_row = &dest->buffer[(dy0 + y) * dest->stride + dx0];
     memcpy(dst_row, src_row, copy_w * sizeof(sf_pkd_clr_t));
   }
 }
@@ -3470,7 +6163,7 @@ void sf_draw_cam_pip(sf_ctx_t *ctx, sf_cam_t *dest, sf_cam_t *src, sf_ivec2_t po
 void sf_draw_cam_pip_scaled(sf_ctx_t *ctx, sf_cam_t *dest, sf_cam_t *src, sf_ivec2_t pos, int w, int h) {
   /* Blit a secondary camera's buffer into dest at pos, scaled to w x h pixels. */
   (void)ctx;
-  if (!dest || !dest->buffer || !src || !src->buffer || w <= 0 || h <= 0) return;
+  if (!dest || !src || w <= 0 || h <= 0) return;
   for (int y = 0; y < h; y++) {
     int py = pos.y + y;
     if (py < 0 || py >= dest->h) continue;
@@ -3479,7 +6172,7 @@ void sf_draw_cam_pip_scaled(sf_ctx_t *ctx, sf_cam_t *dest, sf_cam_t *src, sf_ive
       int px = pos.x + x;
       if (px < 0 || px >= dest->w) continue;
       int sx = (x * src->w) / w;
-      dest->buffer[py * dest->w + px] = src->buffer[sy * src->w + sx];
+      _sf_put_px(dest, py * dest->stride + px, _sf_get_px(src, sy * src->stride + sx));
     }
   }
 }
@@ -3523,16 +6216,16 @@ void sf_draw_debug_frames(sf_ctx_t *ctx, sf_cam_t *cam, float axis_size) {
   if (!ctx || !cam) return;
   sf_pkd_clr_t parent_link_clr = (sf_pkd_clr_t)0xFF555555;
   for (int i = 0; i < ctx->frames_count; ++i) {
-    sf_frame_t *f = &ctx->frames[i];
-    sf_fmat4_t M = f->global_M;
+    sf_frame_t *f = ctx->frames[i];
+    sf_fmat43_t M = f->global_M;
     sf_fvec3_t origin_w = { M.m[3][0], M.m[3][1], M.m[3][2] };
     sf_fvec3_t x_tip_w = sf_fvec3_add(origin_w, (sf_fvec3_t){ M.m[0][0] * axis_size, M.m[0][1] * axis_size, M.m[0][2] * axis_size });
     sf_fvec3_t y_tip_w = sf_fvec3_add(origin_w, (sf_fvec3_t){ M.m[1][0] * axis_size, M.m[1][1] * axis_size, M.m[1][2] * axis_size });
     sf_fvec3_t z_tip_w = sf_fvec3_add(origin_w, (sf_fvec3_t){ M.m[2][0] * axis_size, M.m[2][1] * axis_size, M.m[2][2] * axis_size });
-    sf_fvec3_t v_origin = sf_fmat4_mul_vec3(cam->V, origin_w);
-    sf_fvec3_t v_xtip   = sf_fmat4_mul_vec3(cam->V, x_tip_w);
-    sf_fvec3_t v_ytip   = sf_fmat4_mul_vec3(cam->V, y_tip_w);
-    sf_fvec3_t v_ztip   = sf_fmat4_mul_vec3(cam->V, z_tip_w);
+    sf_fvec3_t v_origin = sf_fmat43_mul_vec3(cam->V, origin_w);
+    sf_fvec3_t v_xtip   = sf_fmat43_mul_vec3(cam->V, x_tip_w);
+    sf_fvec3_t v_ytip   = sf_fmat43_mul_vec3(cam->V, y_tip_w);
+    sf_fvec3_t v_ztip   = sf_fmat43_mul_vec3(cam->V, z_tip_w);
     #define DRAW_CLIPPED_LINE(v0, v1, color) do { \
       sf_fvec3_t _a = v0, _b = v1; \
       bool a_in = _a.z <= -cam->near_plane; \
@@ -3550,7 +6243,7 @@ void sf_draw_debug_frames(sf_ctx_t *ctx, sf_cam_t *cam, float axis_size) {
     DRAW_CLIPPED_LINE(v_origin, v_ztip, SF_CLR_BLUE);
     if (f->parent && !f->is_root) {
       sf_fvec3_t p_origin_w = { f->parent->global_M.m[3][0], f->parent->global_M.m[3][1], f->parent->global_M.m[3][2] };
-      sf_fvec3_t v_p_origin = sf_fmat4_mul_vec3(cam->V, p_origin_w);
+      sf_fvec3_t v_p_origin = sf_fmat43_mul_vec3(cam->V, p_origin_w);
       DRAW_CLIPPED_LINE(v_origin, v_p_origin, parent_link_clr);
     }
     #undef DRAW_CLIPPED_LINE
@@ -3567,9 +6260,9 @@ void sf_draw_debug_lights(sf_ctx_t *ctx, sf_cam_t *cam, float size) {
   /* Draw a star (point) or arrow (dir) gizmo for each light in the scene. */
   if (!ctx || !cam) return;
   for (int i = 0; i < ctx->light_count; ++i) {
-    sf_light_t *l = &ctx->lights[i];
+    sf_light_t *l = ctx->lights[i];
     if (!l->frame) continue;
-    sf_fmat4_t M = l->frame->global_M;
+    sf_fmat43_t M = l->frame->global_M;
     sf_fvec3_t pos_w = { M.m[3][0], M.m[3][1], M.m[3][2] };
     sf_pkd_clr_t clr = _sf_pack_color((sf_unpkd_clr_t){
       (uint8_t)(l->color.x * 255), (uint8_t)(l->color.y * 255), 
@@ -3581,8 +6274,8 @@ void sf_draw_debug_lights(sf_ctx_t *ctx, sf_cam_t *cam, float size) {
       };
       for (int j = 0; j < 6; j++) {
         sf_fvec3_t p_w = sf_fvec3_add(pos_w, offsets[j]);
-        sf_fvec3_t v0 = sf_fmat4_mul_vec3(cam->V, pos_w);
-        sf_fvec3_t v1 = sf_fmat4_mul_vec3(cam->V, p_w);
+        sf_fvec3_t v0 = sf_fmat43_mul_vec3(cam->V, pos_w);
+        sf_fvec3_t v1 = sf_fmat43_mul_vec3(cam->V, p_w);
         if (v0.z <= -cam->near_plane && v1.z <= -cam->near_plane) {
           sf_fvec3_t s0 = _sf_project_vertex(ctx, cam, v0, cam->P);
           sf_fvec3_t s1 = _sf_project_vertex(ctx, cam, v1, cam->P);
@@ -3592,8 +6285,8 @@ void sf_draw_debug_lights(sf_ctx_t *ctx, sf_cam_t *cam, float size) {
     } else if (l->type == SF_LIGHT_DIR) {
       sf_fvec3_t dir_w = {-M.m[2][0] * size * 2, -M.m[2][1] * size * 2, -M.m[2][2] * size * 2};
       sf_fvec3_t end_w = sf_fvec3_add(pos_w, dir_w);
-      sf_fvec3_t v0 = sf_fmat4_mul_vec3(cam->V, pos_w);
-      sf_fvec3_t v1 = sf_fmat4_mul_vec3(cam->V, end_w);
+      sf_fvec3_t v0 = sf_fmat43_mul_vec3(cam->V, pos_w);
+      sf_fvec3_t v1 = sf_fmat43_mul_vec3(cam->V, end_w);
       if (v0.z <= -cam->near_plane && v1.z <= -cam->near_plane) {
         sf_fvec3_t s0 = _sf_project_vertex(ctx, cam, v0, cam->P);
         sf_fvec3_t s1 = _sf_project_vertex(ctx, cam, v1, cam->P);
@@ -3609,7 +6302,7 @@ void sf_draw_debug_cams(sf_ctx_t *ctx, sf_cam_t *view_cam, float ray_len) {
   for (int i = 0; i < ctx->cam_count; ++i) {
     sf_cam_t *c = &ctx->cameras[i];
     if (!c->frame || c == view_cam) continue;
-    sf_fmat4_t M = c->frame->global_M;
+    sf_fmat43_t M = c->frame->global_M;
     sf_fvec3_t origin_w = { M.m[3][0], M.m[3][1], M.m[3][2] };
     float aspect = (float)c->w / (float)c->h;
     float h_half = tanf(SF_DEG2RAD(c->fov) * 0.5f) * ray_len;
@@ -3622,9 +6315,9 @@ void sf_draw_debug_cams(sf_ctx_t *ctx, sf_cam_t *view_cam, float ray_len) {
     };
     sf_fvec3_t corners_w[4];
     for (int j = 0; j < 4; j++) {
-      corners_w[j] = sf_fmat4_mul_vec3(M, corners[j]);
-      sf_fvec3_t v0 = sf_fmat4_mul_vec3(view_cam->V, origin_w);
-      sf_fvec3_t v1 = sf_fmat4_mul_vec3(view_cam->V, corners_w[j]);
+      corners_w[j] = sf_fmat43_mul_vec3(M, corners[j]);
+      sf_fvec3_t v0 = sf_fmat43_mul_vec3(view_cam->V, origin_w);
+      sf_fvec3_t v1 = sf_fmat43_mul_vec3(view_cam->V, corners_w[j]);
       if (v0.z <= -view_cam->near_plane && v1.z <= -view_cam->near_plane) {
         sf_fvec3_t s0 = _sf_project_vertex(ctx, view_cam, v0, view_cam->P);
         sf_fvec3_t s1 = _sf_project_vertex(ctx, view_cam, v1, view_cam->P);
@@ -3632,8 +6325,8 @@ void sf_draw_debug_cams(sf_ctx_t *ctx, sf_cam_t *view_cam, float ray_len) {
       }
     }
     for (int j = 0; j < 4; j++) {
-      sf_fvec3_t v0 = sf_fmat4_mul_vec3(view_cam->V, corners_w[j]);
-      sf_fvec3_t v1 = sf_fmat4_mul_vec3(view_cam->V, corners_w[(j+1)%4]);
+      sf_fvec3_t v0 = sf_fmat43_mul_vec3(view_cam->V, corners_w[j]);
+      sf_fvec3_t v1 = sf_fmat43_mul_vec3(view_cam->V, corners_w[(j+1)%4]);
       if (v0.z <= -view_cam->near_plane && v1.z <= -view_cam->near_plane) {
         sf_fvec3_t s0 = _sf_project_vertex(ctx, view_cam, v0, view_cam->P);
         sf_fvec3_t s1 = _sf_project_vertex(ctx, view_cam, v1, view_cam->P);
@@ -3701,7 +6394,7 @@ void sf_draw_sprite(sf_ctx_t *ctx, sf_cam_t *cam, sf_sprite_2_t *spr, sf_fvec3_t
   int frame_idx = (int)(anim_time / spr->frame_duration) % spr->frame_count;
   sf_tex_t *tex = spr->frames[frame_idx];
   if (!tex) return;
-  sf_fvec3_t v_view = sf_fmat4_mul_vec3(cam->V, pos_w);
+  sf_fvec3_t v_view = sf_fmat43_mul_vec3(cam->V, pos_w);
   if (v_view.z >= -cam->near_plane) return;
   sf_fvec3_t center_scr = _sf_project_vertex(ctx, cam, v_view, cam->P);
   float actual_scale = spr->base_scale * scale_mult;
@@ -3720,9 +6413,11 @@ void sf_draw_sprite(sf_ctx_t *ctx, sf_cam_t *cam, sf_sprite_2_t *spr, sf_fvec3_t
   if (span_w <= 0 || span_h <= 0) return;
   int tex_w = tex->w, tex_h = tex->h;
   sf_pkd_clr_t *tex_px = tex->px;
-  int cam_w = cam->w, cam_h = cam->h;
+  int cam_w = cam->w, cam_h = cam->h, cam_s = cam->stride;
   sf_pkd_clr_t *cam_buf = cam->buffer;
   float *z_buf = cam->z_buffer;
+  uint16_t *z16 = cam->z_buffer16;
+  uint16_t cq = z16 ? _sf_depth_to_q16(cz, _sf_depth_q16_k(cam)) : 0;
   int y0 = ys < 0 ? 0 : ys;
   int y1 = ye >= cam_h ? cam_h - 1 : ye - 1;
   int x0 = xs < 0 ? 0 : xs;
@@ -3730,31 +6425,38 @@ void sf_draw_sprite(sf_ctx_t *ctx, sf_cam_t *cam, sf_sprite_2_t *spr, sf_fvec3_t
   uint8_t a8 = (uint8_t)(scale_mult * 255.0f + 0.5f);
   bool opaque = (a8 >= 252);
   uint8_t inv_a8 = 255 - a8;
+  sf_pkd_clr_t tmp[2 * SF_PX_CHUNK];
+  int chunk = cam_buf ? cam_w : SF_PX_CHUNK;
   for (int y = y0; y <= y1; y++) {
     int ty = ((y - ys) * tex_h / span_h) % tex_h;
-    int row = y * cam_w;
-    for (int x = x0; x <= x1; x++) {
-      int bi = row + x;
-      if (cz >= z_buf[bi]) continue;
-      int tx = ((x - xs) * tex_w / span_w) % tex_w;
-      sf_pkd_clr_t texel = tex_px[ty * tex_w + tx];
-      if ((texel >> 24) == 0) continue;
-      uint32_t tr = (texel >> 16) & 0xFF;
-      uint32_t tg = (texel >> 8) & 0xFF;
-      uint32_t tb = texel & 0xFF;
-      if (opaque) {
-        z_buf[bi] = cz;
-        cam_buf[bi] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[tr] << 16) | ((uint32_t)_sf_gamma_lut[tg] << 8) | _sf_gamma_lut[tb];
-      } else {
-        uint32_t bg = cam_buf[bi];
-        uint32_t bg_lr = _sf_degamma_lut[(bg >> 16) & 0xFF];
-        uint32_t bg_lg = _sf_degamma_lut[(bg >> 8) & 0xFF];
-        uint32_t bg_lb = _sf_degamma_lut[bg & 0xFF];
-        uint32_t or_ = (tr * a8 + bg_lr * inv_a8) >> 8; if (or_ > 255) or_ = 255;
-        uint32_t og  = (tg * a8 + bg_lg * inv_a8) >> 8; if (og > 255) og = 255;
-        uint32_t ob  = (tb * a8 + bg_lb * inv_a8) >> 8; if (ob > 255) ob = 255;
-        cam_buf[bi] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[or_] << 16) | ((uint32_t)_sf_gamma_lut[og] << 8) | _sf_gamma_lut[ob];
+    int row = y * cam_w, crow = y * cam_s;
+    for (int xa = x0; xa <= x1; xa += chunk) {
+      int           n  = (x1 - xa + 1 < chunk) ? x1 - xa + 1 : chunk;
+      sf_pkd_clr_t *px = _sf_px_span(cam, tmp, crow + xa, n);
+      for (int x = xa; x < xa + n; x++) {
+        int bi = row + x;
+        if (z16 ? cq >= z16[bi] : cz >= z_buf[bi]) continue;
+        int tx = ((x - xs) * tex_w / span_w) % tex_w;
+        sf_pkd_clr_t texel = tex_px[ty * tex_w + tx];
+        if ((texel >> 24) == 0) continue;
+        uint32_t tr = (texel >> 16) & 0xFF;
+        uint32_t tg = (texel >> 8) & 0xFF;
+        uint32_t tb = texel & 0xFF;
+        if (opaque) {
+          if (z16) z16[bi] = cq; else z_buf[bi] = cz;
+          px[x - xa] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[tr] << 16) | ((uint32_t)_sf_gamma_lut[tg] << 8) | _sf_gamma_lut[tb];
+        } else {
+          uint32_t bg = px[x - xa];
+          uint32_t bg_lr = _sf_degamma_lut[(bg >> 16) & 0xFF];
+          uint32_t bg_lg = _sf_degamma_lut[(bg >> 8) & 0xFF];
+          uint32_t bg_lb = _sf_degamma_lut[bg & 0xFF];
+          uint32_t or_ = (tr * a8 + bg_lr * inv_a8) >> 8; if (or_ > 255) or_ = 255;
+          uint32_t og  = (tg * a8 + bg_lg * inv_a8) >> 8; if (og > 255) og = 255;
+          uint32_t ob  = (tb * a8 + bg_lb * inv_a8) >> 8; if (ob > 255) ob = 255;
+          px[x - xa] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[or_] << 16) | ((uint32_t)_sf_gamma_lut[og] << 8) | _sf_gamma_lut[ob];
+        }
       }
+      _sf_px_flush(cam, tmp, crow + xa, n);
     }
   }
 }
@@ -3770,14 +6472,14 @@ void sf_draw_sprite_3d(sf_ctx_t *ctx, sf_cam_t *cam, sf_sprite_3_t *bill, float
   sf_fvec3_t world_pos = bill->pos;
   sf_fvec3_t world_normal = bill->normal;
   if (bill->frame) {
-    sf_fmat4_t gM = bill->frame->global_M;
-    world_pos = sf_fmat4_mul_vec3(gM, bill->pos);
+    sf_fmat43_t gM = _sf_render_M(ctx, cam, bill->frame);
+    world_pos = sf_fmat43_mul_vec3(gM, bill->pos);
     world_normal.x = bill->normal.x*gM.m[0][0] + bill->normal.y*gM.m[1][0] + bill->normal.z*gM.m[2][0];
     world_normal.y = bill->normal.x*gM.m[0][1] + bill->normal.y*gM.m[1][1] + bill->normal.z*gM.m[2][1];
     world_normal.z = bill->normal.x*gM.m[0][2] + bill->normal.y*gM.m[1][2] + bill->normal.z*gM.m[2][2];
   }
 
-  sf_fvec3_t v_view = sf_fmat4_mul_vec3(cam->V, world_pos);
+  sf_fvec3_t v_view = sf_fmat43_mul_vec3(cam->V, world_pos);
   if (v_view.z >= -cam->near_plane) return;
 
   float nl2 = world_normal.x*world_normal.x + world_normal.y*world_normal.y + world_normal.z*world_normal.z;
@@ -3798,7 +6500,7 @@ void sf_draw_sprite_3d(sf_ctx_t *ctx, sf_cam_t *cam, sf_sprite_3_t *bill, float
     float uvals[4][2] = {{0.f,0.f},{0.999f,0.f},{0.999f,0.999f},{0.f,0.999f}};
     sf_fvec3_t vv[4], uvz[4], sv[4];
     for (int i = 0; i < 4; i++) {
-      vv[i] = sf_fmat4_mul_vec3(cam->V, corners[i]);
+      vv[i] = sf_fmat43_mul_vec3(cam->V, corners[i]);
       if (vv[i].z >= -cam->near_plane) return;
       float iz = 1.f / vv[i].z;
       uvz[i] = (sf_fvec3_t){uvals[i][0]*iz, uvals[i][1]*iz, iz};
@@ -3832,46 +6534,54 @@ void sf_draw_sprite_3d(sf_ctx_t *ctx, sf_cam_t *cam, sf_sprite_3_t *bill, float
   uint8_t inv_a8 = 255 - a8;
   int tex_w = tex->w, tex_h = tex->h;
   sf_pkd_clr_t *tex_px = tex->px;
+  uint16_t *z16 = cam->z_buffer16;
+  uint16_t cq = z16 ? _sf_depth_to_q16(cz, _sf_depth_q16_k(cam)) : 0;
+  sf_pkd_clr_t tmp[2 * SF_PX_CHUNK];
+  int chunk = cam->buffer ? cam->w : SF_PX_CHUNK;
   for (int y = y0; y <= y1; y++) {
     float ry = (float)y - cy;
-    int row = y * cam->w;
-    for (int x = x0; x <= x1; x++) {
-      float rx = (float)x - cx;
-      float lx =  rx * ca + ry * sa;
-      float ly = -rx * sa + ry * ca;
-      if (lx < -hw || lx > hw || ly < -hh || ly > hh) continue;
-      int bi = row + x;
-      if (cz >= cam->z_buffer[bi]) continue;
-      int tx = (int)((lx / hw + 1.f) * 0.5f * (float)(tex_w - 1) + 0.5f);
-      int ty = (int)((ly / hh + 1.f) * 0.5f * (float)(tex_h - 1) + 0.5f);
-      if (tx < 0) tx = 0; if (tx >= tex_w) tx = tex_w - 1;
-      if (ty < 0) ty = 0; if (ty >= tex_h) ty = tex_h - 1;
-      sf_pkd_clr_t texel = tex_px[ty * tex_w + tx];
-      if ((texel >> 24) == 0) continue;
-      uint32_t tr = (texel >> 16) & 0xFF;
-      uint32_t tg = (texel >> 8)  & 0xFF;
-      uint32_t tb =  texel         & 0xFF;
-      if (opaque) {
-        cam->z_buffer[bi] = cz;
-        cam->buffer[bi] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[tr] << 16) | ((uint32_t)_sf_gamma_lut[tg] << 8) | _sf_gamma_lut[tb];
-      } else {
-        cam->z_buffer[bi] = cz;
-        uint32_t bg = cam->buffer[bi];
-        uint32_t bg_lr = _sf_degamma_lut[(bg >> 16) & 0xFF];
-        uint32_t bg_lg = _sf_degamma_lut[(bg >> 8)  & 0xFF];
-        uint32_t bg_lb = _sf_degamma_lut[ bg         & 0xFF];
-        uint32_t or_ = (tr * a8 + bg_lr * inv_a8) >> 8; if (or_ > 255) or_ = 255;
-        uint32_t og  = (tg * a8 + bg_lg * inv_a8) >> 8; if (og  > 255) og  = 255;
-        uint32_t ob  = (tb * a8 + bg_lb * inv_a8) >> 8; if (ob  > 255) ob  = 255;
-        cam->buffer[bi] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[or_] << 16) | ((uint32_t)_sf_gamma_lut[og] << 8) | _sf_gamma_lut[ob];
+    int row = y * cam->w, crow = y * cam->stride;
+    for (int xa = x0; xa <= x1; xa += chunk) {
+      int           n  = (x1 - xa + 1 < chunk) ? x1 - xa + 1 : chunk;
+      sf_pkd_clr_t *px = _sf_px_span(cam, tmp, crow + xa, n);
+      for (int x = xa; x < xa + n; x++) {
+        float rx = (float)x - cx;
+        float lx =  rx * ca + ry * sa;
+        float ly = -rx * sa + ry * ca;
+        if (lx < -hw || lx > hw || ly < -hh || ly > hh) continue;
+        int bi = row + x;
+        if (z16 ? cq >= z16[bi] : cz >= cam->z_buffer[bi]) continue;
+        int tx = (int)((lx / hw + 1.f) * 0.5f * (float)(tex_w - 1) + 0.5f);
+        int ty = (int)((ly / hh + 1.f) * 0.5f * (float)(tex_h - 1) + 0.5f);
+        if (tx < 0) tx = 0; if (tx >= tex_w) tx = tex_w - 1;
+        if (ty < 0) ty = 0; if (ty >= tex_h) ty = tex_h - 1;
+        sf_pkd_clr_t texel = tex_px[ty * tex_w + tx];
+        if ((texel >> 24) == 0) continue;
+        uint32_t tr = (texel >> 16) & 0xFF;
+        uint32_t tg = (texel >> 8)  & 0xFF;
+        uint32_t tb =  texel         & 0xFF;
+        if (z16) z16[bi] = cq; else cam->z_buffer[bi] = cz;
+        if (opaque) {
+          px[x - xa] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[tr] << 16) | ((uint32_t)_sf_gamma_lut[tg] << 8) | _sf_gamma_lut[tb];
+        } else {
+          uint32_t bg = px[x - xa];
+          uint32_t bg_lr = _sf_degamma_lut[(bg >> 16) & 0xFF];
+          uint32_t bg_lg = _sf_degamma_lut[(bg >> 8)  & 0xFF];
+          uint32_t bg_lb = _sf_degamma_lut[ bg         & 0xFF];
+          uint32_t or_ = (tr * a8 + bg_lr * inv_a8) >> 8; if (or_ > 255) or_ = 255;
+          uint32_t og  = (tg * a8 + bg_lg * inv_a8) >> 8; if (og  > 255) og  = 255;
+          uint32_t ob  = (tb * a8 + bg_lb * inv_a8) >> 8; if (ob  > 255) ob  = 255;
+          px[x - xa] = 0xFF000000u | ((uint32_t)_sf_gamma_lut[or_] << 16) | ((uint32_t)_sf_gamma_lut[og] << 8) | _sf_gamma_lut[ob];
+        }
       }
+      _sf_px_flush(cam, tmp, crow + xa, n);
     }
   }
 }
 
 sf_sprite_3_t* sf_add_sprite_3d(sf_ctx_t *ctx, sf_sprite_2_t *spr, const char *name, sf_fvec3_t pos, float scale, float opacity, float angle) {
   /* Add a billboard instance to the scene's bill pool. */
-  if (!ctx || ctx->sprite_3d_count >= SF_MAX_SPRITE_3DS) return NULL;
+  if (!ctx || ctx->sprite_3d_count >= ctx->sprite_3d_cap) return NULL;
   sf_sprite_3_t *b = &ctx->sprite_3ds[ctx->sprite_3d_count++];
   if (name) { int i; for (i = 0; i < 31 && name[i]; i++) b->name[i] = name[i]; b->name[i] = '\0'; }
   else { b->name[0] = '\0'; }
@@ -3882,6 +6592,7 @@ sf_sprite_3_t* sf_add_sprite_3d(sf_ctx_t *ctx, sf_sprite_2_t *spr, const char *n
   b->angle   = angle;
   b->normal  = (sf_fvec3_t){0.f, 0.f, 0.f};
   b->frame   = NULL;
+  b->layers  = SF_LAYER_DEFAULT;
   return b;
 }
 
@@ -4799,7 +7510,7 @@ void _sf_draw_image(sf_ctx_t *ctx, sf_cam_t *cam, sf_ui_lmn_t *el) {
       int sx = (x * tex->w) / dw;
       sf_pkd_clr_t c = tex->px[sy * tex->w + sx];
       if (keyed && (c >> 24) == 0) continue;
-      cam->buffer[py * cam->w + px_] = c;
+      _sf_put_px(cam, py * cam->stride + px_, c);
     }
   }
 }
@@ -4999,23 +7710,25 @@ sf_obj_t* sf_obj_create_empty(sf_ctx_t *ctx, const char *objname, int max_v, int
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "obj '%s' name in use\n", objname);
     return NULL;
   }
-  if (ctx->obj_count >= SF_MAX_OBJS) {
+  if (ctx->obj_count >= ctx->obj_cap) {
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "obj '%s' max reached\n", objname);
     return NULL;
   }
   sf_obj_t *obj = &ctx->objs[ctx->obj_count++];
   memset(obj, 0, sizeof(sf_obj_t));
+  obj->_ctx   = ctx;
   obj->v_cap  = max_v;
   obj->vt_cap = max_vt;
   obj->f_cap  = max_f;
-  obj->v  = sf_arena_alloc(ctx, &ctx->arena, max_v  * sizeof(sf_fvec3_t));
-  obj->vt = max_vt > 0 ? sf_arena_alloc(ctx, &ctx->arena, max_vt * sizeof(sf_fvec2_t)) : NULL;
-  obj->f  = sf_arena_alloc(ctx, &ctx->arena, max_f  * sizeof(sf_face_t));
+  obj->v  = sf_heap_alloc(ctx, max_v  * sizeof(sf_fvec3_t));
+  obj->vt = max_vt > 0 ? sf_heap_alloc(ctx, max_vt * sizeof(sf_fvec2_t)) : NULL;
+  obj->f  = sf_heap_alloc(ctx, max_f  * sizeof(sf_face_t));
   obj->id = ctx->obj_count - 1;
 
   size_t nlen = strlen(objname) + 1;
-  obj->name = (const char*)sf_arena_alloc(ctx, &ctx->arena, nlen);
+  obj->name = (const char*)sf_heap_alloc(ctx, nlen);
   if (obj->name) memcpy((void*)obj->name, objname, nlen);
+  _sf_names_put(ctx, &ctx->names[SF_NAME_OBJ], obj->name, obj);
 
   SF_LOG(ctx, SF_LOG_INFO,
               SF_LOG_INDENT "name   : %s\n"
@@ -5026,9 +7739,18 @@ sf_obj_t* sf_obj_create_empty(sf_ctx_t *ctx, const char *objname, int max_v, int
   return obj;
 }
 
+void _sf_obj_touch(sf_obj_t *obj) {
+  /* Finish any pipelined frame still reading obj before it is edited, and mark the scene changed. */
+  if (!obj->_ctx) return;
+  sf_render_sync(obj->_ctx);
+  obj->_ctx->_scene_gen++;
+}
+
 int sf_obj_add_vert(sf_obj_t *obj, sf_fvec3_t p) {
   /* Append a vertex position; returns its index or -1 if the array is full. */
   if (!obj || obj->v_cnt >= obj->v_cap) return -1;
+  if (obj->weld) obj->weld->valid = false;
+  _sf_obj_touch(obj);
   obj->v[obj->v_cnt] = p;
   return obj->v_cnt++;
 }
@@ -5036,6 +7758,8 @@ int sf_obj_add_vert(sf_obj_t *obj, sf_fvec3_t p) {
 int sf_obj_add_uv(sf_obj_t *obj, sf_fvec2_t uv) {
   /* Append a UV coordinate; returns its index or -1 if the array is full. */
   if (!obj || obj->vt_cnt >= obj->vt_cap) return -1;
+  if (obj->weld) obj->weld->valid = false;
+  _sf_obj_touch(obj);
   obj->vt[obj->vt_cnt] = uv;
   return obj->vt_cnt++;
 }
@@ -5043,6 +7767,8 @@ int sf_obj_add_uv(sf_obj_t *obj, sf_fvec2_t uv) {
 int sf_obj_add_face(sf_obj_t *obj, int i0, int i1, int i2) {
   /* Append a triangle face by vertex indices only (no UV mapping). */
   if (!obj || obj->f_cnt >= obj->f_cap) return -1;
+  if (obj->weld) obj->weld->valid = false;
+  _sf_obj_touch(obj);
   sf_face_t *f = &obj->f[obj->f_cnt];
   f->idx[0] = (sf_vtx_idx_t){i0, -1, -1};
   f->idx[1] = (sf_vtx_idx_t){i1, -1, -1};
@@ -5053,6 +7779,8 @@ int sf_obj_add_face(sf_obj_t *obj, int i0, int i1, int i2) {
 int sf_obj_add_face_uv(sf_obj_t *obj, int v0, int v1, int v2, int t0, int t1, int t2) {
   /* Append a triangle face with per-corner UV indices. */
   if (!obj || obj->f_cnt >= obj->f_cap) return -1;
+  if (obj->weld) obj->weld->valid = false;
+  _sf_obj_touch(obj);
   sf_face_t *f = &obj->f[obj->f_cnt];
   f->idx[0] = (sf_vtx_idx_t){v0, t0, -1};
   f->idx[1] = (sf_vtx_idx_t){v1, t1, -1};
@@ -5073,10 +7801,223 @@ void sf_obj_recompute_bs(sf_obj_t *obj) {
     float d2 = dx*dx + dy*dy + dz*dz;
     if (d2 > r2) r2 = d2;
   }
+  _sf_obj_touch(obj);
   obj->bs_center = c;
   obj->bs_radius = sqrtf(r2);
 }
 
+bool sf_obj_weld(sf_ctx_t *ctx, sf_obj_t *obj) {
+  /* Merge corners with equal position and UV into an indexed render copy; edits mark it stale until rebuilt. */
+  if (!ctx || !obj || !obj->f || obj->f_cnt <= 0) return false;
+  bool uv    = obj->vt && obj->vt_cnt > 0 && obj->f[0].idx[0].vt >= 0;
+  bool quant = obj->weld && obj->weld->quant;
+  for (int i = 0; i < obj->f_cnt; i++) {
+    for (int j = 0; j < 3; j++) {
+      sf_vtx_idx_t c = obj->f[i].idx[j];
+      if (c.v < 0 || c.v >= obj->v_cnt || (uv ? (c.vt < 0 || c.vt >= obj->vt_cnt) : c.vt >= 0)) {
+        SF_LOG(ctx, SF_LOG_WARN, SF_LOG_INDENT "not welding '%s', face %d mixes or overruns indices\n",
+                    obj->name ? obj->name : "(null)", i);
+        if (obj->weld) obj->weld->valid = false;
+        return false;
+      }
+    }
+  }
+  int32_t     n_c  = obj->f_cnt * 3;
+  int32_t     n_hs = 16;
+  while (n_hs < 2 * n_c) n_hs <<= 1;
+  int32_t    *hs   = (int32_t*)malloc((size_t)n_hs * sizeof(int32_t));
+  uint32_t   *idx  = (uint32_t*)malloc((size_t)n_c * sizeof(uint32_t));
+  sf_fvec3_t *wv   = (sf_fvec3_t*)malloc((size_t)n_c * sizeof(sf_fvec3_t));
+  sf_fvec2_t *wt   = (sf_fvec2_t*)malloc((size_t)n_c * sizeof(sf_fvec2_t));
+  if (!hs || !idx || !wv || !wt) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to weld '%s', no scratch for %d corners\n", obj->name ? obj->name : "(null)", n_c);
+    free(hs); free(idx); free(wv); free(wt);
+    return false;
+  }
+  memset(hs, 0xFF, (size_t)n_hs * sizeof(int32_t));
+  int32_t n_w = 0;
+  for (int k = 0; k < n_c; k++) {
+    sf_vtx_idx_t c   = obj->f[k / 3].idx[k % 3];
+    sf_fvec3_t   p   = obj->v[c.v];
+    sf_fvec2_t   t   = uv ? obj->vt[c.vt] : (sf_fvec2_t){0.0f, 0.0f};
+    uint64_t     h   = _sf_fnv1a(_sf_fnv1a(14695981039346656037ull, &p, sizeof(p)), &t, sizeof(t));
+    int32_t      s   = (int32_t)(h & (uint64_t)(n_hs - 1));
+    while (hs[s] >= 0 && (memcmp(&wv[hs[s]], &p, sizeof(p)) || memcmp(&wt[hs[s]], &t, sizeof(t)))) s = (s + 1) & (n_hs - 1);
+    if (hs[s] < 0) {
+      hs[s]     = n_w;
+      wv[n_w]   = p;
+      wt[n_w++] = t;
+    }
+    idx[k] = (uint32_t)hs[s];
+  }
+  free(hs);
+
+  sf_render_sync(ctx);
+  if (!obj->weld) {
+    obj->weld = (sf_weld_t*)sf_heap_alloc(ctx, sizeof(sf_weld_t));
+    if (obj->weld) memset(obj->weld, 0, sizeof(sf_weld_t));
+  }
+  sf_weld_t *w = obj->weld;
+  if (w) {
+    sf_heap_free(ctx, w->v);
+    sf_heap_free(ctx, w->vt);
+    sf_heap_free(ctx, w->idx16);
+    sf_heap_free(ctx, w->idx32);
+    sf_heap_free(ctx, w->qv);
+    sf_heap_free(ctx, w->qt);
+    memset(w, 0, sizeof(sf_weld_t));
+    w->v     = (sf_fvec3_t*)sf_heap_alloc(ctx, (size_t)n_w * sizeof(sf_fvec3_t));
+    w->vt    = uv ? (sf_fvec2_t*)sf_heap_alloc(ctx, (size_t)n_w * sizeof(sf_fvec2_t)) : NULL;
+    w->idx16 = (n_w <= 65536) ? (uint16_t*)sf_heap_alloc(ctx, (size_t)n_c * sizeof(uint16_t)) : NULL;
+    w->idx32 = (n_w >  65536) ? (uint32_t*)sf_heap_alloc(ctx, (size_t)n_c * sizeof(uint32_t)) : NULL;
+  }
+  if (!w || !w->v || (uv && !w->vt) || (!w->idx16 && !w->idx32)) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to weld '%s', no heap for %d verts\n", obj->name ? obj->name : "(null)", n_w);
+    free(idx); free(wv); free(wt);
+    return false;
+  }
+  memcpy(w->v, wv, (size_t)n_w * sizeof(sf_fvec3_t));
+  if (uv) memcpy(w->vt, wt, (size_t)n_w * sizeof(sf_fvec2_t));
+  for (int k = 0; k < n_c; k++) {
+    if (w->idx16) w->idx16[k] = (uint16_t)idx[k];
+    else          w->idx32[k] = idx[k];
+  }
+  w->v_cnt = n_w;
+  w->f_cnt = obj->f_cnt;
+  w->valid = true;
+  for (int i = 0; i < ctx->enti_count; i++) {
+    sf_obj_t *m = &ctx->entities[i]->obj;
+    if (m != obj && m->v == obj->v && m->f == obj->f) m->weld = w;
+  }
+  ctx->_scene_gen++;
+  free(idx); free(wv); free(wt);
+  if (quant) sf_obj_quantize(ctx, obj);
+  SF_LOG(ctx, SF_LOG_INFO,
+              SF_LOG_INDENT "name   : %s\n"
+              SF_LOG_INDENT "corners: %d\n"
+              SF_LOG_INDENT "welded : %d\n"
+              SF_LOG_INDENT "index  : %d-bit\n",
+              obj->name ? obj->name : "(null)", n_c, n_w, w->idx16 ? 16 : 32);
+  return true;
+}
+
+bool sf_obj_quantize(sf_ctx_t *ctx, sf_obj_t *obj) {
+  /* Store obj's weld (welding first if needed) as 16-bit positions and UVs, freeing its float copy. */
+  if (!ctx || !obj) return false;
+  if ((!obj->weld || !obj->weld->valid) && !sf_obj_weld(ctx, obj)) return false;
+  sf_weld_t *w = obj->weld;
+  if (w->qv) return true;
+  sf_fvec3_t lo = w->v[0], hi = w->v[0];
+  sf_fvec2_t tlo = {0.0f, 0.0f}, thi = {0.0f, 0.0f};
+  if (w->vt) tlo = thi = w->vt[0];
+  for (int i = 1; i < w->v_cnt; i++) {
+    lo  = (sf_fvec3_t){ fminf(lo.x, w->v[i].x), fminf(lo.y, w->v[i].y), fminf(lo.z, w->v[i].z) };
+    hi  = (sf_fvec3_t){ fmaxf(hi.x, w->v[i].x), fmaxf(hi.y, w->v[i].y), fmaxf(hi.z, w->v[i].z) };
+    if (!w->vt) continue;
+    tlo = (sf_fvec2_t){ fminf(tlo.x, w->vt[i].x), fminf(tlo.y, w->vt[i].y) };
+    thi = (sf_fvec2_t){ fmaxf(thi.x, w->vt[i].x), fmaxf(thi.y, w->vt[i].y) };
+  }
+  int16_t  *qv = (int16_t*)sf_heap_alloc(ctx, (size_t)w->v_cnt * 3 * sizeof(int16_t));
+  uint16_t *qt = w->vt ? (uint16_t*)sf_heap_alloc(ctx, (size_t)w->v_cnt * 2 * sizeof(uint16_t)) : NULL;
+  if (!qv || (w->vt && !qt)) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to quantize '%s', no heap for %d verts\n", obj->name ? obj->name : "(null)", w->v_cnt);
+    sf_heap_free(ctx, qv);
+    sf_heap_free(ctx, qt);
+    return false;
+  }
+  sf_fvec3_t c  = { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f };
+  sf_fvec3_t qs = { (hi.x - lo.x) * 0.5f / 32767.0f, (hi.y - lo.y) * 0.5f / 32767.0f, (hi.z - lo.z) * 0.5f / 32767.0f };
+  sf_fvec2_t ts = { (thi.x - tlo.x) / 65535.0f, (thi.y - tlo.y) / 65535.0f };
+  for (int i = 0; i < w->v_cnt; i++) {
+    qv[i * 3]     = (int16_t)(qs.x > 0.0f ? lrintf((w->v[i].x - c.x) / qs.x) : 0);
+    qv[i * 3 + 1] = (int16_t)(qs.y > 0.0f ? lrintf((w->v[i].y - c.y) / qs.y) : 0);
+    qv[i * 3 + 2] = (int16_t)(qs.z > 0.0f ? lrintf((w->v[i].z - c.z) / qs.z) : 0);
+    if (!qt) continue;
+    qt[i * 2]     = (uint16_t)(ts.x > 0.0f ? lrintf((w->vt[i].x - tlo.x) / ts.x) : 0);
+    qt[i * 2 + 1] = (uint16_t)(ts.y > 0.0f ? lrintf((w->vt[i].y - tlo.y) / ts.y) : 0);
+  }
+  sf_render_sync(ctx);
+  sf_heap_free(ctx, w->v);
+  sf_heap_free(ctx, w->vt);
+  w->v     = NULL;
+  w->vt    = NULL;
+  w->qv    = qv;
+  w->qt    = qt;
+  w->q_c   = c;
+  w->q_s   = qs;
+  w->qt_o  = tlo;
+  w->qt_s  = ts;
+  w->quant = true;
+  ctx->_scene_gen++;
+  SF_LOG(ctx, SF_LOG_INFO,
+              SF_LOG_INDENT "name   : %s\n"
+              SF_LOG_INDENT "verts  : %d\n"
+              SF_LOG_INDENT "step   : %g %g %g\n",
+              obj->name ? obj->name : "(null)", w->v_cnt, qs.x, qs.y, qs.z);
+  return true;
+}
+
+sf_fmat43_t _sf_weld_dequant(const sf_weld_t *w) {
+  /* The affine map from a quantized weld's int16 positions to mesh space, to be composed ahead of a model matrix. */
+  return (sf_fmat43_t){{ {w->q_s.x, 0, 0}, {0, w->q_s.y, 0}, {0, 0, w->q_s.z}, {w->q_c.x, w->q_c.y, w->q_c.z} }};
+}
+
+bool sf_obj_strip(sf_ctx_t *ctx, sf_obj_t *obj) {
+  /* Free obj's float arrays and keep only its weld (welding first if needed), along with entities sharing them. */
+  if (!ctx || !obj) return false;
+  if (!obj->f) return obj->weld && obj->weld->valid;
+  if ((!obj->weld || !obj->weld->valid) && !sf_obj_weld(ctx, obj)) return false;
+  size_t before = _sf_obj_memusg(obj);
+  sf_render_sync(ctx);
+  for (int i = 0; i < ctx->enti_count; i++) {
+    sf_obj_t *m = &ctx->entities[i]->obj;
+    if (m == obj || m->v != obj->v || m->f != obj->f) continue;
+    m->v      = NULL;
+    m->vt     = NULL;
+    m->vn     = NULL;
+    m->f      = NULL;
+    m->v_cnt  = m->vt_cnt = m->vn_cnt = 0;
+    m->v_cap  = m->vt_cap = m->f_cap  = 0;
+    m->weld   = obj->weld;
+  }
+  sf_heap_free(ctx, obj->v);
+  sf_heap_free(ctx, obj->vt);
+  sf_heap_free(ctx, obj->vn);
+  sf_heap_free(ctx, obj->f);
+  obj->v     = NULL;
+  obj->vt    = NULL;
+  obj->vn    = NULL;
+  obj->f     = NULL;
+  obj->v_cnt = obj->vt_cnt = obj->vn_cnt = 0;
+  obj->v_cap = obj->vt_cap = obj->f_cap  = 0;
+  ctx->_scene_gen++;
+  SF_LOG(ctx, SF_LOG_INFO,
+              SF_LOG_INDENT "name   : %s\n"
+              SF_LOG_INDENT "bytes  : %zu -> %zu\n",
+              obj->name ? obj->name : "(null)", before, _sf_obj_memusg(obj));
+  return true;
+}
+
+sf_fvec3_t _sf_weld_pos(const sf_weld_t *w, int i) {
+  /* Mesh-space position of welded vertex i, dequantized when the weld is quantized. */
+  if (!w->qv) return w->v[i];
+  return (sf_fvec3_t){ w->q_c.x + w->q_s.x * (float)w->qv[i * 3],
+                       w->q_c.y + w->q_s.y * (float)w->qv[i * 3 + 1],
+                       w->q_c.z + w->q_s.z * (float)w->qv[i * 3 + 2] };
+}
+
+sf_fvec2_t _sf_weld_uv(const sf_weld_t *w, int i) {
+  /* UV of welded vertex i, dequantized when the weld is quantized; (0, 0) if the weld has no UVs. */
+  if (w->qt) return (sf_fvec2_t){ w->qt_o.x + w->qt_s.x * (float)w->qt[i * 2], w->qt_o.y + w->qt_s.y * (float)w->qt[i * 2 + 1] };
+  return w->vt ? w->vt[i] : (sf_fvec2_t){0.0f, 0.0f};
+}
+
+int _sf_obj_corner(const sf_obj_t *obj, int k) {
+  /* Vertex index of face corner k (face k / 3): into obj->v, or into the weld once sf_obj_strip has run. */
+  if (obj->f) return obj->f[k / 3].idx[k % 3].v;
+  return obj->weld->idx16 ? (int)obj->weld->idx16[k] : (int)obj->weld->idx32[k];
+}
+
 sf_obj_t* sf_obj_make_plane(sf_ctx_t *ctx, const char *objname, float sx, float sz, int res) {
   /* Generate a flat XZ-plane mesh of size sx×sz subdivided into res×res quads. */
   if (res < 1) res = 1;
@@ -5204,23 +8145,18 @@ sf_obj_t* sf_obj_make_cyl(sf_ctx_t *ctx, const char *objname, float radius, floa
 }
 
 sf_obj_t* sf_obj_make_heightmap(sf_ctx_t *ctx, const char *objname, float size_x, float size_z, int res, sf_height_fn fn, void *ud) {
-  /* Generate a terrain mesh by sampling a height callback function on a res×res grid. */
+  /* Generate a terrain mesh by sampling a height callback function on a res×res grid.
+   * Grid rows are sampled across the job pool, so fn must be safe to call from several threads. */
   if (res < 1) res = 1;
   int nv = (res + 1) * (res + 1);
   int nvt = nv;
   int nf = res * res * 2;
   sf_obj_t *obj = sf_obj_create_empty(ctx, objname, nv, nvt, nf);
   if (!obj) return NULL;
-  float hx = size_x * 0.5f, hz = size_z * 0.5f;
-  for (int z = 0; z <= res; z++) {
-    for (int x = 0; x <= res; x++) {
-      float wx = -hx + (float)x / (float)res * size_x;
-      float wz = -hz + (float)z / (float)res * size_z;
-      float wy = fn ? fn(wx, wz, ud) : 0.0f;
-      sf_obj_add_vert(obj, (sf_fvec3_t){ wx, wy, wz });
-      sf_obj_add_uv  (obj, (sf_fvec2_t){ (float)x/(float)res, (float)z/(float)res });
-    }
-  }
+  sf_hmap_ld_t hm = { obj, fn, ud, size_x, size_z, res };
+  sf_jobs_parallel_for(ctx, res + 1, 8, _sf_heightmap_rows, &hm);
+  obj->v_cnt  = nv;
+  obj->vt_cnt = nvt;
   for (int z = 0; z < res; z++) {
     for (int x = 0; x < res; x++) {
       int a = z * (res + 1) + x;
@@ -5235,18 +8171,57 @@ sf_obj_t* sf_obj_make_heightmap(sf_ctx_t *ctx, const char *objname, float size_x
   return obj;
 }
 
+void _sf_heightmap_rows(sf_ctx_t *ctx, void *user, int z0, int z1, int worker) {
+  /* sf_obj_make_heightmap job body: sample grid rows [z0, z1) straight into the preallocated vertex/UV slots. */
+  (void)ctx; (void)worker;
+  sf_hmap_ld_t *hm  = (sf_hmap_ld_t*)user;
+  int           res = hm->res;
+  float         hx  = hm->size_x * 0.5f, hz = hm->size_z * 0.5f;
+  for (int z = z0; z < z1; z++) {
+    for (int x = 0; x <= res; x++) {
+      int   i  = z * (res + 1) + x;
+      float wx = -hx + (float)x / (float)res * hm->size_x;
+      float wz = -hz + (float)z / (float)res * hm->size_z;
+      float wy = hm->fn ? hm->fn(wx, wz, hm->ud) : 0.0f;
+      hm->obj->v[i]  = (sf_fvec3_t){ wx, wy, wz };
+      hm->obj->vt[i] = (sf_fvec2_t){ (float)x/(float)res, (float)z/(float)res };
+    }
+  }
+}
+
 bool sf_obj_save_obj(sf_ctx_t *ctx, sf_obj_t *obj, const char *filepath) {
-  /* Export a mesh to a Wavefront .obj file. */
+  /* Export a mesh to a Wavefront .obj file; a mesh freed by sf_obj_strip is written from its weld. */
   if (!obj || !filepath) return false;
+  const sf_weld_t *w = obj->f ? NULL : obj->weld;
+  if (!obj->f && (!w || !w->valid)) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "could not write %s, '%s' has no faces\n", filepath, obj->name ? obj->name : "unnamed");
+    return false;
+  }
   FILE *f = fopen(filepath, "w");
   if (!f) {
     SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "could not write %s\n", filepath);
     return false;
   }
   fprintf(f, "# saffron export: %s\n", obj->name ? obj->name : "unnamed");
+  if (w) {
+    bool uv = w->vt || w->qt;
+    for (int i = 0; i < w->v_cnt; i++) {
+      sf_fvec3_t p = _sf_weld_pos(w, i);
+      fprintf(f, "v %.6f %.6f %.6f\n", p.x, p.y, p.z);
+    }
+    for (int i = 0; uv && i < w->v_cnt; i++) {
+      sf_fvec2_t t = _sf_weld_uv(w, i);
+      fprintf(f, "vt %.6f %.6f\n", t.x, t.y);
+    }
+    for (int i = 0; i < w->f_cnt; i++) {
+      int a = _sf_obj_corner(obj, i * 3) + 1, b = _sf_obj_corner(obj, i * 3 + 1) + 1, c = _sf_obj_corner(obj, i * 3 + 2) + 1;
+      if (uv) fprintf(f, "f %d/%d %d/%d %d/%d\n", a, a, b, b, c, c);
+      else    fprintf(f, "f %d %d %d\n", a, b, c);
+    }
+  }
   for (int i = 0; i < obj->v_cnt; i++)  fprintf(f, "v %.6f %.6f %.6f\n", obj->v[i].x, obj->v[i].y, obj->v[i].z);
   for (int i = 0; i < obj->vt_cnt; i++) fprintf(f, "vt %.6f %.6f\n", obj->vt[i].x, obj->vt[i].y);
-  for (int i = 0; i < obj->f_cnt; i++) {
+  for (int i = 0; obj->f && i < obj->f_cnt; i++) {
     sf_face_t *fc = &obj->f[i];
     bool has_uv = (fc->idx[0].vt >= 0);
     if (has_uv) {
@@ -5263,7 +8238,7 @@ bool sf_obj_save_obj(sf_ctx_t *ctx, sf_obj_t *obj, const char *filepath) {
               SF_LOG_INDENT "file   : %s\n"
               SF_LOG_INDENT "verts  : %d\n"
               SF_LOG_INDENT "faces  : %d\n",
-              filepath, obj->v_cnt, obj->f_cnt);
+              filepath, w ? w->v_cnt : obj->v_cnt, obj->f_cnt);
   return true;
 }
 
@@ -5306,7 +8281,7 @@ sf_ray_t sf_ray_from_screen(sf_ctx_t *ctx, sf_cam_t *cam, int sx, int sy) {
   float aspect = (float)cam->w / (float)cam->h;
   float t = tanf(SF_DEG2RAD(cam->fov) * 0.5f);
   sf_fvec3_t dir_v = { ndc_x * aspect * t, ndc_y * t, -1.0f };
-  sf_fmat4_t M = cam->frame->global_M;
+  sf_fmat43_t M = cam->frame->global_M;
   sf_fvec3_t right = {M.m[0][0], M.m[0][1], M.m[0][2]};
   sf_fvec3_t up    = {M.m[1][0], M.m[1][1], M.m[1][2]};
   sf_fvec3_t fwd   = {-M.m[2][0], -M.m[2][1], -M.m[2][2]};
@@ -5325,16 +8300,14 @@ sf_enti_t* sf_raycast_entities(sf_ctx_t *ctx, sf_ray_t ray, float *out_t) {
   sf_enti_t *hit = NULL;
   float best = 1e30f;
   for (int i = 0; i < ctx->enti_count; i++) {
-    sf_enti_t *e = &ctx->entities[i];
+    sf_enti_t *e = ctx->entities[i];
     if (!e->frame) continue;
-    sf_fmat4_t M = e->frame->global_M;
+    sf_fvec3_t *wv = _sf_pick_verts(ctx, e);
+    if (!wv) continue;
     for (int fi = 0; fi < e->obj.f_cnt; fi++) {
-      sf_face_t *fc = &e->obj.f[fi];
-      sf_fvec3_t a = sf_fmat4_mul_vec3(M, e->obj.v[fc->idx[0].v]);
-      sf_fvec3_t b = sf_fmat4_mul_vec3(M, e->obj.v[fc->idx[1].v]);
-      sf_fvec3_t c = sf_fmat4_mul_vec3(M, e->obj.v[fc->idx[2].v]);
+      int   k = fi * 3;
       float t;
-      if (sf_ray_triangle(ray, a, b, c, &t) && t < best) {
+      if (sf_ray_triangle(ray, wv[_sf_obj_corner(&e->obj, k)], wv[_sf_obj_corner(&e->obj, k + 1)], wv[_sf_obj_corner(&e->obj, k + 2)], &t) && t < best) {
         best = t;
         hit = e;
       }
@@ -5349,23 +8322,21 @@ int sf_raycast_all(sf_ctx_t *ctx, sf_ray_t ray, sf_hit_t *out_hits, int max_hits
   int count = 0;
   float t;
   for (int i = 0; i < ctx->enti_count && count < max_hits; i++) {
-    sf_enti_t *e = &ctx->entities[i];
+    sf_enti_t *e = ctx->entities[i];
     if (!e->frame) continue;
-    sf_fmat4_t M = e->frame->global_M;
+    sf_fvec3_t *wv = _sf_pick_verts(ctx, e);
+    if (!wv) continue;
     float best_t = 1e30f;
     bool hit = false;
     for (int fi = 0; fi < e->obj.f_cnt; fi++) {
-      sf_face_t *fc = &e->obj.f[fi];
-      sf_fvec3_t a = sf_fmat4_mul_vec3(M, e->obj.v[fc->idx[0].v]);
-      sf_fvec3_t b = sf_fmat4_mul_vec3(M, e->obj.v[fc->idx[1].v]);
-      sf_fvec3_t c = sf_fmat4_mul_vec3(M, e->obj.v[fc->idx[2].v]);
-      if (sf_ray_triangle(ray, a, b, c, &t) && t < best_t) { best_t = t; hit = true; }
+      int k = fi * 3;
+      if (sf_ray_triangle(ray, wv[_sf_obj_corner(&e->obj, k)], wv[_sf_obj_corner(&e->obj, k + 1)], wv[_sf_obj_corner(&e->obj, k + 2)], &t) && t < best_t) { best_t = t; hit = true; }
     }
     if (hit) { out_hits[count++] = (sf_hit_t){SF_HIT_ENTI, e, best_t}; }
   }
   const float aabb_r[3] = { 0.3f, 0.4f, 0.5f };
   for (int i = 0; i < ctx->light_count && count < max_hits; i++) {
-    sf_light_t *l = &ctx->lights[i];
+    sf_light_t *l = ctx->lights[i];
     if (!l->frame) continue;
     sf_fvec3_t p = {l->frame->global_M.m[3][0], l->frame->global_M.m[3][1], l->frame->global_M.m[3][2]};
     sf_fvec3_t mn = {p.x - aabb_r[0], p.y - aabb_r[0], p.z - aabb_r[0]};
@@ -5373,7 +8344,7 @@ int sf_raycast_all(sf_ctx_t *ctx, sf_ray_t ray, sf_hit_t *out_hits, int max_hits
     if (sf_ray_aabb(ray, mn, mx, &t)) { out_hits[count++] = (sf_hit_t){SF_HIT_LIGHT, l, t}; }
   }
   for (int i = 0; i < ctx->emitr_count && count < max_hits; i++) {
-    sf_emitr_t *em = &ctx->emitrs[i];
+    sf_emitr_t *em = ctx->emitrs[i];
     if (!em->frame) continue;
     sf_fvec3_t p = {em->frame->global_M.m[3][0], em->frame->global_M.m[3][1], em->frame->global_M.m[3][2]};
     sf_fvec3_t mn = {p.x - aabb_r[1], p.y - aabb_r[1], p.z - aabb_r[1]};
@@ -5398,6 +8369,24 @@ int sf_raycast_all(sf_ctx_t *ctx, sf_ray_t ray, sf_hit_t *out_hits, int max_hits
   return count;
 }
 
+sf_fvec3_t* _sf_pick_verts(sf_ctx_t *ctx, sf_enti_t *e) {
+  /* Batch-transform e's vertices (its weld's, once stripped) to world space into ctx's picking scratch, which is
+   * reused across calls and overwritten by the next one; index it with _sf_obj_corner. Returns NULL if the
+   * scratch can't grow or e has no geometry. */
+  const sf_weld_t *wd = e->obj.f ? NULL : e->obj.weld;
+  if (!e->obj.f && (!wd || !wd->valid)) return NULL;
+  int         n  = wd ? wd->v_cnt : e->obj.v_cnt;
+  sf_fvec3_t *wv = (sf_fvec3_t*)_sf_grow(ctx->_pick_v, &ctx->_pick_cap, n, sizeof(sf_fvec3_t));
+  if (!wv) {
+    SF_LOG(ctx, SF_LOG_ERROR, SF_LOG_INDENT "failed to pick '%s', no memory for %d verts\n", e->name ? e->name : "(null)", n);
+    return NULL;
+  }
+  ctx->_pick_v = wv;
+  if (wd && wd->qv) _sf_fmat43_mul_q16_n(sf_fmat43_mul_fmat43(_sf_weld_dequant(wd), e->frame->global_M), wd->qv, wv, n);
+  else              sf_fmat43_mul_vec3_n(e->frame->global_M, wd ? wd->v : e->obj.v, wv, n);
+  return wv;
+}
+
 bool sf_ray_triangle(sf_ray_t r, sf_fvec3_t a, sf_fvec3_t b, sf_fvec3_t c, float *out_t) {
   /* Möller–Trumbore ray-triangle intersection; writes hit distance to out_t if non-NULL. */
   sf_fvec3_t e1 = sf_fvec3_sub(b, a);
@@ -5455,7 +8444,7 @@ void sf_gizmo_update(sf_ctx_t *ctx, sf_cam_t *cam, sf_gizmo_t *gz, sf_frame_t *f
   gz->frame = frame;
   if (!frame || !cam || !cam->frame) return;
   sf_fvec3_t origin_w = {frame->global_M.m[3][0], frame->global_M.m[3][1], frame->global_M.m[3][2]};
-  sf_fvec3_t v = sf_fmat4_mul_vec3(cam->V, origin_w);
+  sf_fvec3_t v = sf_fmat43_mul_vec3(cam->V, origin_w);
   float dist = -v.z;
   if (dist < 0.5f) dist = 0.5f;
   float L = dist * 0.12f;
@@ -5464,12 +8453,12 @@ void sf_gizmo_update(sf_ctx_t *ctx, sf_cam_t *cam, sf_gizmo_t *gz, sf_frame_t *f
     {origin_w.x,     origin_w.y + L, origin_w.z    },
     {origin_w.x,     origin_w.y,     origin_w.z + L},
   };
-  sf_fvec3_t vo = sf_fmat4_mul_vec3(cam->V, origin_w);
+  sf_fvec3_t vo = sf_fmat43_mul_vec3(cam->V, origin_w);
   if (vo.z > -cam->near_plane) return;
   sf_fvec3_t so = _sf_project_vertex(ctx, cam, vo, cam->P);
   gz->screen_origin = (sf_ivec2_t){(int)so.x, (int)so.y};
   for (int i = 0; i < 3; i++) {
-    sf_fvec3_t vt = sf_fmat4_mul_vec3(cam->V, tips_w[i]);
+    sf_fvec3_t vt = sf_fmat43_mul_vec3(cam->V, tips_w[i]);
     if (vt.z > -cam->near_plane) return;
     sf_fvec3_t st = _sf_project_vertex(ctx, cam, vt, cam->P);
     gz->screen_tip[i] = (sf_ivec2_t){(int)st.x, (int)st.y};
@@ -5580,7 +8569,7 @@ void sf_orbit_cam_zoom(sf_orbit_cam_t *orbit, float delta) {
 void sf_orbit_cam_pan(sf_orbit_cam_t *orbit, sf_cam_t *cam, float dx, float dy) {
   /* Move the orbit target in the camera's local right/up plane. */
   if (!cam || !cam->frame) return;
-  sf_fmat4_t M = cam->frame->global_M;
+  sf_fmat43_t M = cam->frame->global_M;
   sf_fvec3_t right = {M.m[0][0], M.m[0][1], M.m[0][2]};
   sf_fvec3_t up    = {M.m[1][0], M.m[1][1], M.m[1][2]};
   orbit->target.x += right.x * dx + up.x * dy;
@@ -5605,26 +8594,29 @@ sf_tex_t* sf_render_thumb_enti(sf_ctx_t *ctx, sf_enti_t *enti, int size) {
   thumb_cam.w = size;
   thumb_cam.h = size;
   thumb_cam.buffer_size = size * size;
+  thumb_cam.stride = size;
   thumb_cam.buffer = px;
   thumb_cam.z_buffer = zb;
   thumb_cam.fov = 45.0f;
   thumb_cam.near_plane = 0.1f;
   thumb_cam.far_plane = 100.0f;
+  thumb_cam.cull_mask = SF_LAYER_ALL;
+  thumb_cam.features = SF_CAM_ALL;
   thumb_cam.P = sf_make_psp_fmat4(45.0f, 1.0f, 0.1f, 100.0f);
   sf_frame_t cam_frame;
   memset(&cam_frame, 0, sizeof(cam_frame));
   cam_frame.scale = (sf_fvec3_t){1, 1, 1};
-  cam_frame.local_M = sf_make_idn_fmat4();
-  cam_frame.global_M = sf_make_idn_fmat4();
+  cam_frame.local_M = sf_make_idn_fmat43();
+  cam_frame.global_M = sf_make_idn_fmat43();
   thumb_cam.frame = &cam_frame;
   float r = enti->obj.bs_radius;
   if (r < 0.01f) r = 1.0f;
   float d = r * 2.5f;
   sf_fvec3_t ctr = enti->obj.bs_center;
   sf_fvec3_t eye = {ctr.x + d * 0.5f, ctr.y + d * 0.4f, ctr.z + d * 0.7f};
-  thumb_cam.V = sf_make_view_fmat4(eye, ctr, (sf_fvec3_t){0, 1, 0});
+  thumb_cam.V = sf_fmat4_to_fmat43(sf_make_view_fmat4(eye, ctr, (sf_fvec3_t){0, 1, 0}));
   cam_frame.pos = eye;
-  cam_frame.global_M = sf_make_view_fmat4(eye, ctr, (sf_fvec3_t){0, 1, 0});
+  cam_frame.global_M = thumb_cam.V;
   for (int i = 0; i < size * size; i++) { px[i] = 0xFF303030; zb[i] = 1e30f; }
   sf_light_t tmp_light;
   memset(&tmp_light, 0, sizeof(tmp_light));
@@ -5635,18 +8627,19 @@ sf_tex_t* sf_render_thumb_enti(sf_ctx_t *ctx, sf_enti_t *enti, int size) {
   memset(&light_frame, 0, sizeof(light_frame));
   light_frame.pos = (sf_fvec3_t){2.0f, 4.0f, 2.0f};
   light_frame.scale = (sf_fvec3_t){1, 1, 1};
-  light_frame.local_M = sf_make_idn_fmat4();
-  light_frame.global_M = sf_make_idn_fmat4();
+  light_frame.local_M = sf_make_idn_fmat43();
+  light_frame.global_M = sf_make_idn_fmat43();
   tmp_light.frame = &light_frame;
-  int saved_lc = ctx->light_count;
-  sf_light_t saved_light;
-  bool had_light = (ctx->light_count > 0);
-  if (had_light) saved_light = ctx->lights[0];
-  ctx->lights[0] = tmp_light;
-  if (ctx->light_count == 0) ctx->light_count = 1;
+  sf_light_t  *tmp_lp   = &tmp_light;
+  sf_light_t **saved_l  = ctx->lights;
+  int          saved_lc = ctx->light_count;
+  sf_light_t  *saved_0  = saved_lc > 0 ? ctx->lights[0] : NULL;
+  if (saved_0) ctx->lights[0] = &tmp_light;
+  else { ctx->lights = &tmp_lp; ctx->light_count = 1; }
   sf_render_enti(ctx, &thumb_cam, enti);
+  ctx->lights      = saved_l;
   ctx->light_count = saved_lc;
-  if (had_light) ctx->lights[0] = saved_light;
+  if (saved_0) ctx->lights[0] = saved_0;
   sf_tex_t *tex = (sf_tex_t*)malloc(sizeof(sf_tex_t));
   if (tex) {
     memset(tex, 0, sizeof(sf_tex_t));
@@ -5664,12 +8657,13 @@ sf_tex_t* sf_render_thumb_enti(sf_ctx_t *ctx, sf_enti_t *enti, int size) {
 sf_tex_t* sf_render_thumb_sff(sf_ctx_t *ctx, const char *sff_path, int size) {
   /* Load an SFF into a temporary context and render a thumbnail. */
   if (!ctx || !sff_path || size <= 0) return NULL;
-  sf_ctx_t tmp_ctx;
-  sf_init(&tmp_ctx, size, size);
+  sf_ctx_t      tmp_ctx;
+  sf_init_cfg_t cfg = { .max_sprite_3ds = 1, .workers = 1 };
+  sf_init_ex(&tmp_ctx, size, size, &cfg);
   sf_load_sff(&tmp_ctx, sff_path, "thumb_scene");
   sf_tex_t *result = NULL;
   if (tmp_ctx.enti_count > 0) {
-    result = sf_render_thumb_enti(ctx, &tmp_ctx.entities[0], size);
+    result = sf_render_thumb_enti(ctx, tmp_ctx.entities[0], size);
   }
   sf_destroy(&tmp_ctx);
   return result;
@@ -5743,6 +8737,153 @@ sf_fvec3_t sf_fmat4_mul_vec3(sf_fmat4_t m, sf_fvec3_t v) {
   return result;
 }
 
+sf_fmat43_t sf_fmat43_mul_fmat43(sf_fmat43_t m0, sf_fmat43_t m1) {
+  /* Compose two affine matrices (m0 then m1); the implied last column stays 0,0,0,1, so this is 36 multiplies
+   * instead of the 64 of a full 4×4 product. */
+  sf_fmat43_t result;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 3; j++) {
+      result.m[i][j] = m0.m[i][0] * m1.m[0][j] + m0.m[i][1] * m1.m[1][j] + m0.m[i][2] * m1.m[2][j];
+    }
+  }
+  for (int j = 0; j < 3; j++) result.m[3][j] += m1.m[3][j];
+  return result;
+}
+
+sf_fvec3_t sf_fmat43_mul_vec3(sf_fmat43_t m, sf_fvec3_t v) {
+  /* Transform a point by an affine matrix; w is always 1, so there is no divide. */
+  return (sf_fvec3_t){
+    v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0],
+    v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1],
+    v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2]
+  };
+}
+
+void sf_fmat43_mul_vec3_n(sf_fmat43_t m, const sf_fvec3_t *in, sf_fvec3_t *out, int n) {
+  /* Transform n points by an affine matrix into out (which may alias in), 8 (AVX) or 4 (SSE2, NEON) at a time:
+   * xyz triples are split into x/y/z registers on load and interleaved again on store, with a scalar tail. */
+  int i = 0;
+#if defined(__AVX__)
+  __m256 ax = _mm256_set1_ps(m.m[0][0]), bx = _mm256_set1_ps(m.m[1][0]), cx = _mm256_set1_ps(m.m[2][0]), dx = _mm256_set1_ps(m.m[3][0]);
+  __m256 ay = _mm256_set1_ps(m.m[0][1]), by = _mm256_set1_ps(m.m[1][1]), cy = _mm256_set1_ps(m.m[2][1]), dy = _mm256_set1_ps(m.m[3][1]);
+  __m256 az = _mm256_set1_ps(m.m[0][2]), bz = _mm256_set1_ps(m.m[1][2]), cz = _mm256_set1_ps(m.m[2][2]), dz = _mm256_set1_ps(m.m[3][2]);
+  for (; i + 8 <= n; i += 8) {
+    const float *src = &in[i].x;
+    float       *dst = &out[i].x;
+    __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)),     _mm_loadu_ps(src + 12), 1);
+    __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 16), 1);
+    __m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 20), 1);
+    __m256 x, y, z;
+    SF_SIMD_SPLIT3(_mm256_shuffle_ps, a, b, c, x, y, z);
+    __m256 ox = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, ax), _mm256_mul_ps(y, bx)), _mm256_mul_ps(z, cx)), dx);
+    __m256 oy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, ay), _mm256_mul_ps(y, by)), _mm256_mul_ps(z, cy)), dy);
+    __m256 oz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, az), _mm256_mul_ps(y, bz)), _mm256_mul_ps(z, cz)), dz);
+    SF_SIMD_JOIN3(_mm256_shuffle_ps, ox, oy, oz, a, b, c);
+    _mm_storeu_ps(dst,      _mm256_castps256_ps128(a));
+    _mm_storeu_ps(dst + 4,  _mm256_castps256_ps128(b));
+    _mm_storeu_ps(dst + 8,  _mm256_castps256_ps128(c));
+    _mm_storeu_ps(dst + 12, _mm256_extractf128_ps(a, 1));
+    _mm_storeu_ps(dst + 16, _mm256_extractf128_ps(b, 1));
+    _mm_storeu_ps(dst + 20, _mm256_extractf128_ps(c, 1));
+  }
+#endif
+#if defined(__SSE2__)
+  __m128 ax4 = _mm_set1_ps(m.m[0][0]), bx4 = _mm_set1_ps(m.m[1][0]), cx4 = _mm_set1_ps(m.m[2][0]), dx4 = _mm_set1_ps(m.m[3][0]);
+  __m128 ay4 = _mm_set1_ps(m.m[0][1]), by4 = _mm_set1_ps(m.m[1][1]), cy4 = _mm_set1_ps(m.m[2][1]), dy4 = _mm_set1_ps(m.m[3][1]);
+  __m128 az4 = _mm_set1_ps(m.m[0][2]), bz4 = _mm_set1_ps(m.m[1][2]), cz4 = _mm_set1_ps(m.m[2][2]), dz4 = _mm_set1_ps(m.m[3][2]);
+  for (; i + 4 <= n; i += 4) {
+    const float *src = &in[i].x;
+    float       *dst = &out[i].x;
+    __m128 a = _mm_loadu_ps(src), b = _mm_loadu_ps(src + 4), c = _mm_loadu_ps(src + 8);
+    __m128 x, y, z;
+    SF_SIMD_SPLIT3(_mm_shuffle_ps, a, b, c, x, y, z);
+    __m128 ox = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, ax4), _mm_mul_ps(y, bx4)), _mm_mul_ps(z, cx4)), dx4);
+    __m128 oy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, ay4), _mm_mul_ps(y, by4)), _mm_mul_ps(z, cy4)), dy4);
+    __m128 oz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, az4), _mm_mul_ps(y, bz4)), _mm_mul_ps(z, cz4)), dz4);
+    SF_SIMD_JOIN3(_mm_shuffle_ps, ox, oy, oz, a, b, c);
+    _mm_storeu_ps(dst, a);
+    _mm_storeu_ps(dst + 4, b);
+    _mm_storeu_ps(dst + 8, c);
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 4 <= n; i += 4) {
+    float32x4x3_t v = vld3q_f32(&in[i].x);
+    float32x4x3_t o;
+    for (int j = 0; j < 3; j++) {
+      float32x4_t r = vmulq_n_f32(v.val[0], m.m[0][j]);
+      r = vaddq_f32(r, vmulq_n_f32(v.val[1], m.m[1][j]));
+      r = vaddq_f32(r, vmulq_n_f32(v.val[2], m.m[2][j]));
+      o.val[j] = vaddq_f32(r, vdupq_n_f32(m.m[3][j]));
+    }
+    vst3q_f32(&out[i].x, o);
+  }
+#endif
+  for (; i < n; i++) out[i] = sf_fmat43_mul_vec3(m, in[i]);
+}
+
+void _sf_fmat43_mul_q16_n(sf_fmat43_t m, const int16_t *q, sf_fvec3_t *out, int n) {
+  /* sf_fmat43_mul_vec3_n for n quantized points stored as int16 xyz triples: four at a time with SSE2 or NEON,
+   * widened to float in registers, so the stream read per point is 6 bytes instead of 12. */
+  int i = 0;
+#if defined(__SSE2__)
+  __m128 ax = _mm_set1_ps(m.m[0][0]), bx = _mm_set1_ps(m.m[1][0]), cx = _mm_set1_ps(m.m[2][0]), dx = _mm_set1_ps(m.m[3][0]);
+  __m128 ay = _mm_set1_ps(m.m[0][1]), by = _mm_set1_ps(m.m[1][1]), cy = _mm_set1_ps(m.m[2][1]), dy = _mm_set1_ps(m.m[3][1]);
+  __m128 az = _mm_set1_ps(m.m[0][2]), bz = _mm_set1_ps(m.m[1][2]), cz = _mm_set1_ps(m.m[2][2]), dz = _mm_set1_ps(m.m[3][2]);
+  for (; i + 4 <= n; i += 4) {
+    __m128i r0 = _mm_loadu_si128((const __m128i*)(q + i * 3));
+    __m128i r1 = _mm_loadl_epi64((const __m128i*)(q + i * 3 + 8));
+    __m128  a  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(r0, r0), 16));
+    __m128  b  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(r0, r0), 16));
+    __m128  c  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(r1, r1), 16));
+    __m128  x, y, z;
+    SF_SIMD_SPLIT3(_mm_shuffle_ps, a, b, c, x, y, z);
+    __m128 ox = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, ax), _mm_mul_ps(y, bx)), _mm_mul_ps(z, cx)), dx);
+    __m128 oy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, ay), _mm_mul_ps(y, by)), _mm_mul_ps(z, cy)), dy);
+    __m128 oz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, az), _mm_mul_ps(y, bz)), _mm_mul_ps(z, cz)), dz);
+    SF_SIMD_JOIN3(_mm_shuffle_ps, ox, oy, oz, a, b, c);
+    _mm_storeu_ps(&out[i].x,     a);
+    _mm_storeu_ps(&out[i].x + 4, b);
+    _mm_storeu_ps(&out[i].x + 8, c);
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 4 <= n; i += 4) {
+    int16x4x3_t   v = vld3_s16(q + i * 3);
+    float32x4x3_t o;
+    float32x4_t   x = vcvtq_f32_s32(vmovl_s16(v.val[0]));
+    float32x4_t   y = vcvtq_f32_s32(vmovl_s16(v.val[1]));
+    float32x4_t   z = vcvtq_f32_s32(vmovl_s16(v.val[2]));
+    for (int j = 0; j < 3; j++) {
+      float32x4_t r = vmulq_n_f32(x, m.m[0][j]);
+      r = vaddq_f32(r, vmulq_n_f32(y, m.m[1][j]));
+      r = vaddq_f32(r, vmulq_n_f32(z, m.m[2][j]));
+      o.val[j] = vaddq_f32(r, vdupq_n_f32(m.m[3][j]));
+    }
+    vst3q_f32(&out[i].x, o);
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = sf_fmat43_mul_vec3(m, (sf_fvec3_t){ (float)q[i * 3], (float)q[i * 3 + 1], (float)q[i * 3 + 2] });
+  }
+}
+
+sf_fmat43_t sf_fmat4_to_fmat43(sf_fmat4_t m) {
+  /* Drop the last column of a 4×4 matrix that is known to be affine. */
+  sf_fmat43_t r;
+  for (int i = 0; i < 4; i++) {
+    r.m[i][0] = m.m[i][0]; r.m[i][1] = m.m[i][1]; r.m[i][2] = m.m[i][2];
+  }
+  return r;
+}
+
+sf_fmat4_t sf_fmat43_to_fmat4(sf_fmat43_t m) {
+  /* Expand an affine matrix to 4×4, for composing with a projection. */
+  sf_fmat4_t r;
+  for (int i = 0; i < 4; i++) {
+    r.m[i][0] = m.m[i][0]; r.m[i][1] = m.m[i][1]; r.m[i][2] = m.m[i][2]; r.m[i][3] = (i == 3) ? 1.0f : 0.0f;
+  }
+  return r;
+}
+
 sf_fvec3_t sf_fvec3_sub(sf_fvec3_t v0, sf_fvec3_t v1) {
   /* Subtract v1 from v0 component-wise. */
   return (sf_fvec3_t){ v0.x - v1.x, v0.y - v1.y, v0.z - v1.z };
@@ -5838,6 +8979,11 @@ sf_fmat4_t sf_make_idn_fmat4() {
   return result;
 }
 
+sf_fmat43_t sf_make_idn_fmat43(void) {
+  /* Return an affine identity matrix. */
+  return (sf_fmat43_t){{ {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, 0} }};
+}
+
 sf_fmat4_t sf_make_view_fmat4(sf_fvec3_t eye, sf_fvec3_t target, sf_fvec3_t up) {
   /* Build a look-at view matrix from eye position, target point, and up vector. */
   sf_fvec3_t f = sf_fvec3_norm(sf_fvec3_sub(target, eye));
@@ -5875,7 +9021,7 @@ sf_fmat4_t sf_make_scale_fmat4(sf_fvec3_t s) {
 }
 
 uint32_t _sf_vec_to_index(sf_ctx_t *ctx, sf_cam_t *cam, sf_ivec2_t v) {
-  return v.y * cam->w + v.x;
+  return v.y * cam->stride + v.x;
 }
 
 void _sf_swap_svec2(sf_ivec2_t *v0, sf_ivec2_t *v1) {
@@ -5898,6 +9044,25 @@ sf_fvec3_t _sf_lerp_fvec3(sf_fvec3_t a, sf_fvec3_t b, float t) {
   };
 }
 
+sf_pkd_clr_t _sf_lerp_px(sf_pkd_clr_t a, sf_pkd_clr_t b, uint32_t w) {
+  /* Blend two ARGB colours with an 8-bit weight (0 = a, 256 = b), two channels per multiply. */
+  uint32_t rb = (((a & 0x00FF00FFu) * (256 - w) + (b & 0x00FF00FFu) * w) >> 8) & 0x00FF00FFu;
+  uint32_t ag = ((((a >> 8) & 0x00FF00FFu) * (256 - w) + ((b >> 8) & 0x00FF00FFu) * w)) & 0xFF00FF00u;
+  return rb | ag;
+}
+
+sf_fmat43_t _sf_rigid_inv(sf_fmat43_t m) {
+  /* Invert a rotation + translation matrix (such as a view matrix) by transposing the rotation. */
+  sf_fmat43_t r;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) r.m[i][j] = m.m[j][i];
+  }
+  for (int j = 0; j < 3; j++) {
+    r.m[3][j] = -(m.m[3][0] * r.m[0][j] + m.m[3][1] * r.m[1][j] + m.m[3][2] * r.m[2][j]);
+  }
+  return r;
+}
+
 sf_fvec3_t _sf_intersect_near(sf_fvec3_t v0, sf_fvec3_t v1, float near) {
   float t = (near - v0.z) / (v1.z - v0.z);
   return (sf_fvec3_t){
@@ -5908,14 +9073,74 @@ sf_fvec3_t _sf_intersect_near(sf_fvec3_t v0, sf_fvec3_t v1, float near) {
 }
 
 sf_fvec3_t _sf_project_vertex(sf_ctx_t *ctx, sf_cam_t *cam, sf_fvec3_t v, sf_fmat4_t P) {
+  /* Project a view-space point to screen x/y; z is NDC depth, or -near/dist for reversed and 16-bit cameras. */
   sf_fvec3_t proj = sf_fmat4_mul_vec3(P, v);
   return (sf_fvec3_t){
     (proj.x + 1.0f) * 0.5f * (float)cam->w,
     (1.0f - (proj.y + 1.0f) * 0.5f) * (float)cam->h,
-    proj.z
+    (cam->depth_fmt == SF_DEPTH_F32) ? proj.z : cam->near_plane / v.z
   };
 }
 
+void _sf_project_verts(sf_ctx_t *ctx, sf_cam_t *cam, const sf_fvec3_t *v, sf_fvec3_t *out, int n, sf_fmat4_t P) {
+  /* _sf_project_vertex over n view-space points into out, four at a time with SSE2. The arithmetic runs in the
+   * same order, so results match the single-point path bit for bit unless -ffast-math reorders that one. */
+  int   i    = 0;
+  bool  ndc  = (cam->depth_fmt == SF_DEPTH_F32);
+  float W    = (float)cam->w, H = (float)cam->h;
+#if defined(__SSE2__)
+  __m128 one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps();
+  __m128 vw  = _mm_set1_ps(W),    vh   = _mm_set1_ps(H),    vnp  = _mm_set1_ps(cam->near_plane);
+  __m128 pm[4][4];
+  for (int r = 0; r < 4; r++) {
+    for (int c = 0; c < 4; c++) pm[r][c] = _mm_set1_ps(P.m[r][c]);
+  }
+  for (; i + 4 <= n; i += 4) {
+    const float *src = &v[i].x;
+    float       *dst = &out[i].x;
+    __m128 a = _mm_loadu_ps(src), b = _mm_loadu_ps(src + 4), c = _mm_loadu_ps(src + 8);
+    __m128 x, y, z, o[4];
+    SF_SIMD_SPLIT3(_mm_shuffle_ps, a, b, c, x, y, z);
+    for (int j = 0; j < 4; j++) {
+      o[j] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, pm[0][j]), _mm_mul_ps(y, pm[1][j])), _mm_mul_ps(z, pm[2][j])), pm[3][j]);
+    }
+    __m128 nz = _mm_cmpneq_ps(o[3], zero);
+    __m128 w  = _mm_or_ps(_mm_and_ps(nz, o[3]), _mm_andnot_ps(nz, one));
+    __m128 sx = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_div_ps(o[0], w), one), half), vw);
+    __m128 sy = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(_mm_add_ps(_mm_div_ps(o[1], w), one), half)), vh);
+    __m128 sz = ndc ? _mm_div_ps(o[2], w) : _mm_div_ps(vnp, z);
+    SF_SIMD_JOIN3(_mm_shuffle_ps, sx, sy, sz, a, b, c);
+    _mm_storeu_ps(dst, a);
+    _mm_storeu_ps(dst + 4, b);
+    _mm_storeu_ps(dst + 8, c);
+  }
+#endif
+  for (; i < n; i++) out[i] = _sf_project_vertex(ctx, cam, v[i], P);
+}
+
+uint16_t _sf_depth_to_q16(float z, float zk) {
+  /* Convert a reversed projected depth (-near/dist) to 16-bit linear depth; 0xFFFF is reserved for clear. */
+  return (uint16_t)_sf_depth_q16f(z, zk);
+}
+
+float _sf_depth_q16f(float z, float zk) {
+  /* _sf_depth_to_q16 before truncation, clamped to [0, 65534]; spans step this linearly between exact ends. */
+  float q = zk * (1.0f / z + 1.0f);
+  if (q <= 0.0f)     return 0.0f;
+  if (q >= 65534.0f) return 65534.0f;
+  return q;
+}
+
+float _sf_depth_q16_k(sf_cam_t *cam) {
+  /* Scale used by _sf_depth_to_q16 so [near, far] spans the full 16-bit range. */
+  return -cam->near_plane * 65535.0f / (cam->far_plane - cam->near_plane);
+}
+
+bool _sf_depth_is_clear(sf_cam_t *cam, int idx) {
+  /* True if nothing has written depth at idx since the last sf_clear_depth. */
+  return cam->z_buffer16 ? (cam->z_buffer16[idx] == 0xFFFF) : (cam->z_buffer[idx] > 2.0f);
+}
+
 float _sf_hash_2d(int x, int z, uint32_t seed) {
   uint32_t h = (uint32_t)x * 374761393u + (uint32_t)z * 668265263u + seed * 362437u;
   h = (h ^ (h >> 13)) * 1274126177u;
@@ -5983,6 +9208,13 @@ float _sf_seg_dist2(sf_ivec2_t a, sf_ivec2_t b, int px, int py, float *out_t) {
   return ex * ex + ey * ey;
 }
 
+uint64_t _sf_fnv1a(uint64_t h, const void *p, size_t n) {
+  /* Fold n bytes into a 64-bit FNV-1a hash; start from 14695981039346656037. */
+  const uint8_t *b = (const uint8_t*)p;
+  for (size_t i = 0; i < n; i++) h = (h ^ b[i]) * 1099511628211ull;
+  return h;
+}
+
 /* SF_IMPLEMENTATION_HELPERS */
 bool _sf_resolve_asset(const char* filename, char* out_path, size_t max_len) {
   char dir_stack[32][512];
@@ -6054,6 +9286,52 @@ sf_unpkd_clr_t _sf_unpack_color(sf_pkd_clr_t c) {
   return unpkd;
 }
 
+void _sf_put_px(sf_cam_t *cam, int idx, sf_pkd_clr_t c) {
+  /* Store one ARGB colour into cam's buffer, packing it to the camera's pixel format. */
+  switch (cam->pix_fmt) {
+    case SF_PIXFMT_RGB565:
+      cam->buffer16[idx] = (uint16_t)(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+      break;
+    case SF_PIXFMT_IDX8:
+      cam->buffer8[idx] = cam->_pal_inv[((c >> 9) & 0x7C00) | ((c >> 6) & 0x03E0) | ((c >> 3) & 0x001F)];
+      break;
+    default:
+      cam->buffer[idx] = c;
+      break;
+  }
+}
+
+sf_pkd_clr_t _sf_get_px(sf_cam_t *cam, int idx) {
+  /* Read one pixel from cam's buffer and expand it back to ARGB8888. */
+  switch (cam->pix_fmt) {
+    case SF_PIXFMT_RGB565: {
+      uint32_t p = cam->buffer16[idx];
+      uint32_t r = (p >> 11) & 31, g = (p >> 5) & 63, b = p & 31;
+      return 0xFF000000u | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+    }
+    case SF_PIXFMT_IDX8:
+      return cam->palette[cam->buffer8[idx]];
+    default:
+      return cam->buffer[idx];
+  }
+}
+
+sf_pkd_clr_t* _sf_px_span(sf_cam_t *cam, sf_pkd_clr_t *tmp, int idx, int n) {
+  /* ARGB pixels [idx, idx + n) for a raster loop to read and write directly: the buffer itself for ARGB8888 cameras,
+   * otherwise tmp filled with the unpacked span (and a copy at tmp + SF_PX_CHUNK) for _sf_px_flush; n <= SF_PX_CHUNK. */
+  if (cam->buffer) return cam->buffer + idx;
+  for (int i = 0; i < n; i++) tmp[i] = tmp[SF_PX_CHUNK + i] = _sf_get_px(cam, idx + i);
+  return tmp;
+}
+
+void _sf_px_flush(sf_cam_t *cam, const sf_pkd_clr_t *tmp, int idx, int n) {
+  /* Pack back the pixels of a _sf_px_span scratch that the raster loop changed; a no-op for ARGB8888 cameras. */
+  if (cam->buffer) return;
+  for (int i = 0; i < n; i++) {
+    if (tmp[i] != tmp[SF_PX_CHUNK + i]) _sf_put_px(cam, idx + i, tmp[i]);
+  }
+}
+
 void _sf_write_qstr(FILE *f, const char *s) {
   fputc('"', f);
   if (s) for (const char *p = s; *p; p++) {
@@ -6081,6 +9359,24 @@ bool _sf_parse_qstr(const char *line, const char *key, char *out, size_t outsz)
   return true;
 }
 
+void _sf_build_depth_lut(sf_pkd_clr_t *lut) {
+  /* Bake the depth-view heatmap (power curve + 5-key gradient) over normalised linear depth in [0,1]. */
+  const float kr[5] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f};
+  const float kg[5] = {0.0f, 1.0f, 1.0f, 1.0f, 0.0f};
+  const float kb[5] = {1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < SF_DEPTH_LUT_SIZE; i++) {
+    float t      = powf((float)i / (float)(SF_DEPTH_LUT_SIZE - 1), 0.2f);
+    float scaled = t * 4.0f;
+    int   seg    = (int)scaled;
+    if (seg >= 4) seg = 3;
+    float f = scaled - (float)seg;
+    uint8_t r = (uint8_t)((kr[seg] + (kr[seg+1] - kr[seg]) * f) * 255.0f + 0.5f);
+    uint8_t g = (uint8_t)((kg[seg] + (kg[seg+1] - kg[seg]) * f) * 255.0f + 0.5f);
+    uint8_t b = (uint8_t)((kb[seg] + (kb[seg+1] - kb[seg]) * f) * 255.0f + 0.5f);
+    lut[i] = 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+}
+
 /* SF_GAMMA_LUT - sqrtf(i/255.0)*255 for linear->sRGB approx */
 static const uint8_t _sf_gamma_lut[256] = {
     0, 16, 23, 28, 32, 36, 39, 42, 45, 48, 50, 53, 55, 58, 60, 62,
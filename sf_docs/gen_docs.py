@@ -26,6 +26,7 @@ SECTION_TITLES = {
     "SF_TYPES":                "Types & Enumerations",
     "SF_CORE_FUNCTIONS":       "Core",
     "SF_MEMORY_FUNCTIONS":     "Memory / Arena",
+    "SF_JOB_FUNCTIONS":        "Jobs",
     "SF_EVENT_FUNCTIONS":      "Events & Input",
     "SF_SCENE_FUNCTIONS":      "Scene",
     "SF_FILE_OPS":             "File Operations",
@@ -120,7 +120,8 @@ int main(int argc, char* argv[]) {
     SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
 
     sf_ctx_t sf_ctx;
-    sf_init(&sf_ctx, width, height);
+    sf_init_cfg_t cfg = { .workers = -1 };
+    sf_init_ex(&sf_ctx, width, height, &cfg);
 
     sf_event_reg(&sf_ctx, SF_EVT_KEY_DOWN, on_key_down, NULL);
     sf_event_reg(&sf_ctx, SF_EVT_RENDER_START, on_render_start, NULL);
@@ -190,6 +191,7 @@ int main(int argc, char* argv[]) {
 
         sf_ui_update(&sf_ctx, sf_ctx.ui);
 
+        sf_sdl_lock_cam(&sf_ctx, &sf_ctx.main_camera, texture);
         sf_render_ctx(&sf_ctx);
         sf_rect(&sf_ctx, &sf_ctx.main_camera, SF_CLR_WHITE, (sf_ivec2_t){width-pip_cam->w-22, height-pip_cam->h-22}, (sf_ivec2_t){width-19, height-19});
         sf_draw_cam_pip(&sf_ctx, &sf_ctx.main_camera, pip_cam, (sf_ivec2_t){width-pip_cam->w-20,height-pip_cam->h-20});
@@ -200,7 +202,7 @@ int main(int argc, char* argv[]) {
 
         sf_ui_render(&sf_ctx, &sf_ctx.main_camera, sf_ctx.ui);
 
-        SDL_UpdateTexture(texture, NULL, sf_ctx.main_camera.buffer, sf_ctx.main_camera.w * sizeof(sf_pkd_clr_t));
+        sf_sdl_unlock_cam(&sf_ctx, &sf_ctx.main_camera, texture);
         SDL_RenderCopy(renderer, texture, NULL, NULL);
         SDL_RenderPresent(renderer);
     }
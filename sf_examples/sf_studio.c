@@ -167,8 +167,9 @@ static int          g_design_pan_last_mx = 0, g_design_pan_last_my = 0;
 #define DESIGN_HANDLE 10
 
 static int          g_parent_sel    = 0;
-static const char  *g_parent_items[SF_MAX_FRAMES];
+static const char **g_parent_items  = NULL;
 static int          g_parent_count  = 0;
+static int          g_parent_cap    = 0;
 
 /* primitive generation parameters */
 static float g_plane_sx    = 2.0f,  g_plane_sz    = 2.0f;
@@ -292,7 +293,9 @@ typedef struct {
   float       p[8];
   int         model_idx;
 } prim_meta_t;
-static prim_meta_t g_enti_meta[SF_MAX_ENTITIES];
+/* Indexed by the entity's pool slot, which stays put while the entity lives */
+static prim_meta_t *g_enti_meta     = NULL;
+static int          g_enti_meta_cap = 0;
 
 static void studio_logger(const char *msg, void *ud) {
   (void)ud;
@@ -316,11 +319,29 @@ static void studio_logger(const char *msg, void *ud) {
   fflush(stdout);
 }
 
+static prim_meta_t* enti_meta(sf_enti_t *e) {
+  sf_handle_t h = sf_pool_handle(&sf_ctx.enti_pool, e);
+  if (!h.gen) return NULL;
+  if ((int)h.idx >= g_enti_meta_cap) {
+    int cap = (int)h.idx + 64;
+    prim_meta_t *m = (prim_meta_t*)realloc(g_enti_meta, (size_t)cap * sizeof(prim_meta_t));
+    if (!m) return NULL;
+    memset(m + g_enti_meta_cap, 0, (size_t)(cap - g_enti_meta_cap) * sizeof(prim_meta_t));
+    g_enti_meta = m;
+    g_enti_meta_cap = cap;
+  }
+  return &g_enti_meta[h.idx];
+}
+
+static void remove_enti(sf_enti_t *e) {
+  prim_meta_t *m = enti_meta(e);
+  if (m) memset(m, 0, sizeof(prim_meta_t));
+  sf_remove_enti(&sf_ctx, e);
+}
+
 static prim_meta_t* sel_meta(void) {
   if (g_sel_kind != SEL_ENTI || !g_sel) return NULL;
-  int idx = (int)(g_sel - sf_ctx.entities);
-  if (idx < 0 || idx >= SF_MAX_ENTITIES) return NULL;
-  return &g_enti_meta[idx];
+  return enti_meta(g_sel);
 }
 
 /* --- HELPERS --- */
@@ -480,8 +501,12 @@ static sf_obj_t* build_obj_from_meta(const char *name, prim_meta_t *m) {
     case PM_BOX:     return sf_obj_make_box  (&sf_ctx, name, m->p[0], m->p[1], m->p[2]);
     case PM_SPHERE:  return sf_obj_make_sphere(&sf_ctx, name, m->p[0], (int)m->p[1]);
     case PM_CYL:     return sf_obj_make_cyl  (&sf_ctx, name, m->p[0], m->p[1], (int)m->p[2]);
-    case PM_TERRAIN: g_regen_pending_meta = *m;
-                     return sf_obj_make_heightmap(&sf_ctx, name, m->p[0], m->p[1], (int)m->p[2], _terrain_fn, &g_regen_pending_meta);
+    case PM_TERRAIN: {
+      g_regen_pending_meta = *m;
+      sf_obj_t *o = sf_obj_make_heightmap(&sf_ctx, name, m->p[0], m->p[1], (int)m->p[2], _terrain_fn, &g_regen_pending_meta);
+      if (o && sf_obj_quantize(&sf_ctx, o)) sf_obj_strip(&sf_ctx, o);
+      return o;
+    }
     case PM_MODEL: {
       if (m->model_idx < 0 || m->model_idx >= g_model_count) return NULL;
       const char *fname = g_model_files[m->model_idx];
@@ -512,17 +537,12 @@ static void cb_regen_sel(sf_ctx_t *ctx, void *ud) {
   snprintf(name, sizeof(name), "mesh_%d", before);
   sf_obj_t *o = build_obj_from_meta(name, m);
   if (o) {
-    g_sel->obj = *o;
-    sf_ctx.obj_count = before;
+    sf_enti_set_obj(&sf_ctx, g_sel, o);
+    while (sf_ctx.obj_count > before) sf_remove_obj(&sf_ctx, &sf_ctx.objs[sf_ctx.obj_count - 1]);
   } else if (m->kind == PM_MODEL && saved_sel && saved_kind == SEL_ENTI) {
     /* An SFF scene was loaded — delete the placeholder entity that was selected */
-    int idx = (int)(saved_sel - sf_ctx.entities);
-    if (idx >= 0 && idx < sf_ctx.enti_count) {
-      sf_remove_frame(&sf_ctx, saved_sel->frame);
-      for (int i = idx; i < sf_ctx.enti_count - 1; i++) sf_ctx.entities[i] = sf_ctx.entities[i + 1];
-      for (int i = idx; i < sf_ctx.enti_count - 1 && i < SF_MAX_ENTITIES - 1; i++) g_enti_meta[i] = g_enti_meta[i + 1];
-      if (sf_ctx.enti_count - 1 < SF_MAX_ENTITIES) memset(&g_enti_meta[sf_ctx.enti_count - 1], 0, sizeof(prim_meta_t));
-      sf_ctx.enti_count--;
+    if (enti_meta(saved_sel)) {
+      remove_enti(saved_sel);
       g_ui_dirty = true;
     }
   }
@@ -571,7 +591,7 @@ static void spawn_primitive(int kind) {
              so newly added billboards may still point to the original entity's frame instead of
              the freshly created one. Redirect them to the newly added entity's frame. */
           if (sf_ctx.enti_count > enti_before) {
-            sf_frame_t *new_frame = sf_ctx.entities[enti_before].frame;
+            sf_frame_t *new_frame = sf_ctx.entities[enti_before]->frame;
             for (int i = bb_before; i < sf_ctx.sprite_3d_count; i++) {
               sf_sprite_3_t *b = &sf_ctx.sprite_3ds[i];
               if (b->frame && b->frame != new_frame)
@@ -593,8 +613,8 @@ static void spawn_primitive(int kind) {
   sf_enti_t *e = sf_add_enti(&sf_ctx, o, entiname);
   if (!e) return;
   if (e->frame) { e->frame->pos = g_orbit.target; e->frame->is_dirty = true; }
-  int idx = (int)(e - sf_ctx.entities);
-  if (idx >= 0 && idx < SF_MAX_ENTITIES) g_enti_meta[idx] = tmp;
+  prim_meta_t *m = enti_meta(e);
+  if (m) *m = tmp;
   sel_clear();
   g_sel_kind = SEL_ENTI;
   g_sel = e;
@@ -612,7 +632,7 @@ static void spawn_emitter(void) {
     if (!stars) stars = sf_load_texture_bmp(&sf_ctx, "Stars.bmp", "Stars");
     if (stars) spr = sf_load_sprite(&sf_ctx, "spr_Stars", 1.0f, 0.3f, 1, stars->name);
   }
-  if (!spr && sf_ctx.sprite_count > 0) spr = &sf_ctx.sprites[0];
+  if (!spr && sf_ctx.sprite_count > 0) spr = sf_ctx.sprites[0];
   if (!spr) {
     if (sf_ctx.tex_count == 0) {
       SF_LOG(&sf_ctx, SF_LOG_WARN, "Emitter needs a sprite; load a texture first (Textures panel).\n");
@@ -673,10 +693,10 @@ static void cb_duplicate(sf_ctx_t *ctx, void *ud) {
     }
     e->tex = g_sel->tex;
     e->tex_scale = g_sel->tex_scale;
-    int src_idx = (int)(g_sel - sf_ctx.entities);
-    int dst_idx = (int)(e - sf_ctx.entities);
-    if (src_idx >= 0 && src_idx < SF_MAX_ENTITIES && dst_idx >= 0 && dst_idx < SF_MAX_ENTITIES)
-      g_enti_meta[dst_idx] = g_enti_meta[src_idx];
+    prim_meta_t *src = enti_meta(g_sel);
+    prim_meta_t  tmp = src ? *src : (prim_meta_t){0};
+    prim_meta_t *dst = enti_meta(e);
+    if (dst) *dst = tmp;
     sel_clear(); g_sel_kind = SEL_ENTI; g_sel = e; g_ui_dirty = true;
   } else if (g_sel_kind == SEL_LIGHT && g_sel_light) {
     char name[64]; snprintf(name, sizeof(name), "%s_dup%d", g_sel_light->name ? g_sel_light->name : "lt", sf_ctx.light_count);
@@ -723,11 +743,18 @@ static void cb_spawn_kind(sf_ctx_t *ctx, void *ud) {
 
 /* Compact sprite_3ds, removing any whose frame is in the subtree rooted at df */
 /* Collect frames in a subtree via sf_frame_walk */
-typedef struct { sf_frame_t *frames[SF_MAX_FRAMES]; int count; } _subtree_set_t;
+typedef struct { sf_frame_t **frames; int count, cap; } _subtree_set_t;
 static bool _subtree_collect_cb(sf_frame_t *f, int depth, void *ud) {
   (void)depth;
   _subtree_set_t *s = (_subtree_set_t*)ud;
-  if (s->count < SF_MAX_FRAMES) s->frames[s->count++] = f;
+  if (s->count == s->cap) {
+    int cap = s->cap ? s->cap * 2 : 64;
+    sf_frame_t **fr = (sf_frame_t**)realloc(s->frames, (size_t)cap * sizeof(sf_frame_t*));
+    if (!fr) return false;
+    s->frames = fr;
+    s->cap = cap;
+  }
+  s->frames[s->count++] = f;
   return true;
 }
 static bool _frame_in_set(sf_frame_t *f, _subtree_set_t *s) {
@@ -735,68 +762,43 @@ static bool _frame_in_set(sf_frame_t *f, _subtree_set_t *s) {
   return false;
 }
 static void _purge_sprites_under(sf_frame_t *df) {
-  _subtree_set_t set = {.count = 0};
+  _subtree_set_t set = {0};
   sf_frame_walk(&sf_ctx, df, _subtree_collect_cb, &set);
   int nc = 0;
   for (int bi = 0; bi < sf_ctx.sprite_3d_count; bi++)
     if (!sf_ctx.sprite_3ds[bi].frame || !_frame_in_set(sf_ctx.sprite_3ds[bi].frame, &set))
       sf_ctx.sprite_3ds[nc++] = sf_ctx.sprite_3ds[bi];
   sf_ctx.sprite_3d_count = nc;
+  free(set.frames);
 }
 /* Remove entities/lights/cameras/emitters whose frame is in the subtree of df */
 static void _purge_entities_under(sf_frame_t *df) {
-  _subtree_set_t set = {.count = 0};
+  _subtree_set_t set = {0};
   sf_frame_walk(&sf_ctx, df, _subtree_collect_cb, &set);
   for (int i = sf_ctx.enti_count - 1; i >= 0; i--) {
-    if (sf_ctx.entities[i].frame && sf_ctx.entities[i].frame != df &&
-        _frame_in_set(sf_ctx.entities[i].frame, &set)) {
-      for (int j = i; j < sf_ctx.enti_count - 1; j++) sf_ctx.entities[j] = sf_ctx.entities[j + 1];
-      if (sf_ctx.enti_count - 1 < SF_MAX_ENTITIES) memset(&g_enti_meta[sf_ctx.enti_count - 1], 0, sizeof(prim_meta_t));
-      sf_ctx.enti_count--;
-    }
+    sf_enti_t *e = sf_ctx.entities[i];
+    if (e->frame && e->frame != df && _frame_in_set(e->frame, &set)) remove_enti(e);
   }
   for (int i = sf_ctx.light_count - 1; i >= 0; i--) {
-    if (sf_ctx.lights[i].frame && _frame_in_set(sf_ctx.lights[i].frame, &set)) {
-      for (int j = i; j < sf_ctx.light_count - 1; j++) sf_ctx.lights[j] = sf_ctx.lights[j + 1];
-      sf_ctx.light_count--;
-    }
+    if (sf_ctx.lights[i]->frame && _frame_in_set(sf_ctx.lights[i]->frame, &set)) sf_remove_light(&sf_ctx, sf_ctx.lights[i]);
   }
   for (int i = sf_ctx.cam_count - 1; i >= 0; i--) {
-    if (sf_ctx.cameras[i].frame && _frame_in_set(sf_ctx.cameras[i].frame, &set)) {
-      for (int j = i; j < sf_ctx.cam_count - 1; j++) sf_ctx.cameras[j] = sf_ctx.cameras[j + 1];
-      sf_ctx.cam_count--;
-    }
+    if (sf_ctx.cameras[i].frame && _frame_in_set(sf_ctx.cameras[i].frame, &set)) sf_remove_cam(&sf_ctx, &sf_ctx.cameras[i]);
   }
   for (int i = sf_ctx.emitr_count - 1; i >= 0; i--) {
-    if (sf_ctx.emitrs[i].frame && _frame_in_set(sf_ctx.emitrs[i].frame, &set)) {
-      for (int j = i; j < sf_ctx.emitr_count - 1; j++) sf_ctx.emitrs[j] = sf_ctx.emitrs[j + 1];
-      sf_ctx.emitr_count--;
-    }
+    if (sf_ctx.emitrs[i]->frame && _frame_in_set(sf_ctx.emitrs[i]->frame, &set)) sf_remove_emitr(&sf_ctx, sf_ctx.emitrs[i]);
   }
+  free(set.frames);
 }
 
 static void cb_delete(sf_ctx_t *ctx, void *ud) {
   (void)ctx; (void)ud;
   if (g_sel_kind == SEL_ENTI && g_sel) {
-    int idx = (int)(g_sel - sf_ctx.entities);
-    if (idx < 0 || idx >= sf_ctx.enti_count) return;
+    if (!enti_meta(g_sel)) return;
     sf_frame_t *df = g_sel->frame;
     _purge_sprites_under(df);
     _purge_entities_under(df);
-    /* After purge, g_sel may point past the end of the (shifted) array.
-       Find the selected entity by its frame pointer, which is unambiguous. */
-    idx = -1;
-    for (int si = 0; si < sf_ctx.enti_count; si++) {
-      if (sf_ctx.entities[si].frame == df) { idx = si; break; }
-    }
-    sf_remove_frame(&sf_ctx, df);
-    if (idx < 0) { sel_clear(); g_ui_dirty = true; return; }
-    for (int i = idx; i < sf_ctx.enti_count - 1; i++) sf_ctx.entities[i] = sf_ctx.entities[i + 1];
-    for (int i = idx; i < sf_ctx.enti_count - 1 && i < SF_MAX_ENTITIES - 1; i++) g_enti_meta[i] = g_enti_meta[i + 1];
-    if (sf_ctx.enti_count - 1 >= 0 && sf_ctx.enti_count - 1 < SF_MAX_ENTITIES) {
-      memset(&g_enti_meta[sf_ctx.enti_count - 1], 0, sizeof(prim_meta_t));
-    }
-    sf_ctx.enti_count--;
+    remove_enti(g_sel);
   } else if (g_sel_kind == SEL_LIGHT && g_sel_light) {
     sf_remove_light(&sf_ctx, g_sel_light);
   } else if (g_sel_kind == SEL_CAM && g_sel_cam) {
@@ -1251,7 +1253,7 @@ static void picker_render_obj_thumb(sf_obj_t *obj, const char *tex_path, int i)
   /* Set up a temporary entity on the stack */
   sf_enti_t tmp_enti; memset(&tmp_enti, 0, sizeof(tmp_enti));
   sf_frame_t tmp_frame; memset(&tmp_frame, 0, sizeof(tmp_frame));
-  tmp_frame.global_M = sf_make_idn_fmat4();
+  tmp_frame.global_M = sf_make_idn_fmat43();
   tmp_enti.frame = &tmp_frame;
   tmp_enti.obj = *obj;
   tmp_enti.tex = tex_path ? picker_load_bmp_private(tex_path) : NULL;
@@ -1492,19 +1494,25 @@ static void cb_browse_sfgen_bledge(sf_ctx_t *ctx, void *ud) {
 }
 
 static void rebuild_parent_list(void) {
+  int need = sf_ctx.frame_pool.count + 1;
+  if (need > g_parent_cap) {
+    const char **it = (const char**)realloc(g_parent_items, (size_t)need * sizeof(const char*));
+    if (it) { g_parent_items = it; g_parent_cap = need; }
+  }
   g_parent_count = 0;
+  g_parent_sel   = 0;
+  if (g_parent_cap < 1) return;
   g_parent_items[g_parent_count++] = "(none)";
   sf_frame_t *sf = sel_frame();
-  if (!sf) { g_parent_sel = 0; return; }
-  for (int i = 0; i < sf_ctx.frames_count && g_parent_count < SF_MAX_FRAMES; i++) {
-    sf_frame_t *f = &sf_ctx.frames[i];
+  if (!sf) return;
+  for (int i = 0; i < sf_ctx.frames_count && g_parent_count < g_parent_cap; i++) {
+    sf_frame_t *f = sf_ctx.frames[i];
     if (!f->name || f == sf) continue;
     bool cycle = false;
     for (sf_frame_t *p = f; p; p = p->parent) if (p == sf) { cycle = true; break; }
     if (cycle) continue;
     g_parent_items[g_parent_count++] = f->name;
   }
-  g_parent_sel = 0;
   if (sf->parent && sf->parent->name) {
     for (int i = 1; i < g_parent_count; i++) {
       if (strcmp(g_parent_items[i], sf->parent->name) == 0) { g_parent_sel = i; break; }
@@ -1521,8 +1529,8 @@ static void cb_set_parent(sf_ctx_t *ctx, void *ud) {
   } else {
     const char *nm = g_parent_items[g_parent_sel];
     for (int i = 0; i < sf_ctx.frames_count; i++) {
-      if (sf_ctx.frames[i].name && strcmp(sf_ctx.frames[i].name, nm) == 0) {
-        sf_frame_set_parent(sf, &sf_ctx.frames[i]);
+      if (sf_ctx.frames[i]->name && strcmp(sf_ctx.frames[i]->name, nm) == 0) {
+        sf_frame_set_parent(sf, sf_ctx.frames[i]);
         break;
       }
     }
@@ -1535,17 +1543,11 @@ static void cb_apply_rename(sf_ctx_t *ctx, void *ud) {
   (void)ctx; (void)ud;
   if (g_sel_kind == SEL_NONE) return;
   if (g_rename_buf[0] == '\0') return;
-  size_t n = strlen(g_rename_buf) + 1;
-  char *mem = (char*)sf_arena_alloc(&sf_ctx, &sf_ctx.arena, n);
-  if (!mem) return;
-  memcpy(mem, g_rename_buf, n);
-  sf_frame_t *f = sel_frame();
-  if (f) f->name = mem;
   switch (g_sel_kind) {
-    case SEL_ENTI:  if (g_sel)       g_sel->name       = mem; break;
-    case SEL_LIGHT: if (g_sel_light) g_sel_light->name = mem; break;
-    case SEL_CAM:   if (g_sel_cam)   g_sel_cam->name   = mem; break;
-    case SEL_EMITR: if (g_sel_emitr) g_sel_emitr->name = mem; break;
+    case SEL_ENTI:  if (g_sel)       sf_rename(&sf_ctx, SF_NAME_ENTI,  g_sel,       g_rename_buf); break;
+    case SEL_LIGHT: if (g_sel_light) sf_rename(&sf_ctx, SF_NAME_LIGHT, g_sel_light, g_rename_buf); break;
+    case SEL_CAM:   if (g_sel_cam)   sf_rename(&sf_ctx, SF_NAME_CAM,   g_sel_cam,   g_rename_buf); break;
+    case SEL_EMITR: if (g_sel_emitr) sf_rename(&sf_ctx, SF_NAME_EMITR, g_sel_emitr, g_rename_buf); break;
     default: break;
   }
   g_ui_dirty = true;
@@ -1636,7 +1638,7 @@ static void sfgen_grow(sf_obj_t *obj, sf_fvec3_t pos, sf_fvec3_t dir,
     sfgen_add_seg(obj, pos, end, rad, er, vt, vt1);
     if (depth == 0) {
         int n = (int)(ct_ld + .5f);
-        for (int i=0; i<n && g_sfgen_ctx.sprite_3d_count < SF_MAX_SPRITE_3DS; i++) {
+        for (int i=0; i<n && g_sfgen_ctx.sprite_3d_count < g_sfgen_ctx.sprite_3d_cap; i++) {
             float sp = len * 0.9f;
             sf_fvec3_t lp = {end.x+sfgen_rf2()*sp, end.y+sfgen_rnd()*sp*0.8f, end.z+sfgen_rf2()*sp};
             float ls = fminf(ct_ls*(0.7f+sfgen_rnd()*0.3f), 2.0f);
@@ -3116,10 +3118,10 @@ static outl_item_t g_outl_items[OUTL_MAX];
 static int         g_outl_count = 0;
 
 static sel_kind_t _outl_kind_of_frame(sf_frame_t *f, void **out_ptr) {
-  for (int i = 0; i < sf_ctx.enti_count; i++) if (sf_ctx.entities[i].frame == f) { *out_ptr = &sf_ctx.entities[i]; return SEL_ENTI; }
-  for (int i = 0; i < sf_ctx.light_count; i++) if (sf_ctx.lights[i].frame   == f) { *out_ptr = &sf_ctx.lights[i];   return SEL_LIGHT; }
+  for (int i = 0; i < sf_ctx.enti_count; i++) if (sf_ctx.entities[i]->frame == f) { *out_ptr = sf_ctx.entities[i]; return SEL_ENTI; }
+  for (int i = 0; i < sf_ctx.light_count; i++) if (sf_ctx.lights[i]->frame   == f) { *out_ptr = sf_ctx.lights[i];   return SEL_LIGHT; }
   for (int i = 0; i < sf_ctx.cam_count;   i++) if (sf_ctx.cameras[i].frame  == f) { *out_ptr = &sf_ctx.cameras[i];  return SEL_CAM; }
-  for (int i = 0; i < sf_ctx.emitr_count; i++) if (sf_ctx.emitrs[i].frame   == f) { *out_ptr = &sf_ctx.emitrs[i];   return SEL_EMITR; }
+  for (int i = 0; i < sf_ctx.emitr_count; i++) if (sf_ctx.emitrs[i]->frame   == f) { *out_ptr = sf_ctx.emitrs[i];   return SEL_EMITR; }
   *out_ptr = NULL;
   return SEL_NONE;
 }
@@ -3140,11 +3142,11 @@ static void rebuild_outliner_items(void) {
   /* Walk from the root frame: find it by taking any frame's parent chain. */
   sf_frame_t *root = NULL;
   if (sf_ctx.enti_count > 0) {
-    sf_frame_t *f = sf_ctx.entities[0].frame;
+    sf_frame_t *f = sf_ctx.entities[0]->frame;
     while (f && f->parent) f = f->parent;
     root = f;
   } else if (sf_ctx.light_count > 0) {
-    sf_frame_t *f = sf_ctx.lights[0].frame;
+    sf_frame_t *f = sf_ctx.lights[0]->frame;
     while (f && f->parent) f = f->parent;
     root = f;
   }
@@ -3156,13 +3158,13 @@ static void rebuild_outliner_items(void) {
   else {
     /* Fallback: list items in order even if no root found */
     for (int i = 0; i < sf_ctx.enti_count && g_outl_count < OUTL_MAX; i++)
-      g_outl_items[g_outl_count++] = (outl_item_t){ SEL_ENTI, &sf_ctx.entities[i], sf_ctx.entities[i].frame, 0 };
+      g_outl_items[g_outl_count++] = (outl_item_t){ SEL_ENTI, sf_ctx.entities[i], sf_ctx.entities[i]->frame, 0 };
     for (int i = 0; i < sf_ctx.light_count && g_outl_count < OUTL_MAX; i++)
-      g_outl_items[g_outl_count++] = (outl_item_t){ SEL_LIGHT, &sf_ctx.lights[i], sf_ctx.lights[i].frame, 0 };
+      g_outl_items[g_outl_count++] = (outl_item_t){ SEL_LIGHT, sf_ctx.lights[i], sf_ctx.lights[i]->frame, 0 };
     for (int i = 0; i < sf_ctx.cam_count && g_outl_count < OUTL_MAX; i++)
       g_outl_items[g_outl_count++] = (outl_item_t){ SEL_CAM, &sf_ctx.cameras[i], sf_ctx.cameras[i].frame, 0 };
     for (int i = 0; i < sf_ctx.emitr_count && g_outl_count < OUTL_MAX; i++)
-      g_outl_items[g_outl_count++] = (outl_item_t){ SEL_EMITR, &sf_ctx.emitrs[i], sf_ctx.emitrs[i].frame, 0 };
+      g_outl_items[g_outl_count++] = (outl_item_t){ SEL_EMITR, sf_ctx.emitrs[i], sf_ctx.emitrs[i]->frame, 0 };
   }
 }
 
@@ -3984,21 +3986,21 @@ static void update_camera(void) {
     int total = sf_ctx.enti_count + sf_ctx.light_count + sf_ctx.cam_count + sf_ctx.emitr_count;
     if (total > 0) {
       int cur = -1, k = 0;
-      for (int i = 0; i < sf_ctx.enti_count;  i++, k++) if (g_sel_kind == SEL_ENTI  && g_sel       == &sf_ctx.entities[i]) cur = k;
-      for (int i = 0; i < sf_ctx.light_count; i++, k++) if (g_sel_kind == SEL_LIGHT && g_sel_light == &sf_ctx.lights[i])   cur = k;
+      for (int i = 0; i < sf_ctx.enti_count;  i++, k++) if (g_sel_kind == SEL_ENTI  && g_sel       == sf_ctx.entities[i]) cur = k;
+      for (int i = 0; i < sf_ctx.light_count; i++, k++) if (g_sel_kind == SEL_LIGHT && g_sel_light == sf_ctx.lights[i])   cur = k;
       for (int i = 0; i < sf_ctx.cam_count;   i++, k++) if (g_sel_kind == SEL_CAM   && g_sel_cam   == &sf_ctx.cameras[i])  cur = k;
-      for (int i = 0; i < sf_ctx.emitr_count; i++, k++) if (g_sel_kind == SEL_EMITR && g_sel_emitr == &sf_ctx.emitrs[i])   cur = k;
+      for (int i = 0; i < sf_ctx.emitr_count; i++, k++) if (g_sel_kind == SEL_EMITR && g_sel_emitr == sf_ctx.emitrs[i])   cur = k;
       int nxt = (cur < 0) ? (dir > 0 ? 0 : total - 1) : ((cur + dir + total) % total);
       sel_clear();
       if (nxt < sf_ctx.enti_count) {
-        g_sel_kind = SEL_ENTI; g_sel = &sf_ctx.entities[nxt];
+        g_sel_kind = SEL_ENTI; g_sel = sf_ctx.entities[nxt];
       } else if ((nxt -= sf_ctx.enti_count) < sf_ctx.light_count) {
-        g_sel_kind = SEL_LIGHT; g_sel_light = &sf_ctx.lights[nxt];
+        g_sel_kind = SEL_LIGHT; g_sel_light = sf_ctx.lights[nxt];
       } else if ((nxt -= sf_ctx.light_count) < sf_ctx.cam_count) {
         g_sel_kind = SEL_CAM; g_sel_cam = &sf_ctx.cameras[nxt];
       } else {
         nxt -= sf_ctx.cam_count;
-        g_sel_kind = SEL_EMITR; g_sel_emitr = &sf_ctx.emitrs[nxt];
+        g_sel_kind = SEL_EMITR; g_sel_emitr = sf_ctx.emitrs[nxt];
       }
       g_ui_dirty = true;
     }
@@ -4036,8 +4038,10 @@ int main(int argc, char *argv[]) {
   SDL_Texture  *texture  = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, g_w, g_h);
   SDL_StartTextInput();
 
-  sf_init(&sf_ctx, g_w, g_h);
+  sf_init_cfg_t cfg = { .workers = -1 };
+  sf_init_ex(&sf_ctx, g_w, g_h, &cfg);
   sf_set_logger(&sf_ctx, studio_logger, NULL);
+  sf_ctx.on_demand = true;
   {
     const char *home = getenv("HOME");
     if (home) {
@@ -4081,6 +4085,8 @@ int main(int argc, char *argv[]) {
   while (sf_running(&sf_ctx)) {
     sf_input_cycle_state(&sf_ctx);
 
+    /* Nothing in the scene changed last frame: sleep until input arrives instead of spinning */
+    if (g_tab == TAB_SFF && sf_render_idle(&sf_ctx)) SDL_WaitEventTimeout(NULL, 100);
     while (SDL_PollEvent(&event)) {
       if (event.type == SDL_QUIT) sf_stop(&sf_ctx);
       if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
@@ -4203,6 +4209,7 @@ int main(int argc, char *argv[]) {
       }
     }
 
+    sf_sdl_lock_cam(&sf_ctx, &sf_ctx.main_camera, texture);
     if (g_tab == TAB_SFF) {
       sf_render_ctx(&sf_ctx);
       if (g_dbg_frames) sf_draw_debug_frames(&sf_ctx, &sf_ctx.main_camera, 1.0f);
@@ -4228,8 +4235,7 @@ int main(int argc, char *argv[]) {
       if (g_ck_enti)       g_ck_enti->obj.f_cnt       = g_ck_obj->f_cnt;
       if (g_ck_enti_win)   g_ck_enti_win->obj.f_cnt   = g_ck_obj_win->f_cnt;
       if (g_ck_enti_ledge) g_ck_enti_ledge->obj.f_cnt = g_ck_obj_ledge->f_cnt;
-      memcpy(sf_ctx.main_camera.buffer, g_sfgen_ctx.main_camera.buffer,
-             (size_t)g_w * g_h * sizeof(sf_pkd_clr_t));
+      sf_draw_cam_pip(&sf_ctx, &sf_ctx.main_camera, &g_sfgen_ctx.main_camera, (sf_ivec2_t){0, 0});
     } else {
       sf_fill(&sf_ctx, &sf_ctx.main_camera, (sf_pkd_clr_t)0xFF1A1A20);
     }
@@ -4283,7 +4289,7 @@ int main(int argc, char *argv[]) {
       }
     }
 
-    SDL_UpdateTexture(texture, NULL, sf_ctx.main_camera.buffer, sf_ctx.main_camera.w * sizeof(sf_pkd_clr_t));
+    sf_sdl_unlock_cam(&sf_ctx, &sf_ctx.main_camera, texture);
     SDL_RenderCopy(renderer, texture, NULL, NULL);
     SDL_RenderPresent(renderer);
   }
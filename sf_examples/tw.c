@@ -119,7 +119,7 @@ void on_render_end(sf_ctx_t *ctx, const sf_event_t *ev, void *userdata) {
     /* 2. Light Color Prep */
     sf_fvec3_t l_clr = {1.0f, 1.0f, 1.0f};
     if (ctx->light_count > 0) {
-        sf_light_t *light = &ctx->lights[0];
+        sf_light_t *light = ctx->lights[0];
         light->color.x = (sinf(ctx->elapsed_time * 1.5f) + 1.0f) * 0.5f;
         light->color.y = (sinf(ctx->elapsed_time * 2.0f) + 1.0f) * 0.5f;
         light->color.z = (sinf(ctx->elapsed_time * 0.7f) + 1.0f) * 0.5f;
@@ -195,7 +195,8 @@ int main(int argc, char* argv[]) {
     const int render_h = 200;
 
     sf_ctx_t sf_ctx;
-    sf_init(&sf_ctx, render_w, render_h);
+    sf_init_cfg_t cfg = { .workers = -1 };
+    sf_init_ex(&sf_ctx, render_w, render_h, &cfg);
     g_sf_ctx = &sf_ctx;
 
     /* Setup Camera */
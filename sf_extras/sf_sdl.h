@@ -10,6 +10,8 @@ extern "C" {
 #endif
 
 void sf_sdl_process_event(sf_ctx_t *ctx, const SDL_Event *event);
+bool sf_sdl_lock_cam(sf_ctx_t *ctx, sf_cam_t *cam, SDL_Texture *tex);
+void sf_sdl_unlock_cam(sf_ctx_t *ctx, sf_cam_t *cam, SDL_Texture *tex);
 
 #ifdef __cplusplus
 }
@@ -109,4 +111,28 @@ void sf_sdl_process_event(sf_ctx_t *ctx, const SDL_Event *event) {
   }
 }
 
+bool sf_sdl_lock_cam(sf_ctx_t *ctx, sf_cam_t *cam, SDL_Texture *tex) {
+  /* Lock a streaming texture and point cam at it, so the frame renders straight into texture memory */
+  void *pixels;
+  int pitch;
+  if (SDL_LockTexture(tex, NULL, &pixels, &pitch) != 0) return false;
+  if (!sf_camera_set_target(ctx, cam, pixels, pitch)) {
+    SDL_UnlockTexture(tex);
+    return false;
+  }
+  return true;
+}
+
+void sf_sdl_unlock_cam(sf_ctx_t *ctx, sf_cam_t *cam, SDL_Texture *tex) {
+  /* Detach cam and unlock; if the lock failed, upload the camera's own buffer (in its pix_fmt) instead */
+  if (cam->ext_px) {
+    sf_camera_set_target(ctx, cam, NULL, 0);
+    SDL_UnlockTexture(tex);
+  } else {
+    int   bpp = (cam->pix_fmt == SF_PIXFMT_IDX8) ? 1 : (cam->pix_fmt == SF_PIXFMT_RGB565) ? 2 : 4;
+    void *px  = cam->buffer ? (void*)cam->buffer : cam->buffer16 ? (void*)cam->buffer16 : (void*)cam->buffer8;
+    if (px) SDL_UpdateTexture(tex, NULL, px, cam->stride * bpp);
+  }
+}
+
 #endif /* SAFFRON_SDL_IMPLEMENTATION */